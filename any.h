@@ -44,6 +44,20 @@
 #   error This project can only be compiled with a compiler that supports C++14
 #endif
 
+// some features, (std::string_view), are only available with c++17
+#if (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L) || __cplusplus >= 201703L
+#   define MYODD_ANY_CPP17 1
+#else
+#   define MYODD_ANY_CPP17 0
+#endif
+
+// the three-way comparison, (operator<=>), is only available with c++20
+#if (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L) || __cplusplus >= 202002L
+#   define MYODD_ANY_CPP20 1
+#else
+#   define MYODD_ANY_CPP20 0
+#endif
+
 /* What version of GCC is being used.  0 means GCC is not being used */
 /* from sqlite 3*/
 #ifdef __GNUC__
@@ -57,16 +71,30 @@
 #include <math.h>         // modf
 #include <cstring>
 #include <string>
-#include <locale>		      //  std::wstring_convert
-#include <cctype>         //  isdigit
-#include <codecvt>        //  string <-> wstring
+#if MYODD_ANY_CPP17
+#   include <string_view> //  std::string_view / std::wstring_view
+#endif
+#if MYODD_ANY_CPP20
+#   include <compare>     //  std::partial_ordering
+#endif
+#include <stdexcept>      //  std::runtime_error / std::range_error
 #include <stdlib.h>       //  std::strtoll / std::strtoull
 #include <type_traits>    //  std::is_trivially_copyable
                           //  std::is_pointer
 #include <cstddef>        //  nullptr_t
 #include <memory>         //  std::unique_ptr
+#include <atomic>         //  std::atomic
+#include <functional>     //  std::hash
+#include <new>            //  placement new
+#include <utility>        //  std::move / std::pair
 
 #include "types.h"        // data type
+#include "format.h"       // number formatting
+#include "utf8.h"         // string <-> wstring
+#include "parse.h"        // character classification
+#include "hash.h"         // hash of the values
+#include "binary.h"       // binary serialization
+#include "token.h"        // whitespace separated tokens
 #include <iostream>       // std::cout, std::right, std::endl
 
 namespace myodd {
@@ -83,16 +111,50 @@ namespace myodd {
   }
 
   namespace dynamic {
+    class AnyColumn;
+    class AnyColumnWriter;
+    class AnyDictionaryColumn;
+    class AnyCsvReader;
+    class AnyTokenizer;
+    class AnyJsonReader;
+    class AnyJsonWriter;
+    class AnyMsgPackReader;
+    class AnyMsgPackWriter;
+    class AtomicAny;
+    struct AnyEqual;
+
     class Any
     {
+      // the columns read and write the numbers as they are.
+      friend class AnyColumn;
+      friend class AnyColumnWriter;
+      friend class AnyDictionaryColumn;
+
+      // the csv, json and MessagePack readers, and the tokenizer, set the values they reuse.
+      friend class AnyCsvReader;
+      friend class AnyTokenizer;
+      friend class AnyJsonReader;
+      friend class AnyJsonWriter;
+      friend class AnyMsgPackReader;
+      friend class AnyMsgPackWriter;
+      friend class AtomicAny;
+
+      // the keys are compared with the same rules as the hash.
+      friend struct AnyEqual;
+
     private:
       /**
-      * This is the type of comparaison we ar doing.
-      */
-      enum CompareType {
-        CompareType_Equal,
-        CompareType_LessThan,
-        CompareType_MoreThan
+       * The numbers that can be compared as they are, characters are strings and booleans are not numbers.
+       */
+      template<class T>
+      struct is_number : std::integral_constant<bool, std::is_arithmetic<T>::value
+        && !std::is_same<T, bool>::value
+        && !std::is_same<T, char>::value
+        && !std::is_same<T, signed char>::value
+        && !std::is_same<T, unsigned char>::value
+        && !std::is_same<T, wchar_t>::value
+        && dynamic::get_type<T>::value != dynamic::Misc_unknown>
+      {
       };
 
       // the string status, does it represent a number? a floating number?
@@ -112,6 +174,17 @@ namespace myodd {
       };
 
     public:
+      /**
+      * How 2 values compare to each other, (the same values as std::partial_ordering).
+      * Values that are neither less, greater nor equal are unordered, for example "12 Hello" and "12 Bye".
+      */
+      enum Ordering {
+        Ordering_Less = -1,
+        Ordering_Equal = 0,
+        Ordering_Greater = 1,
+        Ordering_Unordered = 2
+      };
+
       /**
       * default constructor.
       */
@@ -121,6 +194,7 @@ namespace myodd {
         _ldvalue(0),
         _cvalue(nullptr),
         _lcvalue(0),
+        _cbuffer(nullptr),
         _stringStatus(StringStatus_Not_A_Number),
         _svalue(nullptr),
         _swvalue(nullptr),
@@ -157,6 +231,16 @@ namespace myodd {
         *this = any;
       }
 
+      /**
+      * Move constructor, we take ownership of whatever the other value owns.
+      * @param Any&& any the value we are moving, it is null after the move.
+      */
+      Any(Any&& any) noexcept :
+        Any()
+      {
+        *this = std::move(any);
+      }
+
       /**
       * Destructor.
       */
@@ -165,6 +249,60 @@ namespace myodd {
         CleanValues();
       }
 
+      /**
+      * Create a value that borrows the given characters rather than copying them.
+      * The characters must outlive the value, (and any view/pointer we return).
+      * Copying the value copies the characters, so the copy owns its characters.
+      * @param const char* source the characters, they do not need to be null terminated.
+      * @param size_t sourceLen the number of characters.
+      * @return Any the value borrowing the characters.
+      */
+      static Any Borrow(const char* source, size_t sourceLen)
+      {
+        Any any;
+        any.BorrowFromCharacters(source, sourceLen);
+        return any;
+      }
+
+      /**
+      * Create a value that borrows the given wide characters rather than copying them.
+      * The characters must outlive the value, (and any view/pointer we return).
+      * Copying the value copies the characters, so the copy owns its characters.
+      * @param const wchar_t* source the characters, they do not need to be null terminated.
+      * @param size_t sourceLen the number of wide characters.
+      * @return Any the value borrowing the characters.
+      */
+      static Any Borrow(const wchar_t* source, size_t sourceLen)
+      {
+        Any any;
+        any.BorrowFromCharacters(source, sourceLen);
+        return any;
+      }
+
+#if MYODD_ANY_CPP17
+      /**
+      * Create a value that borrows the characters of a view rather than copying them.
+      * @see Borrow(const char*, size_t)
+      * @param std::string_view source the characters we are borrowing.
+      * @return Any the value borrowing the characters.
+      */
+      static Any Borrow(std::string_view source)
+      {
+        return Borrow(source.data(), source.size());
+      }
+
+      /**
+      * Create a value that borrows the wide characters of a view rather than copying them.
+      * @see Borrow(const wchar_t*, size_t)
+      * @param std::wstring_view source the characters we are borrowing.
+      * @return Any the value borrowing the characters.
+      */
+      static Any Borrow(std::wstring_view source)
+      {
+        return Borrow(source.data(), source.size());
+      }
+#endif
+
       /**
       * The T operator, cast a value to T
       * @see CastTo
@@ -346,6 +484,22 @@ namespace myodd {
         return CastToChars();
       }
 
+#if MYODD_ANY_CPP17
+      /**
+      * Get a view of the characters without copying them.
+      * The view is only valid as long as this value is not changed or destroyed.
+      * @see CastTo
+      * @return std::string_view the view of the characters.
+      */
+      operator std::string_view() const
+      {
+        // cast *this to value
+        std::string_view value;
+        CastToCharacters(value);
+        return value;
+      }
+#endif
+
       /**
       * The T operator, cast a value to T
       * @see CastTo
@@ -445,6 +599,22 @@ namespace myodd {
         return CastToWideChars();
       }
 
+#if MYODD_ANY_CPP17
+      /**
+      * Get a view of the wide characters without copying them.
+      * The view is only valid as long as this value is not changed or destroyed.
+      * @see CastTo
+      * @return std::wstring_view the view of the characters.
+      */
+      operator std::wstring_view() const
+      {
+        // cast *this to value
+        std::wstring_view value;
+        CastToCharacters(value);
+        return value;
+      }
+#endif
+
       /**
       * The T operator, cast a value to T
       * @see CastTo
@@ -467,27 +637,97 @@ namespace myodd {
         return CastToWideChar();
       }
 
+      /**
+      * Write the value to the stream, the numbers are formatted straight into the stream
+      * and the characters are written as they are, the cached strings are never created.
+      * The width, fill and alignment of the stream are used like they are for a c-string.
+      * @param std::ostream& stream the stream we are writing to.
+      * @param const Any& any the value we are writing.
+      * @return std::ostream& the stream.
+      */
       friend std::ostream& operator<< (std::ostream& stream, const Any& any)
       {
         // write obj to stream
         if ( dynamic::is_type_copy( any.Type() ))
         {
-          stream << "Copy Value";
+          WriteToStream(stream, "Copy Value", 10);
+          return stream;
         }
-        else
+
+        try
+        {
+          any.WriteToStream(stream);
+        }
+        catch (...)
+        {
+          // no idea how to display this.
+          WriteToStream(stream, "NAN", 3);
+        }
+        return stream;
+      }
+
+      /**
+      * Read the next whitespace separated token from the stream, like a std::string would be read,
+      * the characters are read straight from the stream buffer and the numbers are worked out as we copy them.
+      * The value is only changed if a token was read.
+      * @see AnyTokenizer to read a lot of tokens from a stream we own.
+      * @param std::istream& stream the stream we are reading from.
+      * @param Any& any the value we are reading.
+      * @return std::istream& the stream.
+      */
+      friend std::istream& operator>> (std::istream& stream, Any& any)
+      {
+        const std::istream::sentry sentry(stream);
+        if (!sentry)
+        {
+          return stream;
+        }
+
+        // most tokens fit on the stack, the longer ones are kept in a string.
+        char buffer[256];
+        std::string longToken;
+        size_t length = 0;
+        const auto width = stream.width() > 0 ? static_cast<size_t>(stream.width()) : std::numeric_limits<size_t>::max();
+        auto& input = *stream.rdbuf();
+        auto state = std::ios_base::goodbit;
+        for (auto c = input.sgetc();; c = input.snextc())
+        {
+          if (std::char_traits<char>::eq_int_type(c, std::char_traits<char>::eof()))
+          {
+            state |= std::ios_base::eofbit;
+            break;
+          }
+          const auto character = std::char_traits<char>::to_char_type(c);
+          if (length + longToken.size() == width || _Token::is_space(character))
+          {
+            break;
+          }
+          if (length == sizeof(buffer))
+          {
+            longToken.append(buffer, length);
+            length = 0;
+          }
+          buffer[length++] = character;
+        }
+        stream.width(0);
+
+        if (longToken.empty())
         {
-          try
+          if (0 == length)
           {
-            std::string value;
-            any.CastToCharacters(value);
-            stream << value.c_str();
+            state |= std::ios_base::failbit;
           }
-          catch (...)
+          else
           {
-            // no idea how to display this.
-            stream << "NAN";
+            any.AssignCharacters(buffer, length);
           }
         }
+        else
+        {
+          longToken.append(buffer, length);
+          any.AssignCharacters(longToken.data(), longToken.size());
+        }
+        stream.setstate(state);
         return stream;
       }
 
@@ -528,16 +768,65 @@ namespace myodd {
             _unkvalue = other._unkvalue;
           }
           
-          // copy the character value
-          if (other._lcvalue > 0 && other._cvalue)
+          // share the character value, the buffer is never changed once created
+          // so we only need another reference to it rather than a copy.
+          if (other._lcvalue > 0 && other._cbuffer)
           {
+            ++other._cbuffer->_counter;
+            _cbuffer = other._cbuffer;
+            _cvalue = other._cvalue;
             _lcvalue = other._lcvalue;
-            _cvalue = new char[_lcvalue];
-            std::memset(_cvalue, '\0', _lcvalue);
-            std::memcpy(_cvalue, other._cvalue, _lcvalue);
             _stringStatus = other._stringStatus;
           }
+          else if (other.IsBorrowed())
+          {
+            // we do not know how long the borrowed characters will live
+            // so we need our own copy of them.
+            const auto stored = other.StoredLength();
+            CreateCharacterBuffer(other._cvalue, stored, other._lcvalue - stored);
+            _stringStatus = other._stringStatus;
+          }
+        }
+        return *this;
+      }
+
+      /**
+      * The move operator, we take ownership of the buffers, the cosmetic strings
+      * and the unknown value rather than sharing them, so nothing is allocated.
+      * Unlike a copy, a value borrowing its characters still borrows them after the move.
+      * @param Any&& other the value we are moving, it is null after the move.
+      * @return const Any& this value.
+      */
+      const Any& operator = (Any&& other) noexcept
+      {
+        if (this == &other)
+        {
+          return *this;
         }
+
+        // clear everything
+        CleanValues();
+
+        // take the values, borrowed characters are still borrowed after the move.
+        _type = other._type;
+        _llivalue = other._llivalue;
+        _ldvalue = other._ldvalue;
+        _cvalue = other._cvalue;
+        _lcvalue = other._lcvalue;
+        _cbuffer = other._cbuffer;
+        _unkvalue = other._unkvalue;
+        _stringStatus = other._stringStatus;
+        _svalue.store(other._svalue.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        _swvalue.store(other._swvalue.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        // and leave the other value null, it no longer owns anything.
+        other._cbuffer = nullptr;
+        other._unkvalue = nullptr;
+        other._svalue.store(nullptr, std::memory_order_relaxed);
+        other._swvalue.store(nullptr, std::memory_order_relaxed);
+        other.CleanValues();
+        other._type = Type::Misc_null;
+        other._stringStatus = StringStatus_Not_A_Number;
         return *this;
       }
 
@@ -546,14 +835,14 @@ namespace myodd {
       * @param const Any &other the value we are comparing
       * @return bool if the values are equal
       */
-      bool operator==(const Any& other) const { return Compare(*this, other, CompareType_Equal ); }
+      bool operator==(const Any& other) const { return Equal(*this, other); }
 
       /**
       * The friend equal operator.
       * @param const Any &other the value we are comparing
       * @return bool if the values are equal
       */
-      template<class T> friend bool operator==(const T& lhs, const Any& rhs){ return Compare(Any(lhs), rhs, CompareType_Equal); }
+      template<class T> friend bool operator==(const T& lhs, const Any& rhs){ return Equal(Any(lhs), rhs); }
 
       /**
       * The friend equal operator.
@@ -561,35 +850,87 @@ namespace myodd {
       * @param const T &rhs the rhs value we are comparing.
       * @return bool if the values are equal
       */
-      template<class T> friend bool operator==(const Any& lhs, const T& rhs){ return Compare(lhs, Any(rhs), CompareType_Equal); }
+      template<class T> friend bool operator==(const Any& lhs, const T& rhs){ return Equal(lhs, Any(rhs)); }
 
       /**
       * The not equal operator
       * @param const Any &other the value we are comparing
       * @return bool if the values are _not_ equal
       */
-      bool operator!=(const Any &other) const{ return !Compare(*this, other, CompareType_Equal); }
+      bool operator!=(const Any &other) const{ return !Equal(*this, other); }
 
       /**
       * The friend equal operator.
       * @param const Any &other the value we are comparing
       * @return bool if the values are equal
       */
-      template<class T> friend bool operator!=(const T& lhs, const Any& rhs){ return !Compare(Any(lhs), rhs, CompareType_Equal); }
+      template<class T> friend bool operator!=(const T& lhs, const Any& rhs){ return !Equal(Any(lhs), rhs); }
 
       /**
       * The friend equal operator.
       * @param const Any &other the value we are comparing
       * @return bool if the values are equal
       */
-      template<class T> friend bool operator!=(const Any& lhs, const T& rhs){ return !Compare(lhs, Any(rhs), CompareType_Equal); }
+      template<class T> friend bool operator!=(const Any& lhs, const T& rhs){ return !Equal(lhs, Any(rhs)); }
+
+      /**
+      * Compare this value to another value, this is a single compare, so it is quicker than
+      * checking if the value is less than and then if it is greater than the other value.
+      * @param const Any& other the value we are comparing to.
+      * @return Ordering how this value compares to the other value.
+      */
+      Ordering CompareTo(const Any& other) const { return Order(*this, other); }
+
+      /**
+      * Compare this value to another value.
+      * Numbers are compared as they are, without creating a value for them.
+      * @param const T& other the value we are comparing to.
+      * @return Ordering how this value compares to the other value.
+      */
+      template<class T> std::enable_if_t<!is_number<T>::value, Ordering> CompareTo(const T& other) const { return Order(*this, Any(other)); }
+      template<class T> std::enable_if_t<is_number<T>::value, Ordering> CompareTo(const T& other) const { return OrderNumber(*this, other); }
+
+      /**
+      * Compare this value to some characters without creating a value for them.
+      * @see Borrow( ... )
+      * @param const char* / const wchar_t* source the characters, they do not need to be null terminated.
+      * @param size_t sourceLen the number of characters.
+      * @return Ordering how this value compares to the characters.
+      */
+      Ordering CompareTo(const char* source, size_t sourceLen) const { return OrderCharacters(*this, source, sourceLen); }
+      Ordering CompareTo(const wchar_t* source, size_t sourceLen) const { return OrderCharacters(*this, source, sourceLen); }
+
+#if MYODD_ANY_CPP20
+      /**
+      * The three-way comparison operator.
+      * @param const Any& other the value we are comparing to.
+      * @return std::partial_ordering how this value compares to the other value.
+      */
+      std::partial_ordering operator<=>(const Any& other) const
+      {
+        switch (Order(*this, other))
+        {
+        case Ordering_Less:
+          return std::partial_ordering::less;
+
+        case Ordering_Equal:
+          return std::partial_ordering::equivalent;
+
+        case Ordering_Greater:
+          return std::partial_ordering::greater;
+
+        default:
+          return std::partial_ordering::unordered;
+        }
+      }
+#endif
 
       /**
       * Relational operator less than
       * @param const Any& rhs
       * @return bool if *this < rhs
       */
-      bool operator< (const Any& rhs) const { return Compare(*this, rhs, CompareType_LessThan ); }
+      bool operator< (const Any& rhs) const { return Ordering_Less == Order(*this, rhs); }
 
       /**
        * Relational operator less than
@@ -597,7 +938,7 @@ namespace myodd {
        * @param const T& rhs
        * @return bool if lhs < rhs
        */
-      template<class T> friend bool operator< (const Any& lhs, const T& rhs ){ return Compare(lhs, Any(rhs), CompareType_LessThan); }
+      template<class T> friend bool operator< (const Any& lhs, const T& rhs ){ return Ordering_Less == Order(lhs, Any(rhs)); }
 
       /**
       * Relational operator less than
@@ -605,14 +946,14 @@ namespace myodd {
       * @param const Any& rhs
       * @return bool if lhs < rhs
       */
-      template<class T> friend bool operator< (const T& lhs, const Any& rhs) { return Compare(Any(lhs), rhs, CompareType_LessThan); }
+      template<class T> friend bool operator< (const T& lhs, const Any& rhs) { return Ordering_Less == Order(Any(lhs), rhs); }
 
       /**
       * Relational operator greater than
       * @param const Any& rhs
       * @return bool if lhs > rhs
       */
-      bool operator> (const Any& rhs) const { return Compare(*this, rhs, CompareType_MoreThan); }
+      bool operator> (const Any& rhs) const { return Ordering_Greater == Order(*this, rhs); }
 
       /**
       * Relational operator greater than
@@ -620,7 +961,7 @@ namespace myodd {
       * @param const Any& rhs
       * @return bool if lhs > rhs
       */
-      template<class T>  friend bool operator> (const T& lhs, const Any& rhs) { return Compare(Any(lhs), rhs, CompareType_MoreThan); }
+      template<class T>  friend bool operator> (const T& lhs, const Any& rhs) { return Ordering_Greater == Order(Any(lhs), rhs); }
 
       /**
       * Relational operator greater than
@@ -628,7 +969,7 @@ namespace myodd {
       * @param const Any& rhs
       * @return bool if lhs > rhs
       */
-      template<class T>  friend bool operator> (const Any& lhs, const T& rhs) { return Compare(lhs, Any(rhs), CompareType_MoreThan); }
+      template<class T>  friend bool operator> (const Any& lhs, const T& rhs) { return Ordering_Greater == Order(lhs, Any(rhs)); }
 
       /**
       * Relational operator less or equal than
@@ -1421,127 +1762,333 @@ namespace myodd {
         return _type;
       }
 
-    protected:
       /**
-      * Regadless the data type, we try and guess that the number type could be.
-      * mainly used for string, so we can guess the string type.
-      * If this is a number we will return the number type, otherwse we will try and work it out.
-      * If we do not know we will return Integer_int
-      * @return dynamic::Type the string type.
+      * Check if the value is a copy of a structure/class of the given type, (and not a pointer to it)
+      * @return bool if we are holding a copy of a T.
       */
-      dynamic::Type NumberType() const
+      template<class T>
+      bool IsCopyOf() const
       {
-        //  if it is not a character then just use whatever we have
-        if (dynamic::is_type_null(Type()))
-        {
-          return dynamic::Integer_int;
-        }
-
-        //  if it is not a character then just use whatever we have
-        if (!dynamic::is_type_character(Type()))
-        {
-          return Type();
-        }
+        return dynamic::Misc_copy == Type() && nullptr != _unkvalue && _unkvalue->Tag() == TypeTag<T>();
+      }
 
-        // if the string is not a number, just use an int.
-        if (!IsStringNumber(true))
+      /**
+      * Get the hash of the value, so it can be used in hashed containers.
+      * Numbers, (and strings that are numbers), are hashed by value so 12, 12.0 and "12" have the same hash.
+      * Other strings are hashed by their characters, the hash is worked out once and shared by all the copies.
+      * operator== compares those strings to a number by their leading number, ("12abc" == 12, "abc" == 0),
+      * so the hashed containers must use AnyHash and compare the keys with AnyEqual, (@see AnyEqual).
+      * @return size_t the hash of the value.
+      */
+      size_t Hash() const
+      {
+        if (dynamic::is_type_copy(Type()))
         {
-          // this is not a number, so zero will be used.
-          // we might as well use an int.
-          return dynamic::Integer_int;
+          // the copies are compared by their own operator, so we can only use the size.
+          return static_cast<size_t>(_Hash::mix(_unkvalue ? _unkvalue->Size() : 0));
         }
 
-        // it seems to be a number, so we need to calculate what type of number it is.
-        switch (_stringStatus)
+        if (dynamic::is_type_character(Type()) && !IsStringNumber(false))
         {
-        case dynamic::Any::StringStatus_Pos_Number:
-        case dynamic::Any::StringStatus_Partial_Pos_Number:
-          if (_llivalue < 0)
-          {
-            return dynamic::Integer_unsigned_long_long_int;
-          }
-          return dynamic::Integer_long_long_int;
-
-        case dynamic::Any::StringStatus_Neg_Number:
-        case dynamic::Any::StringStatus_Partial_Neg_Number:
-          return dynamic::Integer_long_long_int;
-
-        case dynamic::Any::StringStatus_Floating_Pos_Number:
-        case dynamic::Any::StringStatus_Floating_Neg_Number:
-        case dynamic::Any::StringStatus_Floating_Partial_Pos_Number:
-        case dynamic::Any::StringStatus_Floating_Partial_Neg_Number:
-          return dynamic::Floating_point_long_double;
-
-        default:
-          throw std::runtime_error("Unknown string type!");
+          return static_cast<size_t>(CharactersHash());
         }
+        return static_cast<size_t>(hash_number(KeyNumber()));
       }
 
       /**
-      * Calculate the type for division
-      * @param const dynamic::Type& lhs the lhs type
-      * @param const dynamic::Type& rhs the rhs type
-      * @return dynamic::Type the best type for division
+      * Append the value to a buffer in a compact binary form, the type is kept as it is,
+      * integers are written as varints, floating points as their bits and characters
+      * with their length, so the value can be read back without parsing anything.
+      * This is a single value, @see AnyWriter to write a versioned stream of values.
+      * @throw std::runtime_error if the value is a copy of an object, we cannot write those.
+      * @param std::string& buffer where we are writing the value.
       */
-      static dynamic::Type CalculateDivideType(const dynamic::Type& lhs, const dynamic::Type& rhs)
+      void Serialize(std::string& buffer) const
       {
-        if (lhs == dynamic::Floating_point_long_double || rhs == dynamic::Floating_point_long_double)
+        switch (Type())
         {
-          return dynamic::Floating_point_long_double;
-        }
+        case dynamic::Misc_null:
+          buffer += BinaryTag(0);
+          return;
 
-        if (lhs == dynamic::Integer_long_long_int || rhs == dynamic::Integer_long_long_int)
-        {
-          return dynamic::Floating_point_long_double;
-        }
+        case dynamic::Misc_copy:
+        case dynamic::Misc_copy_ptr:
+          throw std::runtime_error("Unable to serialize a copy of an object.");
 
-        if (lhs == dynamic::Integer_unsigned_long_long_int || rhs == dynamic::Integer_unsigned_long_long_int)
-        {
-          return dynamic::Floating_point_long_double;
-        }
+        case dynamic::Character_signed_char:
+        case dynamic::Character_unsigned_char:
+        case dynamic::Character_char:
+        case dynamic::Character_wchar_t:
+          SerializeCharacters(buffer);
+          return;
 
-        else if (lhs == dynamic::Integer_long_int || rhs == dynamic::Integer_long_int)
-        {
-          return dynamic::Floating_point_long_double;
-        }
+        case dynamic::Boolean_bool:
+        case dynamic::Integer_short_int:
+        case dynamic::Integer_unsigned_short_int:
+        case dynamic::Integer_int:
+        case dynamic::Integer_unsigned_int:
+        case dynamic::Integer_long_int:
+        case dynamic::Integer_unsigned_long_int:
+        case dynamic::Integer_long_long_int:
+        case dynamic::Integer_unsigned_long_long_int:
+        case dynamic::Floating_point_float:
+        case dynamic::Floating_point_double:
+        case dynamic::Floating_point_long_double:
+          SerializeNumber(buffer);
+          return;
 
-        if (lhs == dynamic::Integer_unsigned_long_int || rhs == dynamic::Integer_unsigned_long_int)
-        {
-          return dynamic::Floating_point_long_double;
+        case dynamic::Misc_unknown:
+          break;
         }
 
-        // default value.
-        return dynamic::Floating_point_double;
+        // unknown
+        throw std::runtime_error("Unknown data Type");
       }
 
       /**
-      * This function is used to re-calculate the 'best' type after an arithmetic opereation
-      * For example int*int could give us a long long
-      *          or int / int could give us a double.
-      * NB: this function does not _set_ the type, it only calculates the posible value.
-      *     it is up to the call function to set the new type.
-      * @param const Any& lhs the original number on the lhs of the operation
-      * @param const dynamic::Type& rhsOriginal the original type on the rhs of the operation
-      * @return dynamic::Type the posible new type.
+      * Read a value written with Serialize( ... )
+      * @throw _Binary::truncated_error if we need more data to read the value.
+      * @throw std::runtime_error if the data is not a value.
+      * @param const char*& source where we are reading from, moved past the value.
+      * @param const char* end the end of the data.
+      * @return Any the value.
       */
-      static dynamic::Type CalculateType(const Any& lhs, const Any& rhs)
+      static Any Deserialize(const char*& source, const char* end)
       {
-        auto lhsOriginal = lhs.NumberType();
-        auto rhsOriginal = rhs.NumberType();
-        return CalculateType(lhsOriginal, rhsOriginal);
+        return DeserializeValue(source, end, false);
       }
 
       /**
-      * This function is used to re-calculate the 'best' type after an arithmetic opereation
-      * For example int*int could give us a long long
-      *          or int / int could give us a double.
-      * NB: this function does not _set_ the type, it only calculates the posible value.
-      *     it is up to the call function to set the new type.
-      * @param const Any& lhs the original number on the lhs of the operation
-      * @param const dynamic::Type& rhsOriginal the original type on the rhs of the operation
-      * @return dynamic::Type the posible new type.
+      * Read a value written with Serialize( ... ), strings borrow their characters from the data
+      * rather than copying them, so the data must outlive the value, (and any view/pointer we return).
+      * Wide strings and single characters are small or not written as they are, so they are still copied.
+      * @see Deserialize( ... )
+      * @param const char*& source where we are reading from, moved past the value.
+      * @param const char* end the end of the data.
+      * @return Any the value.
       */
-      static dynamic::Type CalculateType(const Any& lhs, const dynamic::Type& rhsOriginal)
+      static Any DeserializeBorrowed(const char*& source, const char* end)
+      {
+        return DeserializeValue(source, end, true);
+      }
+
+      /**
+      * Move past a value written with Serialize( ... ) without reading it.
+      * @throw _Binary::truncated_error if the value is truncated.
+      * @param const char*& source where we are reading from, moved past the value.
+      * @param const char* end the end of the data.
+      */
+      static void SkipSerialized(const char*& source, const char* end)
+      {
+        const char* it = source;
+        const auto tag = _Binary::read_byte(it, end);
+        const auto type = static_cast<dynamic::Type>(tag & BinaryTypeMask);
+        const auto representation = static_cast<BinaryRepresentation>(tag >> BinaryRepresentationShift);
+        switch (type)
+        {
+        case dynamic::Misc_null:
+          break;
+
+        case dynamic::Character_signed_char:
+        case dynamic::Character_unsigned_char:
+        case dynamic::Character_char:
+        case dynamic::Character_wchar_t:
+          SkipCharacters(type, representation, it, end);
+          break;
+
+        case dynamic::Boolean_bool:
+        case dynamic::Integer_short_int:
+        case dynamic::Integer_unsigned_short_int:
+        case dynamic::Integer_int:
+        case dynamic::Integer_unsigned_int:
+        case dynamic::Integer_long_int:
+        case dynamic::Integer_unsigned_long_int:
+        case dynamic::Integer_long_long_int:
+        case dynamic::Integer_unsigned_long_long_int:
+        case dynamic::Floating_point_float:
+        case dynamic::Floating_point_double:
+        case dynamic::Floating_point_long_double:
+          SkipNumber(representation, it, end);
+          break;
+
+        default:
+          throw std::runtime_error("Unknown data Type");
+        }
+        source = it;
+      }
+
+    protected:
+      /**
+      * Read a value written with Serialize( ... )
+      * @param const char*& source where we are reading from, moved past the value.
+      * @param const char* end the end of the data.
+      * @param bool borrow if the strings borrow their characters from the data.
+      * @return Any the value.
+      */
+      static Any DeserializeValue(const char*& source, const char* end, bool borrow)
+      {
+        const char* it = source;
+        const auto tag = _Binary::read_byte(it, end);
+        const auto type = static_cast<dynamic::Type>(tag & BinaryTypeMask);
+        const auto representation = static_cast<BinaryRepresentation>(tag >> BinaryRepresentationShift);
+
+        Any value;
+        switch (type)
+        {
+        case dynamic::Misc_null:
+          break;
+
+        case dynamic::Character_signed_char:
+        case dynamic::Character_unsigned_char:
+        case dynamic::Character_char:
+        case dynamic::Character_wchar_t:
+          value.DeserializeCharacters(type, representation, it, end, borrow);
+          break;
+
+        case dynamic::Boolean_bool:
+        case dynamic::Integer_short_int:
+        case dynamic::Integer_unsigned_short_int:
+        case dynamic::Integer_int:
+        case dynamic::Integer_unsigned_int:
+        case dynamic::Integer_long_int:
+        case dynamic::Integer_unsigned_long_int:
+        case dynamic::Integer_long_long_int:
+        case dynamic::Integer_unsigned_long_long_int:
+        case dynamic::Floating_point_float:
+        case dynamic::Floating_point_double:
+        case dynamic::Floating_point_long_double:
+          value.DeserializeNumber(type, representation, it, end);
+          break;
+
+        default:
+          throw std::runtime_error("Unknown data Type");
+        }
+
+        // we only move once we have the full value.
+        source = it;
+        return value;
+      }
+
+      /**
+      * Regadless the data type, we try and guess that the number type could be.
+      * mainly used for string, so we can guess the string type.
+      * If this is a number we will return the number type, otherwse we will try and work it out.
+      * If we do not know we will return Integer_int
+      * @return dynamic::Type the string type.
+      */
+      dynamic::Type NumberType() const
+      {
+        //  if it is not a character then just use whatever we have
+        if (dynamic::is_type_null(Type()))
+        {
+          return dynamic::Integer_int;
+        }
+
+        //  if it is not a character then just use whatever we have
+        if (!dynamic::is_type_character(Type()))
+        {
+          return Type();
+        }
+
+        // if the string is not a number, just use an int.
+        if (!IsStringNumber(true))
+        {
+          // this is not a number, so zero will be used.
+          // we might as well use an int.
+          return dynamic::Integer_int;
+        }
+
+        // it seems to be a number, so we need to calculate what type of number it is.
+        switch (_stringStatus)
+        {
+        case dynamic::Any::StringStatus_Pos_Number:
+        case dynamic::Any::StringStatus_Partial_Pos_Number:
+          if (_llivalue < 0)
+          {
+            return dynamic::Integer_unsigned_long_long_int;
+          }
+          return dynamic::Integer_long_long_int;
+
+        case dynamic::Any::StringStatus_Neg_Number:
+        case dynamic::Any::StringStatus_Partial_Neg_Number:
+          return dynamic::Integer_long_long_int;
+
+        case dynamic::Any::StringStatus_Floating_Pos_Number:
+        case dynamic::Any::StringStatus_Floating_Neg_Number:
+        case dynamic::Any::StringStatus_Floating_Partial_Pos_Number:
+        case dynamic::Any::StringStatus_Floating_Partial_Neg_Number:
+          return dynamic::Floating_point_long_double;
+
+        default:
+          throw std::runtime_error("Unknown string type!");
+        }
+      }
+
+      /**
+      * Calculate the type for division
+      * @param const dynamic::Type& lhs the lhs type
+      * @param const dynamic::Type& rhs the rhs type
+      * @return dynamic::Type the best type for division
+      */
+      static dynamic::Type CalculateDivideType(const dynamic::Type& lhs, const dynamic::Type& rhs)
+      {
+        if (lhs == dynamic::Floating_point_long_double || rhs == dynamic::Floating_point_long_double)
+        {
+          return dynamic::Floating_point_long_double;
+        }
+
+        if (lhs == dynamic::Integer_long_long_int || rhs == dynamic::Integer_long_long_int)
+        {
+          return dynamic::Floating_point_long_double;
+        }
+
+        if (lhs == dynamic::Integer_unsigned_long_long_int || rhs == dynamic::Integer_unsigned_long_long_int)
+        {
+          return dynamic::Floating_point_long_double;
+        }
+
+        else if (lhs == dynamic::Integer_long_int || rhs == dynamic::Integer_long_int)
+        {
+          return dynamic::Floating_point_long_double;
+        }
+
+        if (lhs == dynamic::Integer_unsigned_long_int || rhs == dynamic::Integer_unsigned_long_int)
+        {
+          return dynamic::Floating_point_long_double;
+        }
+
+        // default value.
+        return dynamic::Floating_point_double;
+      }
+
+      /**
+      * This function is used to re-calculate the 'best' type after an arithmetic opereation
+      * For example int*int could give us a long long
+      *          or int / int could give us a double.
+      * NB: this function does not _set_ the type, it only calculates the posible value.
+      *     it is up to the call function to set the new type.
+      * @param const Any& lhs the original number on the lhs of the operation
+      * @param const dynamic::Type& rhsOriginal the original type on the rhs of the operation
+      * @return dynamic::Type the posible new type.
+      */
+      static dynamic::Type CalculateType(const Any& lhs, const Any& rhs)
+      {
+        auto lhsOriginal = lhs.NumberType();
+        auto rhsOriginal = rhs.NumberType();
+        return CalculateType(lhsOriginal, rhsOriginal);
+      }
+
+      /**
+      * This function is used to re-calculate the 'best' type after an arithmetic opereation
+      * For example int*int could give us a long long
+      *          or int / int could give us a double.
+      * NB: this function does not _set_ the type, it only calculates the posible value.
+      *     it is up to the call function to set the new type.
+      * @param const Any& lhs the original number on the lhs of the operation
+      * @param const dynamic::Type& rhsOriginal the original type on the rhs of the operation
+      * @return dynamic::Type the posible new type.
+      */
+      static dynamic::Type CalculateType(const Any& lhs, const dynamic::Type& rhsOriginal)
       {
         return CalculateType(lhs.NumberType(), rhsOriginal);
       }
@@ -1654,13 +2201,15 @@ namespace myodd {
       }
 
       /**
-       * Calculate if the lhs is 'smaller' then the rhs
+       * Order 2 values, this is the only place where we work out how the types compare.
+       * Values that are neither less, greater nor equal are unordered, for example
+       * "12 Hello" and "12 Bye" have the same number, but not the same characters,
+       * or 2 copies of structures that are not the same.
        * @param const Any& lhs the lhs value been compared.
        * @param const Any& rhs the rhs value been compared.
-       * @param const CompareType&  the type of comparaison been done.
-       * @return bool if the lhs < rhs
+       * @return Ordering how lhs compares to rhs.
        */
-      static bool Compare(const Any& lhs, const Any& rhs, const CompareType& compareType )
+      static Ordering Order(const Any& lhs, const Any& rhs)
       {
         // validates that we have known types.
         if (!dynamic::is_known_type(lhs.Type()) || !dynamic::is_known_type(rhs.Type()))
@@ -1671,387 +2220,326 @@ namespace myodd {
         // check for null types.
         if (dynamic::is_type_null(lhs.Type()) && dynamic::is_type_null(rhs.Type() ))
         {
-          switch (compareType)
-          {
-          case CompareType_Equal:
-            // both are the same, so if both null then they are the same.
-            // all the values should be the same but there is no point in checking.
-            return true;
-
-          case CompareType_LessThan:
-          case CompareType_MoreThan:
-            // both are the same, so if both null then they are
-            // neither greater or less than the other one.
-            return false;
-
-          default:
-            throw std::runtime_error("Unknown compare type");
-          }
+          // both are the same, so if both null then they are the same.
+          // all the values should be the same but there is no point in checking.
+          return Ordering_Equal;
         }
 
         // are we comparing trivial structures
         if (dynamic::is_type_copy(lhs.Type()) || dynamic::is_type_copy(rhs.Type()))
         {
-          switch (compareType)
+          // we cannot compare greater/less than objects, they are either the same or not.
+          if (lhs.Type() == dynamic::Misc_copy && rhs.Type() == dynamic::Misc_copy)
           {
-          case CompareType_Equal:
-            return EqualCopy(lhs, rhs);
-
-          case CompareType_LessThan:
-          case CompareType_MoreThan:
-            // we cannot compare greater/less than objects.
-            return false;
-
-          default:
-            throw std::runtime_error("Unknown compare type");
+            return EqualCopy(lhs, rhs) ? Ordering_Equal : Ordering_Unordered;
           }
+          return Ordering_Unordered;
         }
 
         // if either of them is a string, then we need to check them first.
         if (dynamic::is_type_character(lhs.Type()) || dynamic::is_type_character(rhs.Type()))
         {
-          return CompareString(lhs, rhs, compareType);
+          return OrderStrings(lhs, rhs);
         }
 
-        return CompareNumber(lhs, rhs, compareType);
+        return OrderNumbers(lhs, rhs);
       }
 
       /**
-       * Calculate if the lhs is 'smaller' then the rhs
-       * This is the default behaviour, in the case of a numeric compare.
+       * Check if 2 values are the same.
+       * Strings that are not both numbers are only the same if their characters are the same,
+       * we can check that without ordering them, (the length and the hashes first).
        * @param const Any& lhs the lhs value been compared.
        * @param const Any& rhs the rhs value been compared.
-       * @param const CompareType&  the type of comparaison been done.
-       * @return bool if the lhs < rhs
+       * @return bool if they are the same or not.
        */
-      static bool CompareNumber(const Any& lhs, const Any& rhs, const CompareType& compareType)
+      static bool Equal(const Any& lhs, const Any& rhs)
       {
-        auto type = CalculateType(lhs, rhs);
-        switch (type)
+        if (dynamic::is_type_character(lhs.Type()) && dynamic::is_type_character(rhs.Type()))
         {
-        case Boolean_bool:
-        case Character_signed_char:
-        case Character_unsigned_char:
-        case Character_char:
-        case Character_wchar_t:
-
-        // short integers are always converted to Integer_Int
-        case Integer_short_int:
-        case Integer_unsigned_short_int:
-          throw std::runtime_error("Logic error, the function CalculateType() should never return those types.");
-
-        case Integer_int:
-        case Integer_unsigned_int:
-          if (lhs.UseSignedInteger() && rhs.UseSignedInteger())
+          // "12.0" == "12" but "12 Hello" != "12 Bye"
+          if (!lhs.IsStringNumber(false) || !rhs.IsStringNumber(false))
           {
-            switch (compareType)
-            {
-            case CompareType_Equal:
-              return ((int)lhs._llivalue == (int)rhs._llivalue);
-
-            case CompareType_LessThan:
-              return ((int)lhs._llivalue < (int)rhs._llivalue);
-
-            case CompareType_MoreThan:
-              return ((int)lhs._llivalue > (int)rhs._llivalue);
-
-            default:
-              throw std::runtime_error("Unknown compare type");
-            }
+            return EqualCharacters(lhs, rhs);
           }
-          else if (lhs.UseUnsignedInteger() && rhs.UseSignedInteger())
-          {
-            // as we know that rhs is signed then if rhs < 0 then it must be smaller than unsigned lhs
-            switch (compareType)
-            {
-            case CompareType_Equal:
-              return (rhs._llivalue >= 0 && (unsigned int)lhs._llivalue == (unsigned int)rhs._llivalue);
+          return Ordering_Equal == OrderNumbers(lhs, rhs);
+        }
 
-            case CompareType_LessThan:
-              return (rhs._llivalue >= 0 && (unsigned int)lhs._llivalue < (unsigned int)rhs._llivalue);
+        // copies might not be comparable.
+        if (dynamic::is_type_copy(lhs.Type()) || dynamic::is_type_copy(rhs.Type()))
+        {
+          return EqualCopy(lhs, rhs);
+        }
+        return Ordering_Equal == Order(lhs, rhs);
+      }
 
-            case CompareType_MoreThan:
-              return (rhs._llivalue < 0 || (unsigned int)lhs._llivalue > (unsigned int)rhs._llivalue);
+      /**
+       * Order 2 values of the same type.
+       * @param const T& lhs the lhs value been compared.
+       * @param const T& rhs the rhs value been compared.
+       * @return Ordering how lhs compares to rhs, (NaN is unordered).
+       */
+      template<class T>
+      static Ordering OrderValues(const T& lhs, const T& rhs)
+      {
+        if (lhs < rhs)
+        {
+          return Ordering_Less;
+        }
+        if (rhs < lhs)
+        {
+          return Ordering_Greater;
+        }
+        return (lhs == rhs) ? Ordering_Equal : Ordering_Unordered;
+      }
 
-            default:
-              throw std::runtime_error("Unknown compare type");
-            }
-          }
-          else if (lhs.UseSignedInteger() && rhs.UseUnsignedInteger())
-          {
-            // as we know that lhs is signed then if lhs < 0 then it must be smaller than unsigned rhs
-            switch (compareType)
-            {
-            case CompareType_Equal:
-              return (lhs._llivalue >= 0 && (unsigned int)lhs._llivalue == (unsigned int)rhs._llivalue);
+      /**
+       * Order 2 integers of the same type, integers are always ordered
+       * so we can work it out without branches.
+       * @param const T lhs the lhs value been compared.
+       * @param const T rhs the rhs value been compared.
+       * @return Ordering how lhs compares to rhs.
+       */
+      template<class T>
+      static Ordering OrderIntegerValues(const T lhs, const T rhs)
+      {
+        return static_cast<Ordering>(static_cast<int>(rhs < lhs) - static_cast<int>(lhs < rhs));
+      }
 
-            case CompareType_LessThan:
-              return (lhs._llivalue < 0 || (unsigned int)lhs._llivalue < (unsigned int)rhs._llivalue);
+      /**
+       * How the number of a value is used when we compare integers.
+       */
+      enum IntegerClass
+      {
+        IntegerClass_Signed = 0,
+        IntegerClass_Unsigned = 1,
+        IntegerClass_Other = 2       // booleans are neither signed nor unsigned.
+      };
 
-            case CompareType_MoreThan:
-              return (lhs._llivalue >= 0 && (unsigned int)lhs._llivalue > (unsigned int)rhs._llivalue);
+      /**
+       * How 2 integers are compared, depending on their classes.
+       */
+      enum IntegerOrder
+      {
+        IntegerOrder_Signed,        // both are signed.
+        IntegerOrder_Unsigned,      // compare both as unsigned.
+        IntegerOrder_Lhs_Signed,    // lhs is signed and rhs is unsigned, a negative lhs is less.
+        IntegerOrder_Rhs_Signed     // lhs is unsigned and rhs is signed, a negative rhs is less.
+      };
 
-            default:
-              throw std::runtime_error("Unknown compare type");
-            }
-          }
-          else
-          {
-            switch (compareType)
-            {
-            case CompareType_Equal:
-              return ((unsigned int)lhs._llivalue == (unsigned int)rhs._llivalue);
-
-            case CompareType_LessThan:
-              return ((unsigned int)lhs._llivalue < (unsigned int)rhs._llivalue);
-
-            case CompareType_MoreThan:
-              return ((unsigned int)lhs._llivalue > (unsigned int)rhs._llivalue);
+      /**
+       * Get the class of a number type.
+       * @see UseSignedInteger()
+       * @see UseUnsignedInteger()
+       * @param const dynamic::Type& numberType the number type of the value.
+       * @return IntegerClass the class of the number.
+       */
+      static IntegerClass IntegerClassOf(const dynamic::Type& numberType)
+      {
+        switch (numberType)
+        {
+        case dynamic::Integer_short_int:
+        case dynamic::Integer_int:
+        case dynamic::Integer_long_int:
+        case dynamic::Integer_long_long_int:
+          return IntegerClass_Signed;
 
-            default:
-              throw std::runtime_error("Unknown compare type");
-            }
-          }
-          break;
+        case dynamic::Integer_unsigned_short_int:
+        case dynamic::Integer_unsigned_int:
+        case dynamic::Integer_unsigned_long_int:
+        case dynamic::Integer_unsigned_long_long_int:
+          return IntegerClass_Unsigned;
 
-        case Integer_long_int:
-        case Integer_unsigned_long_int:
-          if (lhs.UseSignedInteger() && rhs.UseSignedInteger())
-          {
-            switch (compareType)
-            {
-            case CompareType_Equal:
-              return ((long int)lhs._llivalue == (long int)rhs._llivalue);
+        default:
+          return IntegerClass_Other;
+        }
+      }
 
-            case CompareType_LessThan:
-              return ((long int)lhs._llivalue < (long int)rhs._llivalue);
+      /**
+       * Work out how 2 integers are compared.
+       * @param const dynamic::Type& lhsType the number type of the lhs value.
+       * @param const dynamic::Type& rhsType the number type of the rhs value.
+       * @return IntegerOrder how the 2 integers are compared.
+       */
+      static IntegerOrder IntegerOrderOf(const dynamic::Type& lhsType, const dynamic::Type& rhsType)
+      {
+        // [lhs class][rhs class]
+        static constexpr IntegerOrder orders[3][3] = {
+          { IntegerOrder_Signed,      IntegerOrder_Lhs_Signed, IntegerOrder_Unsigned },
+          { IntegerOrder_Rhs_Signed,  IntegerOrder_Unsigned,   IntegerOrder_Unsigned },
+          { IntegerOrder_Unsigned,    IntegerOrder_Unsigned,   IntegerOrder_Unsigned }
+        };
+        return orders[IntegerClassOf(lhsType)][IntegerClassOf(rhsType)];
+      }
 
-            case CompareType_MoreThan:
-              return ((long int)lhs._llivalue > (long int)rhs._llivalue);
+      /**
+       * Order 2 integers, signed values are compared as S and unsigned values as U.
+       * @param long long int lhs the lhs value been compared.
+       * @param long long int rhs the rhs value been compared.
+       * @param IntegerOrder order how the 2 integers are compared.
+       * @return Ordering how lhs compares to rhs.
+       */
+      template<class S, class U>
+      static Ordering OrderIntegers(long long int lhs, long long int rhs, IntegerOrder order)
+      {
+        switch (order)
+        {
+        case IntegerOrder_Signed:
+          return OrderIntegerValues(static_cast<S>(lhs), static_cast<S>(rhs));
 
-            default:
-              throw std::runtime_error("Unknown compare type");
-            }
-          }
-          else if (lhs.UseUnsignedInteger() && rhs.UseSignedInteger())
+        case IntegerOrder_Rhs_Signed:
+          // as we know that rhs is signed then if rhs < 0 then it must be smaller than unsigned lhs
+          if (rhs < 0)
           {
-            // as we know that rhs is signed then if rhs < 0 then it must be smaller than unsigned lhs
-            switch (compareType)
-            {
-            case CompareType_Equal:
-              return (rhs._llivalue >= 0 && (unsigned long int)lhs._llivalue == (unsigned long int)rhs._llivalue);
-
-            case CompareType_LessThan:
-              return (rhs._llivalue >= 0 && (unsigned long int)lhs._llivalue < (unsigned long int)rhs._llivalue);
-
-            case CompareType_MoreThan:
-              return (rhs._llivalue < 0 || (unsigned long int)lhs._llivalue > (unsigned long int)rhs._llivalue);
-
-            default:
-              throw std::runtime_error("Unknown compare type");
-            }
+            return Ordering_Greater;
           }
-          else if (lhs.UseSignedInteger() && rhs.UseUnsignedInteger())
-          {
-            // as we know that lhs is signed then if lhs < 0 then it must be smaller than unsigned rhs
-            switch (compareType)
-            {
-            case CompareType_Equal:
-              return (lhs._llivalue >= 0 && (unsigned long int)lhs._llivalue == (unsigned long int)rhs._llivalue);
-
-            case CompareType_LessThan:
-              return (lhs._llivalue < 0 || (unsigned long int)lhs._llivalue < (unsigned long int)rhs._llivalue);
-
-            case CompareType_MoreThan:
-              return (lhs._llivalue >= 0 && (unsigned long int)lhs._llivalue > (unsigned long int)rhs._llivalue);
+          break;
 
-            default:
-              throw std::runtime_error("Unknown compare type");
-            }
-          }
-          else
+        case IntegerOrder_Lhs_Signed:
+          // as we know that lhs is signed then if lhs < 0 then it must be smaller than unsigned rhs
+          if (lhs < 0)
           {
-            switch (compareType)
-            {
-            case CompareType_Equal:
-              return ((unsigned long int)lhs._llivalue == (unsigned long int)rhs._llivalue);
-
-            case CompareType_LessThan:
-              return ((unsigned long int)lhs._llivalue < (unsigned long int)rhs._llivalue);
-
-            case CompareType_MoreThan:
-              return ((unsigned long int)lhs._llivalue > (unsigned long int)rhs._llivalue);
-
-            default:
-              throw std::runtime_error("Unknown compare type");
-            }
+            return Ordering_Less;
           }
           break;
 
-        case Integer_long_long_int:
-        case Integer_unsigned_long_long_int:
-          if (lhs.UseSignedInteger() && rhs.UseSignedInteger())
-          {
-            switch (compareType)
-            {
-            case CompareType_Equal:
-              return ((long long int)lhs._llivalue == (long long int)rhs._llivalue);
-
-            case CompareType_LessThan:
-              return ((long long int)lhs._llivalue < (long long int)rhs._llivalue);
+        case IntegerOrder_Unsigned:
+          break;
+        }
+        return OrderIntegerValues(static_cast<U>(lhs), static_cast<U>(rhs));
+      }
 
-            case CompareType_MoreThan:
-              return ((long long int)lhs._llivalue > (long long int)rhs._llivalue);
+      /**
+       * Order 2 values as numbers
+       * This is the default behaviour, in the case of a numeric compare.
+       * Each value is classified once, and the type we compare them as is worked out from both.
+       * @param const Any& lhs the lhs value been compared.
+       * @param const Any& rhs the rhs value been compared.
+       * @return Ordering how lhs compares to rhs.
+       */
+      static Ordering OrderNumbers(const Any& lhs, const Any& rhs)
+      {
+        return OrderNumbers(lhs.NumberType(), lhs._llivalue, lhs._ldvalue, rhs.NumberType(), rhs._llivalue, rhs._ldvalue);
+      }
 
-            default:
-              throw std::runtime_error("Unknown compare type");
-            }
-          }
-          else if (lhs.UseUnsignedInteger() && rhs.UseSignedInteger())
-          {
-            // as we know that rhs is signed then if rhs < 0 then it must be smaller than unsigned lhs
-            switch (compareType)
-            {
-            case CompareType_Equal:
-              return (rhs._llivalue >= 0 && (unsigned long long int)lhs._llivalue == (unsigned long long int)rhs._llivalue);
+      /**
+       * Order a value and a number, the number is compared as it is, (we do not create a value for it).
+       * @param const Any& lhs the lhs value been compared.
+       * @param const T& number the rhs number.
+       * @return Ordering how lhs compares to the number.
+       */
+      template<class T>
+      static Ordering OrderNumber(const Any& lhs, const T& number)
+      {
+        const dynamic::Type numberType = dynamic::get_type<T>::value;
 
-            case CompareType_LessThan:
-              return (rhs._llivalue >= 0 && (unsigned long long int)lhs._llivalue < (unsigned long long int)rhs._llivalue);
+        // integers are always compared exactly, so we only need to know which one is signed.
+        if (std::is_integral<T>::value && IntegerClass_Other != IntegerClassOf(lhs.Type()))
+        {
+          return OrderIntegers<long long int, unsigned long long int>(lhs._llivalue, static_cast<long long int>(number), IntegerOrderOf(lhs.Type(), numberType));
+        }
 
-            case CompareType_MoreThan:
-              return (rhs._llivalue < 0 || (unsigned long long int)lhs._llivalue > (unsigned long long int)rhs._llivalue);
+        // validates that we have a known type.
+        if (!dynamic::is_known_type(lhs.Type()))
+        {
+          throw std::runtime_error("Unknown data Type");
+        }
 
-            default:
-              throw std::runtime_error("Unknown compare type");
-            }
-          }
-          else if (lhs.UseSignedInteger() && rhs.UseUnsignedInteger())
-          {
-            // as we know that lhs is signed then if lhs < 0 then it must be smaller than unsigned rhs
-            switch (compareType)
-            {
-            case CompareType_Equal:
-              return (lhs._llivalue >= 0 && (unsigned long long int)lhs._llivalue == (unsigned long long int)rhs._llivalue);
+        // we cannot compare greater/less than objects.
+        if (dynamic::is_type_copy(lhs.Type()))
+        {
+          return Ordering_Unordered;
+        }
 
-            case CompareType_LessThan:
-              return (lhs._llivalue < 0 || (unsigned long long int)lhs._llivalue < (unsigned long long int)rhs._llivalue);
+        // null and strings are compared by their number, (or zero), like any other value.
+        // the integers and the floating points are held the same way as CreateFromInteger/CreateFromDouble
+        const auto integer = std::is_floating_point<T>::value ? 0 : static_cast<long long int>(number);
+        const auto floating = std::is_floating_point<T>::value ? static_cast<long double>(number) : static_cast<long double>(integer);
+        return OrderNumbers(lhs.NumberType(), lhs._llivalue, lhs._ldvalue, numberType, integer, floating);
+      }
 
-            case CompareType_MoreThan:
-              return (lhs._llivalue >= 0 && (unsigned long long int)lhs._llivalue > (unsigned long long int)rhs._llivalue);
+      /**
+       * Order 2 numbers, they are compared as the type worked out from both types.
+       * @param const dynamic::Type& lhsType the number type of the lhs value.
+       * @param long long int lhsInteger the lhs value as an integer.
+       * @param long double lhsFloating the lhs value as a floating point.
+       * @param const dynamic::Type& rhsType the number type of the rhs value.
+       * @param long long int rhsInteger the rhs value as an integer.
+       * @param long double rhsFloating the rhs value as a floating point.
+       * @return Ordering how lhs compares to rhs.
+       */
+      static Ordering OrderNumbers(const dynamic::Type& lhsType, long long int lhsInteger, long double lhsFloating, const dynamic::Type& rhsType, long long int rhsInteger, long double rhsFloating)
+      {
+        switch (CalculateType(lhsType, rhsType))
+        {
+        case Boolean_bool:
+        case Character_signed_char:
+        case Character_unsigned_char:
+        case Character_char:
+        case Character_wchar_t:
 
-            default:
-              throw std::runtime_error("Unknown compare type");
-            }
-          }
-          else
-          {
-            switch (compareType)
-            {
-            case CompareType_Equal:
-              return ((unsigned long long int)lhs._llivalue == (unsigned long long int)rhs._llivalue);
+        // short integers are always converted to Integer_Int
+        case Integer_short_int:
+        case Integer_unsigned_short_int:
+          throw std::runtime_error("Logic error, the function CalculateType() should never return those types.");
 
-            case CompareType_LessThan:
-              return ((unsigned long long int)lhs._llivalue < (unsigned long long int)rhs._llivalue);
+        case Integer_int:
+        case Integer_unsigned_int:
+          return OrderIntegers<int, unsigned int>(lhsInteger, rhsInteger, IntegerOrderOf(lhsType, rhsType));
 
-            case CompareType_MoreThan:
-              return ((unsigned long long int)lhs._llivalue > (unsigned long long int)rhs._llivalue);
+        case Integer_long_int:
+        case Integer_unsigned_long_int:
+          return OrderIntegers<long int, unsigned long int>(lhsInteger, rhsInteger, IntegerOrderOf(lhsType, rhsType));
 
-            default:
-              throw std::runtime_error("Unknown compare type");
-            }
-          }
-          break;
+        case Integer_long_long_int:
+        case Integer_unsigned_long_long_int:
+          return OrderIntegers<long long int, unsigned long long int>(lhsInteger, rhsInteger, IntegerOrderOf(lhsType, rhsType));
 
           // Floating point
         case Floating_point_float:
-          switch (compareType)
-          {
-          case CompareType_Equal:
-            return ((float)lhs._ldvalue == (float)rhs._ldvalue);
-
-          case CompareType_LessThan:
-            return ((float)lhs._ldvalue < (float)rhs._ldvalue);
-
-          case CompareType_MoreThan:
-            return ((float)lhs._ldvalue > (float)rhs._ldvalue);
-
-          default:
-            throw std::runtime_error("Unknown compare type");
-          }
-          break;
+          return OrderValues(static_cast<float>(lhsFloating), static_cast<float>(rhsFloating));
 
         case Floating_point_double:
-          switch (compareType)
-          {
-          case CompareType_Equal:
-            return ((double)lhs._ldvalue == (double)rhs._ldvalue);
-
-          case CompareType_LessThan:
-            return ((double)lhs._ldvalue < (double)rhs._ldvalue);
-
-          case CompareType_MoreThan:
-            return ((double)lhs._ldvalue > (double)rhs._ldvalue);
-
-          default:
-            throw std::runtime_error("Unknown compare type");
-          }
-          break;
+          return OrderValues(static_cast<double>(lhsFloating), static_cast<double>(rhsFloating));
 
         case Floating_point_long_double:
-          switch (compareType)
-          {
-          case CompareType_Equal:
-            return (lhs._ldvalue == rhs._ldvalue);
-
-          case CompareType_LessThan:
-            return (lhs._ldvalue < rhs._ldvalue);
-
-          case CompareType_MoreThan:
-            return (lhs._ldvalue > rhs._ldvalue);
-
-          default:
-            throw std::runtime_error("Unknown compare type");
-          }
-          break;
+          return OrderValues(lhsFloating, rhsFloating);
 
         default:
           throw std::bad_cast();
         }
-
-        //  never reached.
-        throw std::runtime_error("Imposible, how did we get this far?");
       }
 
       /**
-      * Calculate if the lhs string is 'smaller' then the rhs
-      * This is the string behaviour.
+      * Order 2 values when at least one of them is a string.
+      * Note that Wide/AscII are not the same, so "Hello" != L"Hello"
       * @param const Any& lhs the lhs value been compared.
       * @param const Any& rhs the rhs value been compared.
-      * @param const CompareType&  the type of comparaison been done.
-      * @return bool if the lhs < rhs
+      * @return Ordering how lhs compares to rhs.
       */
-      static bool CompareString(const Any& lhs, const Any& rhs, const CompareType& compareType)
+      static Ordering OrderStrings(const Any& lhs, const Any& rhs)
       {
-        // the equal compare is slightly different.
-        if (compareType == CompareType_Equal)
-        {
-          return EqualString(lhs, rhs);
-        }
-
-        // if either of them is _not_ a stringand we know the other is a string
+        // if either of them is _not_ a string and we know the other is a string
         // then we have to treat the other as zero, (or maybe valid number)
         // for example 12 < "Hello"
         if (!dynamic::is_type_character(lhs.Type()) || !dynamic::is_type_character(rhs.Type()))
         {
-          return CompareNumber(lhs, rhs, compareType);
+          return OrderNumbers(lhs, rhs);
         }
 
         // if either of them is a number, (even partial), then we have to compare it as a number
-        // and if the other is not a string, then we will compare them both.
         // for example "12 bottles of beer" > "Hello" (12 > 0)
         if (lhs.IsStringNumber( true ) || rhs.IsStringNumber( true ))
         {
-          return CompareNumber(lhs, rhs, compareType);
+          const auto order = OrderNumbers(lhs, rhs);
+
+          // if both of those strings are full numbers then the numbers are all we need, "12.0" == "12"
+          // otherwise they are only the same if the characters are the same, "12 Hello" != "12 Bye"
+          if (Ordering_Less == order || Ordering_Greater == order || (lhs.IsStringNumber(false) && rhs.IsStringNumber(false)))
+          {
+            return order;
+          }
+          return EqualCharacters(lhs, rhs) ? Ordering_Equal : Ordering_Unordered;
         }
 
         //  if we are here, then neither values can be null.
@@ -2066,46 +2554,26 @@ namespace myodd {
         // <0	the first character that does not match has a lower value in str1 than in str2
         //  0	the contents of both strings are equal
         // >0	the first character that does not match has a greater value in str1 than in str2
-        switch (compareType)
+        const auto result = CompareCharacters(lhs, rhs, (lhs._lcvalue <= rhs._lcvalue ? lhs._lcvalue : rhs._lcvalue));
+        if (result != 0)
         {
-        case CompareType_LessThan:
-          return (memcmp(lhs._cvalue, rhs._cvalue, (lhs._lcvalue <= rhs._lcvalue ? lhs._lcvalue : rhs._lcvalue)) < 0);
-
-        case CompareType_MoreThan:
-          return (memcmp(lhs._cvalue, rhs._cvalue, (lhs._lcvalue <= rhs._lcvalue ? lhs._lcvalue : rhs._lcvalue)) > 0);
-
-        default:
-          throw std::runtime_error("Unknown compare type");
+          return result < 0 ? Ordering_Less : Ordering_Greater;
         }
+
+        // the common characters are the same, but one of them is longer.
+        return (lhs._lcvalue == rhs._lcvalue) ? Ordering_Equal : Ordering_Unordered;
       }
       
       /**
-      * Compare two non-number strings.
-      * This function assumes that both values are string and either of them is _not_ a number.
+      * Compare the characters of two strings.
       * Note that Wide/AscII are not the same, so "Hello" != L"Hello"
       * @throw if we are unable to compare, (not same types, not same sizes etc...)
       * @param const Any& lhs the lhs value been compared.
       * @param const Any& rhs the rhs value been compared.
       * @return bool if they are the same or not.
       */
-      static bool EqualString(const Any& lhs, const Any& rhs)
+      static bool EqualCharacters(const Any& lhs, const Any& rhs)
       {
-        // if either of them is _not_ a stringand we know the other is a string
-        // then we have to treat the other as zero, (or maybe valid number)
-        // for example 0 == "Hello"
-        if (!dynamic::is_type_character(lhs.Type()) || !dynamic::is_type_character(rhs.Type()))
-        {
-          return CompareNumber(lhs, rhs, CompareType_Equal );
-        }
-
-        // if both of those strings are full numbers then we could compare them as numbers.
-        // if the other is not a full number, then we will compare them as string.
-        // so "12 Hello" != "12 Bye" but "12.0" == "12"
-        if (lhs.IsStringNumber(false) && rhs.IsStringNumber(false))
-        {
-          return CompareNumber(lhs, rhs, CompareType_Equal);
-        }
-
         //  if we are here, then neither values can be null.
         if (!lhs._cvalue || !rhs._cvalue)
         {
@@ -2121,10 +2589,117 @@ namespace myodd {
           return false;
         }
 
+        // short strings are compared as quickly as the hashes.
+        if (lhs._lcvalue >= 64 && KnownHashesDiffer(lhs, rhs))
+        {
+          return false;
+        }
+
         // the lenght is the same, so we can use the size of lhs
         // it does not matter if they are both wide or not, we are 
         // just comparing that both balues are the same.
-        return (0 == std::memcmp(lhs._cvalue, rhs._cvalue, lhs._lcvalue));
+        return (0 == CompareCharacters(lhs, rhs, lhs._lcvalue));
+      }
+
+      /**
+      * Check if we already know both hashes, (the value was used in a hashed container for example),
+      * and they are not the same, in that case the characters cannot be the same.
+      * The hashes are not worked out here, it would cost more than comparing the characters once.
+      * @param const Any& lhs the lhs value we are comparing.
+      * @param const Any& rhs the rhs value we are comparing.
+      * @return bool if we know that the characters are not the same.
+      */
+      static bool KnownHashesDiffer(const Any& lhs, const Any& rhs)
+      {
+        if (!lhs._cbuffer || !rhs._cbuffer)
+        {
+          return false;
+        }
+        const auto lhsHash = lhs._cbuffer->_hash.load(std::memory_order_relaxed);
+        if (0 == lhsHash)
+        {
+          return false;
+        }
+        const auto rhsHash = rhs._cbuffer->_hash.load(std::memory_order_relaxed);
+        return 0 != rhsHash && lhsHash != rhsHash;
+      }
+
+      /**
+      * Compare the characters of 2 values like memcmp would.
+      * A borrowed value does not hold its terminator, so we use '\0' past the characters it holds.
+      * @param const Any& lhs the lhs value we are comparing.
+      * @param const Any& rhs the rhs value we are comparing.
+      * @param size_t len the number of bytes we are comparing.
+      * @return int <0 if lhs is smaller, 0 if they are the same and >0 if lhs is greater.
+      */
+      static int CompareCharacters(const Any& lhs, const Any& rhs, size_t len)
+      {
+        return CompareBytes(lhs._cvalue, lhs.StoredLength(), rhs._cvalue, rhs.StoredLength(), len);
+      }
+
+      /**
+      * Compare 2 blocks of bytes like memcmp would, using '\0' past the bytes we hold.
+      * @param const char* lhs the lhs bytes.
+      * @param size_t lhsStored the number of bytes we can read from lhs.
+      * @param const char* rhs the rhs bytes.
+      * @param size_t rhsStored the number of bytes we can read from rhs.
+      * @param size_t len the number of bytes we are comparing.
+      * @return int <0 if lhs is smaller, 0 if they are the same and >0 if lhs is greater.
+      */
+      static int CompareBytes(const char* lhs, size_t lhsStored, const char* rhs, size_t rhsStored, size_t len)
+      {
+        const auto lhsLen = std::min(len, lhsStored);
+        const auto rhsLen = std::min(len, rhsStored);
+        const auto common = std::min(lhsLen, rhsLen);
+        const auto result = std::memcmp(lhs, rhs, common);
+        if (0 != result)
+        {
+          return result;
+        }
+
+        for (auto i = common; i < len; ++i)
+        {
+          const auto l = i < lhsLen ? static_cast<unsigned char>(lhs[i]) : 0;
+          const auto r = i < rhsLen ? static_cast<unsigned char>(rhs[i]) : 0;
+          if (l != r)
+          {
+            return l < r ? -1 : 1;
+          }
+        }
+        return 0;
+      }
+
+      /**
+      * Order a value and some characters, as if the characters were borrowed.
+      * When neither of them is a number we only need to compare the characters,
+      * so we do not create a value, (or read the numbers), for the characters.
+      * @param const Any& lhs the value we are comparing.
+      * @param const T* source the characters, they do not need to be null terminated.
+      * @param size_t sourceLen the number of characters.
+      * @return Ordering how lhs compares to the characters.
+      */
+      template<class T>
+      static Ordering OrderCharacters(const Any& lhs, const T* source, size_t sourceLen)
+      {
+        if (nullptr != source
+          && lhs._cvalue
+          && dynamic::is_type_character(lhs.Type())
+          && !lhs.IsStringNumber(true)
+          && StringStatus_Not_A_Number == StringStatusOf(source, sourceLen * sizeof(T)))
+        {
+          // see OrderStrings( ... ), a borrowed value counts its terminator.
+          const auto sourceBytes = sourceLen * sizeof(T);
+          const auto sourceLength = sourceBytes + sizeof(T);
+          const auto result = CompareBytes(lhs._cvalue, lhs.StoredLength(), reinterpret_cast<const char*>(source), sourceBytes, (lhs._lcvalue <= sourceLength ? lhs._lcvalue : sourceLength));
+          if (result != 0)
+          {
+            return result < 0 ? Ordering_Less : Ordering_Greater;
+          }
+          return (lhs._lcvalue == sourceLength) ? Ordering_Equal : Ordering_Unordered;
+        }
+
+        // we need the numbers, so we might as well borrow the characters.
+        return Order(lhs, nullptr == source ? Any(source) : Borrow(source, sourceLen));
       }
 
       /**
@@ -2516,7 +3091,7 @@ namespace myodd {
       */
       void CreateFrom(std::string& value)
       {
-        CreateFromCharacters(value.c_str());
+        CreateFromCharacters(value.c_str(), value.size(), sizeof(char));
       }
 
       /**
@@ -2543,7 +3118,7 @@ namespace myodd {
       */
       void CreateFrom(std::wstring& value)
       {
-        CreateFromCharacters(value.c_str());
+        CreateFromWideCharacters(value.c_str(), value.size() * sizeof(wchar_t), sizeof(wchar_t));
       }
 
       /**
@@ -2570,7 +3145,7 @@ namespace myodd {
       */
       void CreateFrom(const std::string& value)
       {
-        CreateFromCharacters(value.c_str());
+        CreateFromCharacters(value.c_str(), value.size(), sizeof(char));
       }
 
       /**
@@ -2579,9 +3154,31 @@ namespace myodd {
       */
       void CreateFrom(const std::wstring& value)
       {
-        CreateFromCharacters(value.c_str());
+        CreateFromWideCharacters(value.c_str(), value.size() * sizeof(wchar_t), sizeof(wchar_t));
       }
 
+#if MYODD_ANY_CPP17
+      /**
+      * Create from a std::string_view, the characters are copied.
+      * The view does not need to be null terminated.
+      * @param const std::string_view& value the value we are trying to create from.
+      */
+      void CreateFrom(const std::string_view& value)
+      {
+        CreateFromCharacters(value.data() ? value.data() : "", value.size(), sizeof(char));
+      }
+
+      /**
+      * Create from a std::wstring_view, the characters are copied.
+      * The view does not need to be null terminated.
+      * @param const std::wstring_view& value the value we are trying to create from.
+      */
+      void CreateFrom(const std::wstring_view& value)
+      {
+        CreateFromWideCharacters(value.data() ? value.data() : L"", value.size() * sizeof(wchar_t), sizeof(wchar_t));
+      }
+#endif
+
       /**
       * Create a value from a double/float/long double number..
       * @param const T* number the number we are creating from.
@@ -2613,9 +3210,9 @@ namespace myodd {
         // set the type
         _type = dynamic::get_type<T>::value;
 
-        // set the values.
+        // set the values, (the floating point of a large unsigned integer is not negative).
         _llivalue = static_cast<long long int>(number);
-        _ldvalue = static_cast<long double>(_llivalue);
+        _ldvalue = static_cast<long double>(number);
       }
 
       /**
@@ -2734,9 +3331,10 @@ namespace myodd {
        * Create this with a signed/unsigned char*
        * @param const T source the char value we are creating from.
        * @param size_t the lenght we are working with.
+       * @param size_t terminatorLen the size of the terminator we need to add, if the source is not terminated.
        */
       template<class T>
-      std::enable_if_t<std::is_pointer<T>::value> CreateFromCharacters(const T source, size_t sourceLen )
+      std::enable_if_t<std::is_pointer<T>::value> CreateFromCharacters(const T source, size_t sourceLen, size_t terminatorLen = 0)
       {
         // clean the values.
         CleanValues();
@@ -2748,33 +3346,98 @@ namespace myodd {
         // this is because our numbers are not quite the same.
         if (_type == dynamic::Character_wchar_t)
         {
-          CreateFromWideCharacters((wchar_t*)source, sourceLen);
+          CreateFromWideCharacters((wchar_t*)source, sourceLen, terminatorLen);
           return;
         }
         
         if (nullptr != source)
         {
-          // get the number of characters.
-          _lcvalue = sourceLen;
-
           // create the character, we know it is at least one, even for an empty string.
-          _cvalue = new char[_lcvalue];
+          CreateCharacterBuffer(source, sourceLen, terminatorLen);
+
+          if (_lcvalue > 1)
+          {
+            // we parse our own copy as it is always terminated, the source might not be.
+            // it does not matter if this is signed or not signed
+            // we are converting it to an unsigned long long and back to a long long
+            // in reality they both take the same amount of space.
+            _llivalue = static_cast<long long int>(std::strtoull(_cvalue, nullptr, 10));
+
+            // try and get the value as a long double.
+            // this is represented in a slightly different way in memory
+            // hence the reason we cannot just cast our long long to long double.
+            _ldvalue = std::strtold(_cvalue, nullptr);
+          }
+          else
+          {
+            // the size is only one, (for our trailling '\0')
+            // so we know that the value has to be zero.
+            _llivalue = 0;
+            _ldvalue = 0;
+          }
+        }
+        else
+        {
+          // create a default value for the string.
+          const char c = '\0';
+
+          // default values.
+          CreateCharacterBuffer(&c, sizeof( typename std::remove_pointer<T>::type ));
+
+          // default values are 0
+          _llivalue = 0;
+          _ldvalue = 0;
+        }
+
+        // parse the string to set the string flag
+        ParseStringStatus(nullptr == source ? nullptr : _cvalue, _lcvalue);
+      }
+
+      /**
+      * Create a value from a multiple characters..
+      * @param const T* value the character we are creating from.
+      */
+      void CreateFromCharacters(const wchar_t* value)
+      {
+        // get the len of the given pointer, as we have no lenght give
+        // we are usuming that this is a null terminated string.
+        size_t givenLen = value ? ((std::wcslen((const wchar_t*)value) + 1) * sizeof(wchar_t)) : 0;
+
+        // we can now try and create it with the given len.
+        CreateFromWideCharacters(value, givenLen);
+      }
+
+      /**
+      * Create this with a wchar_t*
+      * @param const T* source the char value we are creating from.
+      * @param size_t the lenght we are working with.
+      * @param size_t terminatorLen the size of the terminator we need to add, if the source is not terminated.
+      */
+      void CreateFromWideCharacters(const wchar_t* source, size_t sourceLen, size_t terminatorLen = 0)
+      {
+        // clean the values.
+        CleanValues();
 
-          // memory clear
-          std::memset(_cvalue, '\0', _lcvalue);
-          std::memcpy(_cvalue, source, _lcvalue);
+        // set the type
+        _type = dynamic::get_type<wchar_t>::value;
+
+        if (nullptr != source)
+        {
+          // create the character, we know it is at least one, even for an empty string.
+          CreateCharacterBuffer(source, sourceLen, terminatorLen);
 
           if (_lcvalue > 1)
           {
+            // we parse our own copy as it is always terminated, the source might not be.
             // it does not matter if this is signed or not signed
             // we are converting it to an unsigned long long and back to a long long
             // in reality they both take the same amount of space.
-            _llivalue = static_cast<long long int>(std::strtoull((const char*)source, nullptr, 10));
+            _llivalue = static_cast<long long int>(std::wcstoull(reinterpret_cast<const wchar_t*>(_cvalue), nullptr, 10));
 
             // try and get the value as a long double.
             // this is represented in a slightly different way in memory
             // hence the reason we cannot just cast our long long to long double.
-            _ldvalue = std::strtold((const char*)source, nullptr);
+            _ldvalue = std::wcstold(reinterpret_cast<const wchar_t*>(_cvalue), nullptr);
           }
           else
           {
@@ -2786,99 +3449,578 @@ namespace myodd {
         }
         else
         {
-          // create a default value for the string.
-          const char c = '\0';
-
-          // default values.
-          _lcvalue = sizeof( typename std::remove_pointer<T>::type );
-          _cvalue = new char[_lcvalue];
-          std::memset(_cvalue, 0, _lcvalue);
-          std::memcpy(_cvalue, &c, _lcvalue);
-
-          // default values are 0
-          _llivalue = 0;
-          _ldvalue = 0;
+          // create a default value for the string.
+          const wchar_t wide = L'\0';
+          CreateCharacterBuffer(&wide, sizeof(wchar_t));
+
+          // default values are 0
+          _llivalue = 0;
+          _ldvalue = 0;
+        }
+
+        // parse the string to set the string flag
+        ParseStringStatus(nullptr == source ? nullptr : reinterpret_cast<const wchar_t*>(_cvalue), _lcvalue);
+      }
+
+      /**
+      * Borrow the characters rather than copying them.
+      * @see Borrow( ... )
+      * @param const T* source the characters we are borrowing.
+      * @param size_t sourceLen the number of characters.
+      */
+      template<class T>
+      void BorrowFromCharacters(const T* source, size_t sourceLen)
+      {
+        // clean the values.
+        CleanValues();
+
+        // set the type
+        _type = dynamic::get_type<T>::value;
+
+        // point to the characters, we will never change them.
+        BorrowCharacterBuffer(source, sourceLen * sizeof(T), sizeof(T));
+
+        // most strings are words or plain numbers, we do not need a terminated copy for those.
+        if (ParsePlainNumber(source, sourceLen))
+        {
+          return;
+        }
+
+        // the characters are not terminated, so we parse a terminated copy
+        // on the stack, numbers are short enough to fit in it.
+        T buffer[64];
+        std::basic_string<T> longer;
+        const T* terminated = buffer;
+        if (sourceLen < sizeof(buffer) / sizeof(T))
+        {
+          std::copy(source, source + sourceLen, buffer);
+          buffer[sourceLen] = T(0);
+        }
+        else
+        {
+          longer.assign(source, sourceLen);
+          terminated = longer.c_str();
+        }
+
+        // see CreateFromCharacters( ... ) for the values.
+        _llivalue = static_cast<long long int>(ParseUnsignedInteger(terminated));
+        _ldvalue = ParseFloatingPoint(terminated);
+
+        // parse the string to set the string flag
+        ParseStringStatus(terminated, sourceLen * sizeof(T));
+      }
+
+      /**
+      * Parse an unsigned integer from a null terminated string.
+      * @param const char* / const wchar_t* source the string we are parsing.
+      * @return unsigned long long the number.
+      */
+      static unsigned long long ParseUnsignedInteger(const char* source) { return std::strtoull(source, nullptr, 10); }
+      static unsigned long long ParseUnsignedInteger(const wchar_t* source) { return std::wcstoull(source, nullptr, 10); }
+
+      /**
+      * Parse a floating point number from a null terminated string.
+      * @param const char* / const wchar_t* source the string we are parsing.
+      * @return long double the number.
+      */
+      static long double ParseFloatingPoint(const char* source) { return std::strtold(source, nullptr); }
+      static long double ParseFloatingPoint(const wchar_t* source) { return std::wcstold(source, nullptr); }
+
+      /**
+      * Check if the characters start with a word, whatever the case, ("INF" or "Inf" for example)
+      * @param const char* source the characters, at least as long as the word.
+      * @param const char* word the lower case word.
+      * @return bool if the characters start with the word.
+      */
+      static bool IsPrefix(const char* source, const char* word)
+      {
+        for (; *word; ++source, ++word)
+        {
+          if ((*source | 0x20) != *word)
+          {
+            return false;
+          }
+        }
+        return true;
+      }
+
+      /**
+      * Set the value to a narrow string, the numbers and the string status are worked out in one scan.
+      * If we are the only one using our character buffer, and the characters fit, we write them over
+      * the old ones rather than creating a new buffer, (rows of values are read over and over again).
+      * @param const char* source the characters, they do not need to be terminated.
+      * @param size_t sourceLen the number of characters.
+      */
+      void AssignCharacters(const char* source, size_t sourceLen)
+      {
+        // the buffer was created big enough for those characters, even if shorter ones were written over since.
+        if (_type == dynamic::Character_char
+          && nullptr != _cbuffer
+          && 1 == _cbuffer->_counter.load(std::memory_order_relaxed)
+          && sourceLen <= _cbuffer->_capacity)
+        {
+          // the cosmetic strings are for the old characters.
+          if (nullptr != _svalue.load(std::memory_order_relaxed) || nullptr != _swvalue.load(std::memory_order_relaxed))
+          {
+            delete _svalue.load(std::memory_order_relaxed);
+            delete _swvalue.load(std::memory_order_relaxed);
+            _svalue.store(nullptr, std::memory_order_relaxed);
+            _swvalue.store(nullptr, std::memory_order_relaxed);
+          }
+          _cbuffer->_hash.store(0, std::memory_order_relaxed);
+          _lcvalue = sourceLen + 1;
+          std::memcpy(_cvalue, source, sourceLen);
+          std::memset(_cvalue + sourceLen, '\0', sizeof(wchar_t));
+        }
+        else
+        {
+          CleanValues();
+          _type = dynamic::Character_char;
+          CreateCharacterBuffer(source, sourceLen, 1);
+        }
+
+        if (!ParsePlainNumber(_cvalue, sourceLen))
+        {
+          // see CreateFromCharacters( ... ) for the values.
+          _llivalue = static_cast<long long int>(ParseUnsignedInteger(_cvalue));
+          _ldvalue = ParseFloatingPoint(_cvalue);
+          ParseStringStatus(_cvalue, _lcvalue);
+        }
+      }
+
+      /**
+      * Work out mantissa * 10^exponent, exactly rounded, when both the mantissa and the power of 10
+      * fit in a long double, (Clinger's fast path), a single multiplication or division is exactly rounded.
+      * @param unsigned long long mantissa the digits of the number.
+      * @param int exponent the power of 10.
+      * @param long double& number the number.
+      * @return bool false if the number cannot be worked out exactly this way.
+      */
+      static bool FastPathFloatingPoint(unsigned long long mantissa, int exponent, long double& number)
+      {
+        static constexpr long double powers[] = { 1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L,
+          1e10L, 1e11L, 1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L };
+        static constexpr int mantissaDigits = std::numeric_limits<long double>::digits < 64 ? std::numeric_limits<long double>::digits : 63;
+        if (exponent < -19 || exponent > 19 || mantissa > (1ull << mantissaDigits))
+        {
+          return false;
+        }
+        number = exponent < 0 ? static_cast<long double>(mantissa) / powers[-exponent] : static_cast<long double>(mantissa) * powers[exponent];
+        return true;
+      }
+
+      /**
+      * Work out the numbers and the string status of the strings we see the most in one scan,
+      * plain decimal numbers, ("12", "-3.25", "+.5"), and strings that cannot start a number, ("Hello")
+      * The values are the same as the ones from strtoull, strtold and StringStatusOf( ... )
+      * The floating point is exact as long as both the digits and the power of 10 fit in a long double,
+      * (Clinger's fast path), anything else is left to the 'C' library.
+      * @param const char* source the characters, they do not need to be terminated.
+      * @param size_t sourceLen the number of characters, without the terminator.
+      * @return bool false if the string needs to be parsed the usual way.
+      */
+      bool ParsePlainNumber(const char* source, size_t sourceLen)
+      {
+        if (0 == sourceLen)
+        {
+          _llivalue = 0;
+          _ldvalue = 0;
+          _stringStatus = StringStatus_Not_A_Number;
+          return true;
+        }
+
+        const char* it = source;
+        const char* end = source + sourceLen;
+        const auto first = *it;
+        const bool negative = (first == '-');
+        if (negative || first == '+')
+        {
+          ++it;
+        }
+        else if (!_isdigit(first) && first != '.')
+        {
+          // spaces, inf and nan need the 'C' library, but most words cannot be a number.
+          if (_isspace(first) || (sourceLen >= 3 && (IsPrefix(source, "inf") || IsPrefix(source, "nan"))))
+          {
+            return false;
+          }
+          _llivalue = 0;
+          _ldvalue = 0;
+          _stringStatus = StringStatus_Not_A_Number;
+          return true;
+        }
+
+        // the whole number, we know it cannot overflow with 19 digits or less.
+        const char* digits = it;
+        unsigned long long mantissa = 0;
+        while (it != end && _isdigit(*it))
+        {
+          mantissa = mantissa * 10 + static_cast<unsigned>(*it - '0');
+          ++it;
+        }
+        const auto integer = mantissa;
+        const auto integerDigits = static_cast<size_t>(it - digits);
+
+        // the decimals, if any.
+        size_t decimals = 0;
+        const bool decimal = (it != end && *it == '.');
+        if (decimal)
+        {
+          ++it;
+          const char* start = it;
+          while (it != end && _isdigit(*it))
+          {
+            mantissa = mantissa * 10 + static_cast<unsigned>(*it - '0');
+            ++it;
+          }
+          decimals = static_cast<size_t>(it - start);
+        }
+
+        // anything else, (exponents, spaces, more signs ...), is not a plain number.
+        long double floating = 0;
+        if (it != end
+          || 0 == integerDigits + decimals
+          || integerDigits + decimals > 19
+          || !FastPathFloatingPoint(mantissa, -static_cast<int>(decimals), floating))
+        {
+          return false;
+        }
+
+        // strtoull negates the unsigned number, so does the cast.
+        _llivalue = static_cast<long long int>(negative ? 0ull - integer : integer);
+        _ldvalue = negative ? -floating : floating;
+        if (decimal)
+        {
+          _stringStatus = negative ? StringStatus_Floating_Neg_Number : StringStatus_Floating_Pos_Number;
+        }
+        else
+        {
+          _stringStatus = negative ? StringStatus_Neg_Number : StringStatus_Pos_Number;
+        }
+        return true;
+      }
+
+      /**
+      * Wide strings are always parsed the usual way.
+      * @see ParsePlainNumber(const char*, size_t)
+      * @return bool false, the string needs to be parsed the usual way.
+      */
+      bool ParsePlainNumber(const wchar_t*, size_t)
+      {
+        return false;
+      }
+
+      /**
+      * How the values of a number/string are written, it is in the top bits of the tag.
+      */
+      enum BinaryRepresentation
+      {
+        BinaryRepresentation_Integer = 0,      // the integer, the floating point is worked out from it.
+        BinaryRepresentation_Float = 1,        // the float bits, the integer is worked out from it.
+        BinaryRepresentation_Double = 2,       // the double bits, the integer is worked out from it.
+        BinaryRepresentation_Long_Double = 3,  // the long double, the integer is worked out from it.
+        BinaryRepresentation_Both = 4,         // the integer and the long double.
+
+        BinaryRepresentation_Characters = 0,                // the characters are not a number.
+        BinaryRepresentation_Characters_And_Number = 1      // the characters, the string status and both numbers.
+      };
+
+      // the type is in the low bits of the tag and the representation in the high bits.
+      static constexpr unsigned char BinaryTypeMask = 0x1f;
+      static constexpr unsigned char BinaryRepresentationShift = 5;
+
+      /**
+      * Get the tag we write before the value.
+      * @param int representation how the value is written.
+      * @return char the tag.
+      */
+      char BinaryTag(int representation) const
+      {
+        return static_cast<char>((representation << BinaryRepresentationShift) | (static_cast<int>(_type) & BinaryTypeMask));
+      }
+
+      /**
+      * Work out the smallest way of writing our numbers so they are read back as they are.
+      * Numbers created from an integer have the same floating point, and numbers created from
+      * a floating point have the same integer, but the result of some arithmetic might not.
+      * @return BinaryRepresentation how we will write the numbers.
+      */
+      BinaryRepresentation NumberRepresentation() const
+      {
+        // see CreateFromInteger( ... ), (-0.0 is not created from an integer).
+        const auto integer = IntegerToFloating(Type(), _llivalue);
+        if (_ldvalue == integer && std::signbit(_ldvalue) == std::signbit(integer))
+        {
+          return BinaryRepresentation_Integer;
+        }
+
+        // see CreateFromDouble( ... ), we can only work out the integer if it is in range.
+        if (_ldvalue >= -9223372036854775808.0L && _ldvalue < 9223372036854775808.0L && _llivalue == static_cast<long long int>(_ldvalue))
+        {
+          if (static_cast<long double>(static_cast<float>(_ldvalue)) == _ldvalue)
+          {
+            return BinaryRepresentation_Float;
+          }
+          if (static_cast<long double>(static_cast<double>(_ldvalue)) == _ldvalue)
+          {
+            return BinaryRepresentation_Double;
+          }
+          return BinaryRepresentation_Long_Double;
+        }
+        return BinaryRepresentation_Both;
+      }
+
+      /**
+      * Append our numbers.
+      * @see Serialize( ... )
+      * @param std::string& buffer where we are writing the value.
+      */
+      void SerializeNumber(std::string& buffer) const
+      {
+        const auto representation = NumberRepresentation();
+        buffer += BinaryTag(representation);
+        switch (representation)
+        {
+        case BinaryRepresentation_Integer:
+          _Binary::append_varint(buffer, _Binary::zigzag(_llivalue));
+          break;
+
+        case BinaryRepresentation_Float:
+          _Binary::append_float(buffer, static_cast<float>(_ldvalue));
+          break;
+
+        case BinaryRepresentation_Double:
+          _Binary::append_double(buffer, static_cast<double>(_ldvalue));
+          break;
+
+        case BinaryRepresentation_Long_Double:
+          _Binary::append_floating(buffer, _ldvalue);
+          break;
+
+        case BinaryRepresentation_Both:
+          _Binary::append_varint(buffer, _Binary::zigzag(_llivalue));
+          _Binary::append_floating(buffer, _ldvalue);
+          break;
+        }
+      }
+
+      /**
+      * Read the numbers written with SerializeNumber( ... )
+      * @param dynamic::Type type the type of the value.
+      * @param BinaryRepresentation representation how the numbers were written.
+      * @param const char*& source where we are reading from, moved past the value.
+      * @param const char* end the end of the data.
+      */
+      void DeserializeNumber(dynamic::Type type, BinaryRepresentation representation, const char*& source, const char* end)
+      {
+        switch (representation)
+        {
+        case BinaryRepresentation_Integer:
+          _llivalue = _Binary::unzigzag(_Binary::read_varint(source, end));
+          _ldvalue = IntegerToFloating(type, _llivalue);
+          break;
+
+        case BinaryRepresentation_Float:
+          _ldvalue = _Binary::read_float(source, end);
+          _llivalue = static_cast<long long int>(_ldvalue);
+          break;
+
+        case BinaryRepresentation_Double:
+          _ldvalue = _Binary::read_double(source, end);
+          _llivalue = static_cast<long long int>(_ldvalue);
+          break;
+
+        case BinaryRepresentation_Long_Double:
+          _ldvalue = _Binary::read_floating(source, end);
+          _llivalue = static_cast<long long int>(_ldvalue);
+          break;
+
+        case BinaryRepresentation_Both:
+          _llivalue = _Binary::unzigzag(_Binary::read_varint(source, end));
+          _ldvalue = _Binary::read_floating(source, end);
+          break;
+
+        default:
+          throw std::runtime_error("Unknown binary number.");
+        }
+        _type = type;
+      }
+
+      /**
+      * Append our characters, (and our numbers if we are a number).
+      * Wide characters are written as varints as wchar_t is not the same size everywhere.
+      * @see Serialize( ... )
+      * @param std::string& buffer where we are writing the value.
+      */
+      void SerializeCharacters(std::string& buffer) const
+      {
+        const auto hasNumber = StringStatus_Not_A_Number != _stringStatus || 0 != _llivalue || 0 != _ldvalue || std::signbit(_ldvalue);
+        buffer += BinaryTag(hasNumber ? BinaryRepresentation_Characters_And_Number : BinaryRepresentation_Characters);
+
+        // a borrowed value does not hold its terminator, so we write the '\0' ourselves.
+        const auto stored = StoredLength();
+        if (_type == dynamic::Character_wchar_t)
+        {
+          const auto units = _lcvalue / sizeof(wchar_t);
+          const auto storedUnits = stored / sizeof(wchar_t);
+          const auto characters = reinterpret_cast<const wchar_t*>(_cvalue);
+          _Binary::append_varint(buffer, units);
+          for (size_t i = 0; i < units; ++i)
+          {
+            _Binary::append_varint(buffer, i < storedUnits ? static_cast<std::make_unsigned<wchar_t>::type>(characters[i]) : 0);
+          }
+        }
+        else
+        {
+          _Binary::append_varint(buffer, _lcvalue);
+          buffer.append(_cvalue, stored);
+          buffer.append(_lcvalue - stored, '\0');
+        }
+
+        if (hasNumber)
+        {
+          buffer += static_cast<char>(_stringStatus);
+          _Binary::append_varint(buffer, _Binary::zigzag(_llivalue));
+          _Binary::append_floating(buffer, _ldvalue);
+        }
+      }
+
+      /**
+      * Read the characters written with SerializeCharacters( ... )
+      * @param dynamic::Type type the type of the value.
+      * @param BinaryRepresentation representation how the value was written.
+      * @param const char*& source where we are reading from, moved past the value.
+      * @param const char* end the end of the data.
+      * @param bool borrow if we borrow the characters from the data rather than copy them.
+      */
+      void DeserializeCharacters(dynamic::Type type, BinaryRepresentation representation, const char*& source, const char* end, bool borrow)
+      {
+        if (BinaryRepresentation_Characters != representation && BinaryRepresentation_Characters_And_Number != representation)
+        {
+          throw std::runtime_error("Unknown binary characters.");
+        }
+
+        // each character is at least one byte, so we can check the length before we allocate anything.
+        const auto units = _Binary::read_varint(source, end);
+        if (units > static_cast<unsigned long long>(end - source))
+        {
+          throw _Binary::truncated_error();
+        }
+
+        if (type == dynamic::Character_wchar_t)
+        {
+          std::wstring characters(static_cast<size_t>(units), L'\0');
+          for (auto& character : characters)
+          {
+            const auto unit = _Binary::read_varint(source, end);
+            if (unit > static_cast<std::make_unsigned<wchar_t>::type>(std::numeric_limits<wchar_t>::max()))
+            {
+              throw std::range_error("The wide character is too big for this platform.");
+            }
+            character = static_cast<wchar_t>(unit);
+          }
+          CreateCharacterBuffer(characters.data(), characters.size() * sizeof(wchar_t));
+        }
+        else if (borrow && units > 0 && '\0' == source[units - 1])
+        {
+          // a borrowed value does not hold its terminator, (single characters do not have one).
+          BorrowCharacterBuffer(source, static_cast<size_t>(units) - 1, 1);
+          source += units;
+        }
+        else
+        {
+          CreateCharacterBuffer(source, static_cast<size_t>(units));
+          source += units;
         }
+        _type = type;
 
-        // parse the string to set the string flag
-        ParseStringStatus((const char*)source, sourceLen );
+        if (BinaryRepresentation_Characters_And_Number == representation)
+        {
+          const auto status = _Binary::read_byte(source, end);
+          if (status > static_cast<int>(StringStatus_Floating_Neg_Number))
+          {
+            throw std::runtime_error("Unknown binary string status.");
+          }
+          _stringStatus = static_cast<StringStatus>(status);
+          _llivalue = _Binary::unzigzag(_Binary::read_varint(source, end));
+          _ldvalue = _Binary::read_floating(source, end);
+        }
       }
 
       /**
-      * Create a value from a multiple characters..
-      * @param const T* value the character we are creating from.
+      * Move past the numbers written with SerializeNumber( ... )
+      * @param BinaryRepresentation representation how the numbers were written.
+      * @param const char*& source where we are reading from, moved past the value.
+      * @param const char* end the end of the data.
       */
-      void CreateFromCharacters(const wchar_t* value)
+      static void SkipNumber(BinaryRepresentation representation, const char*& source, const char* end)
       {
-        // get the len of the given pointer, as we have no lenght give
-        // we are usuming that this is a null terminated string.
-        size_t givenLen = value ? ((std::wcslen((const wchar_t*)value) + 1) * sizeof(wchar_t)) : 0;
+        switch (representation)
+        {
+        case BinaryRepresentation_Integer:
+          _Binary::read_varint(source, end);
+          break;
 
-        // we can now try and create it with the given len.
-        CreateFromWideCharacters(value, givenLen);
+        case BinaryRepresentation_Float:
+          _Binary::skip(source, end, sizeof(float));
+          break;
+
+        case BinaryRepresentation_Double:
+          _Binary::skip(source, end, sizeof(double));
+          break;
+
+        case BinaryRepresentation_Long_Double:
+          _Binary::skip_floating(source, end);
+          break;
+
+        case BinaryRepresentation_Both:
+          _Binary::read_varint(source, end);
+          _Binary::skip_floating(source, end);
+          break;
+
+        default:
+          throw std::runtime_error("Unknown binary number.");
+        }
       }
 
       /**
-      * Create this with a wchar_t*
-      * @param const T* source the char value we are creating from.
-      * @param size_t the lenght we are working with.
+      * Move past the characters written with SerializeCharacters( ... )
+      * @param dynamic::Type type the type of the value.
+      * @param BinaryRepresentation representation how the value was written.
+      * @param const char*& source where we are reading from, moved past the value.
+      * @param const char* end the end of the data.
       */
-      void CreateFromWideCharacters(const wchar_t* source, size_t sourceLen)
+      static void SkipCharacters(dynamic::Type type, BinaryRepresentation representation, const char*& source, const char* end)
       {
-        // clean the values.
-        CleanValues();
-
-        // set the type
-        _type = dynamic::get_type<wchar_t>::value;
-
-        if (nullptr != source)
+        if (BinaryRepresentation_Characters != representation && BinaryRepresentation_Characters_And_Number != representation)
         {
-          // default values.
-          _lcvalue = sourceLen;
-
-          // create the character, we know it is at least one, even for an empty string.
-          _cvalue = new char[_lcvalue];
-
-          // memory clear
-          std::memset(_cvalue, '\0', _lcvalue);
-          std::memcpy(_cvalue, source, _lcvalue);
+          throw std::runtime_error("Unknown binary characters.");
+        }
 
-          if (_lcvalue > 1)
-          {
-            // it does not matter if this is signed or not signed
-            // we are converting it to an unsigned long long and back to a long long
-            // in reality they both take the same amount of space.
-            _llivalue = static_cast<long long int>(std::wcstoull((const wchar_t*)source, nullptr, 10));
+        const auto units = _Binary::read_varint(source, end);
+        if (units > static_cast<unsigned long long>(end - source))
+        {
+          throw _Binary::truncated_error();
+        }
 
-            // try and get the value as a long double.
-            // this is represented in a slightly different way in memory
-            // hence the reason we cannot just cast our long long to long double.
-            _ldvalue = std::wcstold((const wchar_t*)source, nullptr);
-          }
-          else
+        if (type == dynamic::Character_wchar_t)
+        {
+          for (unsigned long long i = 0; i < units; ++i)
           {
-            // the size is only one, (for our trailling '\0')
-            // so we know that the value has to be zero.
-            _llivalue = 0;
-            _ldvalue = 0;
+            _Binary::read_varint(source, end);
           }
         }
         else
         {
-          // create a default value for the string.
-          const wchar_t wide = L'\0';
-          _lcvalue = sizeof(wchar_t);
-          _cvalue = new char[_lcvalue];
-          std::memset(_cvalue, 0, _lcvalue);
-          std::memcpy(_cvalue, &wide, _lcvalue);
-
-          // default values are 0
-          _llivalue = 0;
-          _ldvalue = 0;
+          source += units;
         }
 
-        // parse the string to set the string flag
-        ParseStringStatus((const wchar_t*)source, sourceLen);
+        if (BinaryRepresentation_Characters_And_Number == representation)
+        {
+          _Binary::read_byte(source, end);
+          _Binary::read_varint(source, end);
+          _Binary::skip_floating(source, end);
+        }
       }
 
       /**
@@ -2895,10 +4037,7 @@ namespace myodd {
         _type = dynamic::get_type<T>::value;
 
         // create the character.
-        _lcvalue = sizeof(T);
-        _cvalue = new char[_lcvalue];
-        std::memset(_cvalue, '\0', _lcvalue);
-        std::memcpy(_cvalue, &value, _lcvalue);
+        CreateCharacterBuffer(&value, sizeof(T));
 
         if (value >= '0' && value <= '9')
         {
@@ -2932,10 +4071,7 @@ namespace myodd {
         _type = dynamic::get_type<wchar_t>::value;
 
         // create the character.
-        _lcvalue = sizeof(wchar_t);
-        _cvalue = new char[_lcvalue];
-        std::memset(_cvalue, '\0', _lcvalue);
-        std::memcpy(_cvalue, &value, _lcvalue);
+        CreateCharacterBuffer(&value, sizeof(wchar_t));
 
         // copy it.
         if (value >= L'0' && value <= L'9')
@@ -3365,13 +4501,15 @@ namespace myodd {
         if (Type() == dynamic::Misc_copy)
         {
           //  as we are not a pointer, we cannot use the pointer value.
-          auto unknownItem = reinterpret_cast<UnknownItem<typename std::remove_pointer<T>::type>*>(_unkvalue);
+          //  the copy was created without const, (a const T* is the same item).
+          typedef typename std::remove_const<typename std::remove_pointer<T>::type>::type item_type;
 
-          // did the cast work?
-          if (nullptr == unknownItem)
+          // is it a copy of that type?
+          if (!IsCopyOf<item_type>())
           {
             throw std::bad_cast();
           }
+          auto unknownItem = static_cast<UnknownItem<item_type>*>(_unkvalue);
 
           // we want the address of what we know is a structure.
           return unknownItem->Get();
@@ -3417,13 +4555,14 @@ namespace myodd {
         if (Type() == dynamic::Misc_copy)
         {
           //  as we are not a pointer, we cannot use the pointer value.
-          auto unknownItem = reinterpret_cast<UnknownItem<typename std::remove_pointer<T>::type>*>(_unkvalue);
+          typedef typename std::remove_pointer<T>::type item_type;
 
-          // did the cast work?
-          if (nullptr == unknownItem)
+          // is it a copy of that type?
+          if (!IsCopyOf<item_type>())
           {
             throw std::bad_cast();
           }
+          auto unknownItem = static_cast<UnknownItem<item_type>*>(_unkvalue);
 
           // we want the address of what we know is a structure.
           return *unknownItem->Get();
@@ -3517,26 +4656,24 @@ namespace myodd {
 
         case dynamic::Misc_null:
         case dynamic::Character_wchar_t:
-          if (nullptr == _svalue)
-          {
-            const_cast<Any*>(this)->CreateString();
-          }
-          value = (T)_svalue->c_str();
+          value = (T)CachedString().c_str();
           break;
 
         case dynamic::Character_char:
         case dynamic::Character_signed_char:
         case dynamic::Character_unsigned_char:
+          if (IsBorrowed())
+          {
+            // the borrowed characters are not terminated, so we use the cached copy.
+            value = (T)CachedString().c_str();
+            break;
+          }
           value = static_cast<char*>(_cvalue);
           break;
 
         default:
           // do we need to create the string representation?
-          if (nullptr == _svalue)
-          {
-            const_cast<Any*>(this)->CreateString();
-          }
-          value = (T)_svalue->c_str();
+          value = (T)CachedString().c_str();
           break;
         }
       }
@@ -3563,6 +4700,78 @@ namespace myodd {
         value = std::string(c);
       }
 
+#if MYODD_ANY_CPP17
+      /**
+      * Return a view of our characters, or of the cached string representation.
+      * @param std::string_view& value the view we are returning.
+      */
+      void CastToCharacters(std::string_view& value) const
+      {
+        switch (Type())
+        {
+        case dynamic::Misc_copy:
+        case dynamic::Misc_copy_ptr:
+          throw std::bad_cast();
+
+        case dynamic::Character_char:
+        case dynamic::Character_signed_char:
+        case dynamic::Character_unsigned_char:
+          value = std::string_view(_cvalue, CharactersLength<char>());
+          break;
+
+        default:
+          // do we need to create the string representation?
+          value = std::string_view(CachedString());
+          break;
+        }
+      }
+
+      /**
+      * Return a view of our wide characters, or of the cached wide string representation.
+      * @param std::wstring_view& value the view we are returning.
+      */
+      void CastToCharacters(std::wstring_view& value) const
+      {
+        switch (Type())
+        {
+        case dynamic::Misc_copy:
+        case dynamic::Misc_copy_ptr:
+          throw std::bad_cast();
+
+        case dynamic::Character_wchar_t:
+          value = std::wstring_view(reinterpret_cast<const wchar_t*>(_cvalue), CharactersLength<wchar_t>());
+          break;
+
+        default:
+          // do we need to create the string representation?
+          value = std::wstring_view(CachedWideString());
+          break;
+        }
+      }
+#endif
+
+      /**
+      * Get the number of characters we are holding, without the trailing '\0', if we have one.
+      * A single character does not have a terminator, a string does.
+      * @return size_t the number of T characters.
+      */
+      template<class T>
+      size_t CharactersLength() const
+      {
+        if (IsBorrowed())
+        {
+          // we only have the characters, there is no terminator.
+          return StoredLength() / sizeof(T);
+        }
+
+        auto len = _lcvalue / sizeof(T);
+        if (len > 0 && reinterpret_cast<const T*>(_cvalue)[len - 1] == T(0))
+        {
+          --len;
+        }
+        return len;
+      }
+
       /**
       * Return a character
       * @return T* the character we want to return no.
@@ -3576,6 +4785,12 @@ namespace myodd {
           throw std::bad_cast();
 
         case dynamic::Character_wchar_t:
+          if (IsBorrowed())
+          {
+            // the borrowed characters are not terminated, so we use the cached copy.
+            value = const_cast<wchar_t*>(CachedWideString().c_str());
+            break;
+          }
           value = static_cast<wchar_t*>((void*)_cvalue);
           break;
 
@@ -3583,20 +4798,12 @@ namespace myodd {
         case dynamic::Character_char:
         case dynamic::Character_signed_char:
         case dynamic::Character_unsigned_char:
-          if (nullptr == _swvalue)
-          {
-            const_cast<Any*>(this)->CreateWideString();
-          }
-          value = const_cast<wchar_t*>(_swvalue->c_str());
+          value = const_cast<wchar_t*>(CachedWideString().c_str());
           break;
 
         default:
           // do we need to create the string representation?
-          if (nullptr == _swvalue)
-          {
-            const_cast<Any*>(this)->CreateWideString();
-          }
-          value = const_cast<wchar_t*>(_swvalue->c_str());
+          value = const_cast<wchar_t*>(CachedWideString().c_str());
           break;
         }
       }
@@ -3616,48 +4823,224 @@ namespace myodd {
 # pragma endregion  CastTo - Cast *this to T&
 #endif
 
+      /**
+      * Get the cosmetic representation of the string, create it the first time.
+      * The string is created outside of the cache and then published atomically
+      * so concurrent const reads are safe, if 2 threads create it at the same time
+      * only one of the strings is kept.
+      * @return const std::string& the cached string.
+      */
+      const std::string& CachedString() const
+      {
+        const auto* value = _svalue.load(std::memory_order_acquire);
+        return nullptr != value ? *value : PublishCachedString();
+      }
+
+      /**
+      * Create the cached string and publish it, this is kept out of CachedString()
+      * so the common case, where the string already exists, stays small.
+      * @return const std::string& the cached string, (ours or the one another thread published first).
+      */
+      const std::string& PublishCachedString() const
+      {
+        std::unique_ptr<std::string> created(new std::string());
+        CreateString(*created);
+        std::string* expected = nullptr;
+        if (_svalue.compare_exchange_strong(expected, created.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+          return *created.release();
+        }
+        return *expected;
+      }
+
+      /**
+      * Get the cosmetic representation of the wide string, create it the first time.
+      * @see CachedString()
+      * @return const std::wstring& the cached string.
+      */
+      const std::wstring& CachedWideString() const
+      {
+        const auto* value = _swvalue.load(std::memory_order_acquire);
+        return nullptr != value ? *value : PublishCachedWideString();
+      }
+
+      /**
+      * Create the cached wide string and publish it, this is kept out of CachedWideString()
+      * so the common case, where the string already exists, stays small.
+      * @return const std::wstring& the cached string, (ours or the one another thread published first).
+      */
+      const std::wstring& PublishCachedWideString() const
+      {
+        std::unique_ptr<std::wstring> created(new std::wstring());
+        CreateWideString(*created);
+        std::wstring* expected = nullptr;
+        if (_swvalue.compare_exchange_strong(expected, created.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+          return *created.release();
+        }
+        return *expected;
+      }
+
       /**
       * Create the cosmetic representation of the string.
+      * @param std::wstring& value the string we are creating.
       */
-      void CreateWideString()
+      void CreateWideString(std::wstring& value) const
       {
-        //  do we need to do anyting?
-        if (nullptr != _swvalue)
+        // are we a char?
+        switch (Type())
+        {
+        case dynamic::Misc_null:
+          value = L"";
+          return;
+
+        case dynamic::Character_char:
+        case dynamic::Character_unsigned_char:
+        case dynamic::Character_signed_char:
         {
+          if (nullptr == _cvalue)
+          {
+            value = L"";
+            return;
+          }
+
+          // stop at the first '\0' like the c-string would.
+          const auto* end = std::find(_cvalue, _cvalue + StoredLength(), '\0');
+          dynamic::utf8_to_wide(_cvalue, end - _cvalue, value);
+          return;
+        }
+
+        case dynamic::Character_wchar_t:
+          // only needed for borrowed characters, they are not terminated.
+          value.assign(reinterpret_cast<const wchar_t*>(_cvalue), CharactersLength<wchar_t>());
           return;
+
+        case dynamic::Misc_unknown:
+        case dynamic::Misc_copy:
+        case dynamic::Misc_copy_ptr:
+        case dynamic::Boolean_bool:
+        case dynamic::Integer_short_int:
+        case dynamic::Integer_unsigned_short_int:
+        case dynamic::Integer_int:
+        case dynamic::Integer_unsigned_int:
+        case dynamic::Integer_long_int:
+        case dynamic::Integer_unsigned_long_int:
+        case dynamic::Integer_long_long_int:
+        case dynamic::Integer_unsigned_long_long_int:
+        case dynamic::Floating_point_float:
+        case dynamic::Floating_point_double:
+        case dynamic::Floating_point_long_double:
+          break;
+
+        default:
+          // unknown
+          throw std::runtime_error("Unknown data Type");
         }
 
-        // create the new string
-        _swvalue = new std::wstring();
+        // format the number and widen it, the number characters are all ascii.
+        char buffer[dynamic::format_buffer_size];
+        value.assign(buffer, FormatNumber(buffer));
+      }
 
+      /**
+      * Create the cosmetic representation of the string.
+      * @param std::string& value the string we are creating.
+      */
+      void CreateString(std::string& value) const
+      {
         // are we a char?
         switch (Type())
         {
         case dynamic::Misc_null:
-          *_swvalue = L"";
+          value = "";
           return;
 
+        case dynamic::Character_wchar_t:
+        {
+          if (nullptr == _cvalue)
+          {
+            value = "";
+            return;
+          }
+
+          // stop at the first '\0' like the c-string would.
+          const auto* begin = reinterpret_cast<const wchar_t*>(_cvalue);
+          const auto* end = std::find(begin, begin + (StoredLength() / sizeof(wchar_t)), L'\0');
+          dynamic::wide_to_utf8(begin, end - begin, value);
+          return;
+        }
+
         case dynamic::Character_char:
         case dynamic::Character_unsigned_char:
         case dynamic::Character_signed_char:
+          // only needed for borrowed characters, they are not terminated.
+          value.assign(_cvalue, CharactersLength<char>());
+          return;
+
+        case dynamic::Misc_unknown:
+        case dynamic::Misc_copy:
+        case dynamic::Misc_copy_ptr:
+        case dynamic::Boolean_bool:
+        
+        case dynamic::Integer_short_int:
+        case dynamic::Integer_unsigned_short_int:
+        case dynamic::Integer_int:
+        case dynamic::Integer_unsigned_int:
+        case dynamic::Integer_long_int:
+        case dynamic::Integer_unsigned_long_int:
+        case dynamic::Integer_long_long_int:
+        case dynamic::Integer_unsigned_long_long_int:
+        case dynamic::Floating_point_float:
+        case dynamic::Floating_point_double:
+        case dynamic::Floating_point_long_double:
+          break;
+
+        default:
+          // unknown
+          throw std::runtime_error("Unknown data Type");
+        }
+
+        // format the number straight into the string.
+        char buffer[dynamic::format_buffer_size];
+        value.assign(buffer, FormatNumber(buffer));
+      }
+
+      /**
+      * Write the cosmetic representation of the value to a stream without creating the cached strings.
+      * @see CreateString( ... )
+      * @param std::ostream& stream the stream we are writing to.
+      */
+      void WriteToStream(std::ostream& stream) const
+      {
+        switch (Type())
         {
-          if (nullptr == _cvalue)
+        case dynamic::Misc_null:
+          WriteToStream(stream, "", 0);
+          return;
+
+        case dynamic::Character_char:
+        case dynamic::Character_unsigned_char:
+        case dynamic::Character_signed_char:
           {
-            *_swvalue = L"";
-            return;
+            if (nullptr == _cvalue)
+            {
+              WriteToStream(stream, "", 0);
+              return;
+            }
+
+            // stop at the first '\0' like the c-string would.
+            const auto length = CharactersLength<char>();
+            const auto* end = std::find(_cvalue, _cvalue + length, '\0');
+            WriteToStream(stream, _cvalue, end - _cvalue);
           }
+          return;
 
-          using convert_typeX = std::codecvt_utf8<wchar_t>;
-          std::wstring_convert<convert_typeX, wchar_t> converterX;
-          *_swvalue = converterX.from_bytes((const char*)_cvalue);
+        case dynamic::Character_wchar_t:
+          WriteWideToStream(stream);
           return;
-        }
 
         case dynamic::Misc_unknown:
-        case dynamic::Misc_copy:
-        case dynamic::Misc_copy_ptr:
         case dynamic::Boolean_bool:
-        case dynamic::Character_wchar_t:
         case dynamic::Integer_short_int:
         case dynamic::Integer_unsigned_short_int:
         case dynamic::Integer_int:
@@ -3676,120 +5059,364 @@ namespace myodd {
           throw std::runtime_error("Unknown data Type");
         }
 
-        if (dynamic::is_type_floating(NumberType()))
+        // format the number on the stack.
+        char buffer[dynamic::format_buffer_size];
+        WriteToStream(stream, buffer, FormatNumber(buffer) - buffer);
+      }
+
+      /**
+      * Write the wide characters to a stream as utf-8, a block at a time on the stack.
+      * The whole string is converted first so a bad character does not leave half of it written.
+      * @param std::ostream& stream the stream we are writing to.
+      */
+      void WriteWideToStream(std::ostream& stream) const
+      {
+        if (nullptr == _cvalue)
         {
-          *_swvalue = std::to_wstring(_ldvalue);
+          WriteToStream(stream, "", 0);
+          return;
         }
-        else
+
+        // stop at the first '\0' like the c-string would.
+        const auto* begin = reinterpret_cast<const wchar_t*>(_cvalue);
+        const auto* end = std::find(begin, begin + CharactersLength<wchar_t>(), L'\0');
+
+        // most strings fit in one block.
+        char buffer[WideBlockSize * 4];
+        if (static_cast<size_t>(end - begin) <= WideBlockSize)
         {
-          *_swvalue = std::to_wstring(_llivalue);
+          WriteToStream(stream, buffer, dynamic::wide_to_utf8(begin, end - begin, buffer) - buffer);
+          return;
         }
+
+        // convert the blocks once to check the characters and get the size for the padding, then again to write them.
+        std::streamsize length = 0;
+        ForEachUtf8Block(begin, end, buffer, [&](std::streamsize written)
+        {
+          length += written;
+          return true;
+        });
+        WritePaddedToStream(stream, length, [&](std::streambuf& output)
+        {
+          return ForEachUtf8Block(begin, end, buffer, [&](std::streamsize written)
+          {
+            return output.sputn(buffer, written) == written;
+          });
+        });
       }
 
+      // how many wide characters we convert to utf-8 at a time when writing to a stream.
+      static constexpr size_t WideBlockSize = 64;
+
       /**
-      * Create the cosmetic representation of the string.
+      * Convert wide characters to utf-8 a block at a time.
+      * @param const wchar_t* begin the first wide character.
+      * @param const wchar_t* end past the last wide character.
+      * @param char* buffer where each block is converted, at least WideBlockSize * 4 characters.
+      * @param const F& block given the number of characters of each block, returns false to stop.
+      * @return bool false if one of the blocks stopped us.
       */
-      void CreateString()
+      template<class F>
+      static bool ForEachUtf8Block(const wchar_t* begin, const wchar_t* end, char* buffer, const F& block)
       {
-        //  do we need to do anyting?
-        if (nullptr != _svalue)
+        for (const auto* it = begin; it < end;)
         {
-          return;
+          // do not split a surrogate pair between 2 blocks.
+          auto* blockEnd = static_cast<size_t>(end - it) > WideBlockSize ? it + WideBlockSize : end;
+          if (dynamic::_Utf8::wide_is_utf16 && blockEnd < end && static_cast<unsigned long>(blockEnd[-1]) >= 0xD800 && static_cast<unsigned long>(blockEnd[-1]) <= 0xDBFF)
+          {
+            --blockEnd;
+          }
+          if (!block(dynamic::wide_to_utf8(it, blockEnd - it, buffer) - buffer))
+          {
+            return false;
+          }
+          it = blockEnd;
         }
+        return true;
+      }
 
-        //  we will need a new string
-        _svalue = new std::string();
-
-        // are we a char?
-        switch (Type())
+      /**
+      * Write characters to a stream, padded to the width of the stream.
+      * @param std::ostream& stream the stream we are writing to.
+      * @param const char* characters the characters.
+      * @param std::streamsize length the number of characters.
+      */
+      static void WriteToStream(std::ostream& stream, const char* characters, std::streamsize length)
+      {
+        WritePaddedToStream(stream, length, [&](std::streambuf& output)
         {
-        case dynamic::Misc_null:
-          *_svalue = "";
-          return;
+          return output.sputn(characters, length) == length;
+        });
+      }
 
-        case dynamic::Character_wchar_t:
+      /**
+      * Write characters to a stream, padded to the width of the stream, the way the stream writes a c-string.
+      * @param std::ostream& stream the stream we are writing to.
+      * @param std::streamsize length the number of characters we will write.
+      * @param const W& write writes the characters to the stream buffer, returns false if it could not.
+      */
+      template<class W>
+      static void WritePaddedToStream(std::ostream& stream, std::streamsize length, const W& write)
+      {
+        const std::ostream::sentry sentry(stream);
+        if (sentry)
         {
-          if (nullptr == _cvalue)
+          auto& output = *stream.rdbuf();
+          const auto padding = stream.width() > length ? stream.width() - length : 0;
+          const auto left = (stream.flags() & std::ios_base::adjustfield) == std::ios_base::left;
+          auto good = left || Pad(output, stream.fill(), padding);
+          good = good && write(output);
+          good = good && (!left || Pad(output, stream.fill(), padding));
+          if (!good)
           {
-            *_svalue = "";
-            return;
+            stream.setstate(std::ios_base::badbit);
           }
+        }
+        stream.width(0);
+      }
 
-          using convert_typeX = std::codecvt_utf8<wchar_t>;
-          std::wstring_convert<convert_typeX, wchar_t> converterX;
-          *_svalue = converterX.to_bytes((const wchar_t*)_cvalue);
-          return;
+      /**
+      * Pad a stream buffer.
+      * @param std::streambuf& output where we are writing.
+      * @param char fill the padding character.
+      * @param std::streamsize padding the number of characters.
+      * @return bool false if we could not write them all.
+      */
+      static bool Pad(std::streambuf& output, char fill, std::streamsize padding)
+      {
+        for (; padding > 0; --padding)
+        {
+          if (std::char_traits<char>::eq_int_type(output.sputc(fill), std::char_traits<char>::eof()))
+          {
+            return false;
+          }
         }
+        return true;
+      }
 
-        case dynamic::Character_char:
-        case dynamic::Character_unsigned_char:
-        case dynamic::Character_signed_char:
+      /**
+      * Format the number value of *this, (but not the string value).
+      * Floating points use the shortest representation that reads back to the same value.
+      * @param char* buffer where we are writing the number, at least format_buffer_size characters.
+      * @return char* past the last character written.
+      */
+      char* FormatNumber(char* buffer) const
+      {
+        switch (NumberType())
+        {
+        case dynamic::Floating_point_float:
+          return dynamic::format_floating(buffer, static_cast<float>(_ldvalue));
+
+        case dynamic::Floating_point_double:
+          return dynamic::format_floating(buffer, static_cast<double>(_ldvalue));
+
+        case dynamic::Floating_point_long_double:
+          return dynamic::format_floating(buffer, _ldvalue);
 
-        case dynamic::Misc_unknown:
-        case dynamic::Misc_copy:
-        case dynamic::Misc_copy_ptr:
-        case dynamic::Boolean_bool:
-        
-        case dynamic::Integer_short_int:
         case dynamic::Integer_unsigned_short_int:
-        case dynamic::Integer_int:
         case dynamic::Integer_unsigned_int:
-        case dynamic::Integer_long_int:
         case dynamic::Integer_unsigned_long_int:
-        case dynamic::Integer_long_long_int:
         case dynamic::Integer_unsigned_long_long_int:
-        case dynamic::Floating_point_float:
-        case dynamic::Floating_point_double:
-        case dynamic::Floating_point_long_double:
-          break;
+          return dynamic::format_unsigned(buffer, static_cast<unsigned long long int>(_llivalue));
 
         default:
-          // unknown
-          throw std::runtime_error("Unknown data Type");
+          return dynamic::format_integer(buffer, _llivalue);
         }
+      }
 
-        if (dynamic::is_type_floating(NumberType()))
-        {
-          *_svalue = std::to_string(_ldvalue);
-        }
-        else
+      /**
+      * Clean up the value(s)
+      */
+      void CleanValues()
+      {
+        // most values, (numbers for example), do not own anything
+        // so we only release what we own if we have to.
+        if (nullptr != _cbuffer
+          || nullptr != _unkvalue
+          || nullptr != _svalue.load(std::memory_order_relaxed)
+          || nullptr != _swvalue.load(std::memory_order_relaxed))
         {
-          *_svalue = std::to_string(_llivalue);
+          ReleaseValues();
         }
+
+        // reset the values
+        _cvalue = nullptr;
+        _lcvalue = 0;
+        _llivalue = 0;
+        _ldvalue = 0;
       }
 
       /**
-      * Clean up the value(s)
+      * Release the characters, the cosmetic strings and the unknown value we own.
+      * @see CleanValues()
       */
-      void CleanValues()
+      void ReleaseValues()
       {
-        // delete the char if need be
-        delete _cvalue;
+        // release our reference to the characters.
+        ReleaseCharacterBuffer();
 
         // delete the cosmetic strings
-        delete _svalue;
-        delete _swvalue;
+        delete _svalue.load(std::memory_order_relaxed);
+        delete _swvalue.load(std::memory_order_relaxed);
 
         // delete the unknown value
         if (_unkvalue)
         {
-          --_unkvalue->_counter;
-          if (0 == _unkvalue->_counter)
+          if (0 == --_unkvalue->_counter)
           {
             delete _unkvalue;
           }
         }
 
         // reset the values
-        _llivalue = 0;
-        _ldvalue = 0;
-        _lcvalue = 0;
-        _cvalue = nullptr;
-        _svalue = nullptr;
-        _swvalue = nullptr;
+        _svalue.store(nullptr, std::memory_order_relaxed);
+        _swvalue.store(nullptr, std::memory_order_relaxed);
         _unkvalue = nullptr;
       }
 
+      /**
+      * Create a new shared character buffer and copy the given bytes to it.
+      * The bytes are always followed by a wide null terminator so the value
+      * can be returned as a string even if the source was not terminated.
+      * @param const void* source the bytes we are copying.
+      * @param size_t sourceLen the number of bytes we are copying.
+      * @param size_t terminatorLen the size of the terminator to count as part of the value, if the source did not have one.
+      */
+      void CreateCharacterBuffer(const void* source, size_t sourceLen, size_t terminatorLen = 0)
+      {
+        // the header, the characters and the terminator in one allocation.
+        void* memory = ::operator new(sizeof(CharacterBuffer) + sourceLen + sizeof(wchar_t));
+        _cbuffer = new (memory) CharacterBuffer(sourceLen);
+
+        // the characters are right after the header.
+        _lcvalue = sourceLen + terminatorLen;
+        _cvalue = reinterpret_cast<char*>(_cbuffer + 1);
+        std::memcpy(_cvalue, source, sourceLen);
+        std::memset(_cvalue + sourceLen, '\0', sizeof(wchar_t));
+      }
+
+      /**
+      * Release our reference to the shared character buffer
+      * The buffer is deleted once nobody else is using it.
+      */
+      void ReleaseCharacterBuffer()
+      {
+        if (_cbuffer)
+        {
+          if (0 == --_cbuffer->_counter)
+          {
+            _cbuffer->~CharacterBuffer();
+            ::operator delete(_cbuffer);
+          }
+        }
+
+        // reset the values
+        _cbuffer = nullptr;
+        _cvalue = nullptr;
+        _lcvalue = 0;
+      }
+
+      /**
+      * Borrow the given bytes rather than copying them to a new buffer.
+      * Our length includes a terminator that we do not actually hold, the same length
+      * we would have if we copied the characters, so both values compare the same way.
+      * @param const void* source the bytes we are borrowing.
+      * @param size_t sourceLen the number of bytes we are borrowing.
+      * @param size_t terminatorLen the size of the terminator the characters would need.
+      */
+      void BorrowCharacterBuffer(const void* source, size_t sourceLen, size_t terminatorLen)
+      {
+        // an empty value points to an empty string so we can still read the first character.
+        static const wchar_t empty[] = L"";
+        _cbuffer = nullptr;
+        _cvalue = const_cast<char*>(static_cast<const char*>(sourceLen > 0 ? source : empty));
+        _lcvalue = sourceLen + terminatorLen;
+      }
+
+      /**
+      * Get the hash of the characters, trailing '\0' are ignored so a borrowed value
+      * has the same hash as a copy of it.
+      * The hash is kept in the shared character buffer, borrowed values work it out every time.
+      * @return unsigned long long the hash, never 0.
+      */
+      unsigned long long CharactersHash() const
+      {
+        const auto hash = _cbuffer ? _cbuffer->_hash.load(std::memory_order_relaxed) : 0;
+        return 0 != hash ? hash : CreateCharactersHash();
+      }
+
+      /**
+      * The number of the value when it is used as a key, (@see Hash() and AnyEqual)
+      * Unsigned integers larger than the largest long long are held as negative numbers,
+      * so we use their real value, 18446744073709551615 is not the same key as -1
+      * @return long double the number.
+      */
+      long double KeyNumber() const
+      {
+        return dynamic::is_type_floating(NumberType()) ? _ldvalue : IntegerToFloating(NumberType(), _llivalue);
+      }
+
+      /**
+      * The floating point of an integer, unsigned integers larger than the largest long long
+      * are held as negative numbers, so we use their real value, (@see CreateFromInteger( ... )).
+      * @param const dynamic::Type& type the type of the integer.
+      * @param long long int integer the integer as it is held.
+      * @return long double the floating point of the integer.
+      */
+      static long double IntegerToFloating(const dynamic::Type& type, long long int integer)
+      {
+        if (integer < 0 && IntegerClass_Unsigned == IntegerClassOf(type))
+        {
+          return static_cast<long double>(static_cast<unsigned long long int>(integer));
+        }
+        return static_cast<long double>(integer);
+      }
+
+      /**
+      * Work out the hash of the characters and keep it in the shared buffer, if we have one.
+      * @see CharactersHash()
+      * @return unsigned long long the hash, never 0.
+      */
+      unsigned long long CreateCharactersHash() const
+      {
+        auto length = StoredLength();
+        while (length > 0 && '\0' == _cvalue[length - 1])
+        {
+          --length;
+        }
+        auto hash = hash_bytes(_cvalue, length);
+        hash = (0 == hash) ? 1 : hash;
+        if (_cbuffer)
+        {
+          // all the threads would work out the same value, so the order does not matter.
+          _cbuffer->_hash.store(hash, std::memory_order_relaxed);
+        }
+        return hash;
+      }
+
+      /**
+      * Check if we are borrowing the characters, (rather than sharing a buffer).
+      * @return bool if the characters are borrowed.
+      */
+      bool IsBorrowed() const
+      {
+        return nullptr == _cbuffer && nullptr != _cvalue;
+      }
+
+      /**
+      * The number of bytes we actually hold, a borrowed value does not hold its terminator.
+      * @return size_t the number of bytes we can read from _cvalue.
+      */
+      size_t StoredLength() const
+      {
+        if (!IsBorrowed())
+        {
+          return _lcvalue;
+        }
+        return _lcvalue - (_type == dynamic::Character_wchar_t ? sizeof(wchar_t) : sizeof(char));
+      }
+
       /**
       * depending on the type we return if we should use the unsigned integer in a formula
       * @return bool if we should use the long long int as an unsigned signed integer.
@@ -4025,8 +5652,7 @@ namespace myodd {
       */
       void ParseStringStatus(const char *source, size_t sourceLen)
       {
-        //  call the const char* equivalent.
-        ParseStringStatus(source, sourceLen, '+', '-', '.', '\0' );
+        _stringStatus = StringStatusOf(source, sourceLen);
       }
 
       /**
@@ -4035,9 +5661,25 @@ namespace myodd {
       * @param size_t sourceLen the source len
       */
       void ParseStringStatus(const wchar_t *source, size_t sourceLen)
+      {
+        _stringStatus = StringStatusOf(source, sourceLen);
+      }
+
+      /**
+      * Check if a string is a number or not, partial or not.
+      * @param const char* / const wchar_t* source the string we are checking.
+      * @param size_t sourceLen the source len, in bytes.
+      * @return StringStatus the kind of number the string is.
+      */
+      static StringStatus StringStatusOf(const char* source, size_t sourceLen)
+      {
+        //  call the const char* equivalent.
+        return StringStatusOf(source, sourceLen, '+', '-', '.', '\0');
+      }
+      static StringStatus StringStatusOf(const wchar_t* source, size_t sourceLen)
       {
         //  call the const wide char* equivalent.
-        ParseStringStatus(source, sourceLen, L'+', L'-', L'.', L'\0');
+        return StringStatusOf(source, sourceLen, L'+', L'-', L'.', L'\0');
       }
 
       /**
@@ -4045,28 +5687,28 @@ namespace myodd {
       * @param const char c the character we are checking.
       * @return bool if the number is a digit or not.
       */
-      inline bool _isdigit(const char c) const { return (c >= -1 && c <= 255) && (isdigit(c) != 0); }
+      static inline bool _isdigit(const char c) { return _Parse::is_digit(c); }
 
       /**
       * check if this is a space wide char
       * @param const wchar_t c the character we are checking.
       * @return bool if the char is a space or not.
       */
-      inline bool _isspace(const char c) const { return (c >= -1 && c <= 255) && (isspace(c) != 0); }
+      static inline bool _isspace(const char c) { return _Parse::is_space(c); }
 
       /**
       * check if this is a digit wide char, (0-9)
       * @param const wchar_t c the character we are checking.
       * @return bool if the number is a digit or not.
       */
-      inline bool _isdigit(const wchar_t c)const { return (c >= -1 && c <= 255) && (iswdigit(c) != 0); }
+      static inline bool _isdigit(const wchar_t c) { return _Parse::is_digit(c); }
 
       /**
       * check if this is a space wide char
       * @param const wchar_t c the character we are checking.
       * @return bool if the char is a space or not.
       */
-      inline bool _isspace(const wchar_t c)const { return (c >= -1 && c <= 255) && (iswspace(c) != 0); }
+      static inline bool _isspace(const wchar_t c) { return _Parse::is_space(c); }
 
       /**
       * Parse a string to check if it is a number or not.
@@ -4079,20 +5721,20 @@ namespace myodd {
       * @param const T str_minus the minus sign, ('-')
       * @param const T str_decimal how a decimal is represented, , ('.')
       * @param const T str_eol the eol character, ('\0')
+      * @return StringStatus the kind of number the string is.
       */
       template<typename T>
-      void ParseStringStatus(const T* source, size_t sourceLen, const T str_plus, const T str_minus, const T str_decimal, const T str_eol)
+      static StringStatus StringStatusOf(const T* source, size_t sourceLen, const T str_plus, const T str_minus, const T str_decimal, const T str_eol)
       {
         // sanity check
         if (nullptr == source)
         {
           // null is not a number
-          _stringStatus = StringStatus_Not_A_Number;
-          return;
+          return StringStatus_Not_A_Number;
         }
 
         short sign = 0;       //  0=unknown, 1=positive, 2=negative.
-        short found = 0;      // the number of ... numbers we found.
+        size_t found = 0;     // the number of ... numbers we found.
         bool partial = false; // if we found some non characters.
         bool decimal = false;
 
@@ -4103,6 +5745,16 @@ namespace myodd {
           // get the  character.
           const T *it = (source + i);
 
+          // is it a digit? most of the characters of a number are,
+          // so we skip the whole run of digits at once.
+          if (_isdigit(*it))
+          {
+            const auto digits = _Parse::count_digits(it, loopLen - i);
+            found += digits;
+            i += digits - 1;
+            continue;
+          }
+
           //  is it a space?
           if (_isspace(*it))
           {
@@ -4141,16 +5793,9 @@ namespace myodd {
             break;
           }
 
-          // is it a digit?
-          if (!_isdigit(*it))
-          {
-            // not a number, (anymore)
-            partial = true;
-            break;
-          }
-
-          // this is a number
-          ++found;
+          // not a number, (anymore)
+          partial = true;
+          break;
         }
 
         //
@@ -4160,19 +5805,19 @@ namespace myodd {
         {
           // we found no number at all, so it cannot be a string.
           // of by the time we found a non string, we had no number.
-          _stringStatus = StringStatus_Not_A_Number;
+          return StringStatus_Not_A_Number;
         }
         else if (true == partial)
         {
           if (sign == 1 || sign == 0)
           {
             //  '+' sign or no sign - it is positive.
-            _stringStatus = (decimal) ? StringStatus_Floating_Partial_Pos_Number : StringStatus_Partial_Pos_Number;
+            return (decimal) ? StringStatus_Floating_Partial_Pos_Number : StringStatus_Partial_Pos_Number;
           }
           else if (sign == 2)
           {
             // -ve sign.
-            _stringStatus = (decimal) ? StringStatus_Floating_Partial_Neg_Number : StringStatus_Partial_Neg_Number;
+            return (decimal) ? StringStatus_Floating_Partial_Neg_Number : StringStatus_Partial_Neg_Number;
           }
         }
         else
@@ -4180,26 +5825,58 @@ namespace myodd {
           if (sign == 1 || sign == 0)
           {
             //  '+' sign or no sign - it is positive.
-            _stringStatus = (decimal) ? StringStatus_Floating_Pos_Number : StringStatus_Pos_Number;
+            return (decimal) ? StringStatus_Floating_Pos_Number : StringStatus_Pos_Number;
           }
           else if (sign == 2)
           {
             // -ve sign.
-            _stringStatus = (decimal) ? StringStatus_Floating_Neg_Number : StringStatus_Neg_Number;
+            return (decimal) ? StringStatus_Floating_Neg_Number : StringStatus_Neg_Number;
           }
         }
+
+        // the sign is always one of the above.
+        return StringStatus_Not_A_Number;
+      }
+
+      /**
+      * The header of a shared character buffer, the characters follow it in memory.
+      * Once shared the characters are never changed, so copies of a string can share
+      * the same buffer and a new buffer is only created when the value itself changes.
+      */
+      struct CharacterBuffer
+      {
+        explicit CharacterBuffer(size_t capacity) : _counter(1), _hash(0), _capacity(capacity) {}
+        std::atomic<size_t> _counter;
+
+        // the hash of the characters, 0 until we need it.
+        std::atomic<unsigned long long> _hash;
+
+        // the number of bytes the characters can use, (less the terminator), when they are written over.
+        const size_t _capacity;
+      };
+
+      /**
+      * A unique address for each type, so we can tell what type of copy we are holding without rtti.
+      * @return const void* the address for that type.
+      */
+      template<class T>
+      static const void* TypeTag()
+      {
+        static const char tag = 0;
+        return &tag;
       }
 
       struct UnknownItemBase
       {
         UnknownItemBase() : _counter(1) {}
         virtual ~UnknownItemBase() { }
-        unsigned short _counter;
+        std::atomic<size_t> _counter;
 
         virtual void* Data() const = 0;
         virtual size_t Size() const = 0;
         virtual bool Equal(void* to) const = 0;
         virtual bool IsTrivial() const = 0;
+        virtual const void* Tag() const = 0;
       };
 
       template<class T>
@@ -4244,6 +5921,10 @@ namespace myodd {
           return std::is_trivially_copyable<T>::value;
         }
 
+        virtual const void* Tag() const {
+          return TypeTag<T>();
+        }
+
       protected:
         T* _value;
       };
@@ -4258,19 +5939,144 @@ namespace myodd {
       long double _ldvalue;
 
       // this is the given character value either char/signed char/unsigned char/wide
+      // _cvalue points inside the shared _cbuffer
       char* _cvalue;
       size_t _lcvalue;
+      CharacterBuffer* _cbuffer;
 
       // the status of the string.
       StringStatus _stringStatus;
 
       // 'cosmetic' representations of the numbers, both wide and non wide strings.
       // the values are only created if/when the caller call a to string function.
-      std::string* _svalue;
-      std::wstring* _swvalue;
+      // the cosmetic strings are created the first time they are needed, (even by a const value)
+      mutable std::atomic<std::string*> _svalue;
+      mutable std::atomic<std::wstring*> _swvalue;
 
       // the variable type
       dynamic::Type _type;
     };
+
+    /**
+     * A transparent comparator, so ordered containers can look for a value without creating a key.
+     * The characters are borrowed rather than copied, and the numbers never allocate anything,
+     * the values are compared with the same rules as operator<
+     * For example std::map<Any, Any, AnyLess> map; map.find("Something");
+     */
+    struct AnyLess
+    {
+      // let the containers know that we can compare other types.
+      using is_transparent = void;
+
+      /**
+       * Compare 2 values, (or a value and something we can compare to a value).
+       * @param const L& lhs the lhs value.
+       * @param const R& rhs the rhs value.
+       * @return bool if lhs < rhs
+       */
+      template<class L, class R>
+      bool operator()(const L& lhs, const R& rhs) const
+      {
+        return Any::Ordering_Less == Order(lhs, rhs);
+      }
+
+    private:
+      /**
+       * Order a value and something we can compare to a value, whichever side the value is on.
+       * @param const Any& / const T& lhs the lhs value.
+       * @param const Any& / const T& rhs the rhs value.
+       * @return Any::Ordering how lhs compares to rhs.
+       */
+      static Any::Ordering Order(const Any& lhs, const Any& rhs) { return lhs.CompareTo(rhs); }
+      template<class T>
+      static Any::Ordering Order(const Any& lhs, const T& rhs) { return CompareTo(lhs, rhs); }
+      template<class T>
+      static Any::Ordering Order(const T& lhs, const Any& rhs)
+      {
+        // we compare the value to lhs, so less and greater are swapped.
+        const auto order = CompareTo(rhs, lhs);
+        switch (order)
+        {
+        case Any::Ordering_Less:
+          return Any::Ordering_Greater;
+        case Any::Ordering_Greater:
+          return Any::Ordering_Less;
+        default:
+          return order;
+        }
+      }
+
+      /**
+       * Compare a value to something else, the characters are never copied.
+       * @param const Any& value the value.
+       * @param const T& other what we are comparing the value to.
+       * @return Any::Ordering how the value compares to the other.
+       */
+      static Any::Ordering CompareTo(const Any& value, const char* other) { return value.CompareTo(other, nullptr == other ? 0 : std::char_traits<char>::length(other)); }
+      static Any::Ordering CompareTo(const Any& value, const wchar_t* other) { return value.CompareTo(other, nullptr == other ? 0 : std::char_traits<wchar_t>::length(other)); }
+      static Any::Ordering CompareTo(const Any& value, const std::string& other) { return value.CompareTo(other.data(), other.size()); }
+      static Any::Ordering CompareTo(const Any& value, const std::wstring& other) { return value.CompareTo(other.data(), other.size()); }
+#if MYODD_ANY_CPP17
+      static Any::Ordering CompareTo(const Any& value, std::string_view other) { return value.CompareTo(other.data(), other.size()); }
+      static Any::Ordering CompareTo(const Any& value, std::wstring_view other) { return value.CompareTo(other.data(), other.size()); }
+#endif
+      template<class T>
+      static std::enable_if_t<std::is_arithmetic<T>::value, Any::Ordering> CompareTo(const Any& value, const T& other) { return value.CompareTo(other); }
+    };
+
+    /**
+     * The hash of the keys of hashed containers, it must be used with AnyEqual to compare the keys.
+     * There is no std::hash<Any>, the default std::equal_to<Any> uses operator==, ("12abc" == 12),
+     * and the keys it finds equal would not always have the same hash.
+     * For example std::unordered_map<Any, Any, AnyHash, AnyEqual> map;
+     * @see Any::Hash()
+     */
+    struct AnyHash
+    {
+      /**
+       * Get the hash of a key.
+       * @param const Any& value the key.
+       * @return size_t the hash of the key.
+       */
+      size_t operator()(const Any& value) const
+      {
+        return value.Hash();
+      }
+    };
+
+    /**
+     * The equality of the keys of hashed containers, it matches Any::Hash() and AnyHash
+     * For example std::unordered_map<Any, Any, AnyHash, AnyEqual> map;
+     * Numbers, (and strings that are numbers), are the same key if they have the same value, so 12, 12.0 and "12"
+     * are the same key, other strings are only the same key as the same characters, so "12abc" is not the key 12
+     * even if "12abc" == 12, (operator== compares a string to a number by its leading number).
+     */
+    struct AnyEqual
+    {
+      /**
+       * Check if 2 values are the same key.
+       * @param const Any& lhs the lhs value.
+       * @param const Any& rhs the rhs value.
+       * @return bool if they are the same key.
+       */
+      bool operator()(const Any& lhs, const Any& rhs) const
+      {
+        // copies are compared by their own operator.
+        if (dynamic::is_type_copy(lhs.Type()) || dynamic::is_type_copy(rhs.Type()))
+        {
+          return Any::EqualCopy(lhs, rhs);
+        }
+
+        const auto lhsCharacters = dynamic::is_type_character(lhs.Type()) && !lhs.IsStringNumber(false);
+        const auto rhsCharacters = dynamic::is_type_character(rhs.Type()) && !rhs.IsStringNumber(false);
+        if (lhsCharacters || rhsCharacters)
+        {
+          return lhsCharacters && rhsCharacters && Any::EqualCharacters(lhs, rhs);
+        }
+
+        // the exact values, so 16777217 and 16777216.0f are not the same key, (they have different hashes).
+        return lhs.KeyNumber() == rhs.KeyNumber();
+      }
+    };
   }
 }
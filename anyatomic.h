@@ -0,0 +1,595 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <atomic>         //  std::atomic
+#include <cstring>        //  std::memcpy
+#include <mutex>          //  std::mutex
+#include <stdexcept>      //  std::runtime_error
+#include <thread>         //  std::this_thread::yield
+#include <type_traits>    //  std::enable_if_t
+
+#include "any.h"          // the values
+
+namespace myodd {
+  namespace dynamic {
+    /**
+     * A number that can be changed by several threads at the same time, (counters, totals and so on).
+     * Integers are held in 64 bits, floats and doubles are held as a double, and they are changed
+     * with a single atomic operation, the results follow the same rules as Any, (int + long long is a long long).
+     * When the value has to change from an integer to a floating point, or to a long double, the threads
+     * wait for a lock while the value is converted, and long doubles are always behind the lock.
+     * Strings are held as the number they contain, "12" is held as 12.
+     */
+    class AtomicAny
+    {
+      /**
+       * The integers and floating points we can add without creating an Any, the characters and booleans are not numbers.
+       */
+      template<class T>
+      struct is_number : std::integral_constant<bool, std::is_arithmetic<T>::value
+        && !std::is_same<T, bool>::value
+        && !std::is_same<T, char>::value
+        && !std::is_same<T, signed char>::value
+        && !std::is_same<T, unsigned char>::value
+        && !std::is_same<T, wchar_t>::value
+        && dynamic::get_type<T>::value != dynamic::Misc_unknown>
+      {
+      };
+
+    public:
+      AtomicAny() :
+        AtomicAny(Any())
+      {
+      }
+
+      AtomicAny(const Any& value) :
+        _state(0),
+        _bits(0)
+      {
+        Publish(Number(value));
+      }
+
+      AtomicAny(const AtomicAny&) = delete;
+      AtomicAny& operator=(const AtomicAny&) = delete;
+
+      /**
+       * Read the value.
+       * @return Any the value.
+       */
+      Any Load() const
+      {
+        for (;;)
+        {
+          const auto state = _state.load(std::memory_order_acquire);
+          if ((state & State_Converting) == 0 && StateRepresentation(state) != Representation_Locked)
+          {
+            const auto bits = _bits.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (SameRepresentation(state, _state.load(std::memory_order_relaxed)))
+            {
+              return Decode(state, bits);
+            }
+            continue;
+          }
+
+          // the value is been converted, or it is behind the lock.
+          std::lock_guard<std::mutex> guard(_lock);
+          const auto locked = _state.load(std::memory_order_acquire);
+          return StateRepresentation(locked) == Representation_Locked ? _value : Decode(locked, _bits.load(std::memory_order_acquire));
+        }
+      }
+
+      /**
+       * Replace the value, the type becomes the type of the value.
+       * @throw std::runtime_error if the value is not a number, null or a string.
+       * @param const Any& value the new value.
+       */
+      void Store(const Any& value)
+      {
+        const auto number = Number(value);
+        const auto state = Enter();
+        if (IsLockFree(state, number.Type()))
+        {
+          _bits.store(Encode(number), std::memory_order_relaxed);
+          Leave();
+          return;
+        }
+        Leave();
+
+        // the type changes, so the threads changing the value must wait.
+        Exclusive([&](Any& current)
+        {
+          current = number;
+        });
+      }
+
+      /**
+       * Add a value and return the value before it was added.
+       * @param const Any& rhs the value we are adding.
+       * @return Any the value before the addition.
+       */
+      Any FetchAdd(const Any& rhs)
+      {
+        return FetchNumber(rhs, false);
+      }
+
+      /**
+       * Add a number and return the value before it was added, the number is not copied to an Any.
+       * @param T rhs the number we are adding.
+       * @return Any the value before the addition.
+       */
+      template<class T>
+      std::enable_if_t<is_number<T>::value, Any> FetchAdd(T rhs)
+      {
+        return FetchNumber(rhs, false);
+      }
+
+      /**
+       * Subtract a value and return the value before it was subtracted.
+       * @param const Any& rhs the value we are subtracting.
+       * @return Any the value before the subtraction.
+       */
+      Any FetchSub(const Any& rhs)
+      {
+        return FetchNumber(rhs, true);
+      }
+
+      /**
+       * Subtract a number and return the value before it was subtracted, the number is not copied to an Any.
+       * @param T rhs the number we are subtracting.
+       * @return Any the value before the subtraction.
+       */
+      template<class T>
+      std::enable_if_t<is_number<T>::value, Any> FetchSub(T rhs)
+      {
+        return FetchNumber(rhs, true);
+      }
+
+      /**
+       * Replace the value with the desired value if it is equal to the expected value,
+       * otherwise the expected value is set to the current value.
+       * The values are compared with the same rules as operator==, so 12 is equal to 12.0
+       * @throw std::runtime_error if the desired value is not a number, null or a string.
+       * @param Any& expected the value we expect, updated with the current value if it is not equal.
+       * @param const Any& desired the new value.
+       * @return bool if the value was replaced.
+       */
+      bool CompareExchange(Any& expected, const Any& desired)
+      {
+        const auto number = Number(desired);
+        auto state = Enter();
+        if (IsLockFree(state, number.Type()))
+        {
+          const auto next = Encode(number);
+          auto bits = _bits.load(std::memory_order_acquire);
+          for (;;)
+          {
+            const auto current = Decode(_state.load(std::memory_order_relaxed), bits);
+            if (!(current == expected))
+            {
+              Leave();
+              expected = current;
+              return false;
+            }
+            if (_bits.compare_exchange_weak(bits, next, std::memory_order_release, std::memory_order_acquire))
+            {
+              Leave();
+              return true;
+            }
+          }
+        }
+        Leave();
+
+        bool exchanged = false;
+        Exclusive([&](Any& current)
+        {
+          if (current == expected)
+          {
+            current = number;
+            exchanged = true;
+          }
+          else
+          {
+            expected = current;
+          }
+        });
+        return exchanged;
+      }
+
+      /**
+       * If the value can be changed without a lock, it is only behind the lock while it is a long double.
+       * @return bool if the value is changed without a lock.
+       */
+      bool IsLockFree() const
+      {
+        return StateRepresentation(_state.load(std::memory_order_acquire)) != Representation_Locked;
+      }
+
+    private:
+      /**
+       * A number we are adding or subtracting, see Any::operator+=( ... )
+       */
+      struct Operand
+      {
+        dynamic::Type type;
+        bool isUnsigned;
+        bool isSigned;
+        long long int integer;
+        long double floating;
+      };
+
+      static Operand OperandOf(const Any& rhs)
+      {
+        return Operand{ rhs.NumberType(), rhs.UseUnsignedInteger(), rhs.UseSignedInteger(), rhs._llivalue, rhs._ldvalue };
+      }
+
+      template<class T>
+      static Operand OperandOf(T rhs)
+      {
+        // see Any::CreateFromInteger( ... ) and Any::CreateFromDouble( ... )
+        const auto integer = std::is_integral<T>::value;
+        const auto floating = static_cast<long double>(rhs);
+        return Operand{ dynamic::get_type<T>::value, integer && std::is_unsigned<T>::value, integer && std::is_signed<T>::value,
+          integer ? static_cast<long long int>(rhs) : static_cast<long long int>(floating), floating };
+      }
+
+      /**
+       * How the value is held.
+       */
+      enum Representations
+      {
+        Representation_Integer = 0,
+        Representation_Double = 1,
+        Representation_Locked = 2
+      };
+
+      //  the state is the number of threads changing the value without the lock, the type,
+      //  the representation, a flag while we are converting the value and a generation
+      //  that changes every time the lock is used, so the readers know if the value changed under them.
+      static constexpr unsigned long long State_Writers = 0xffffffffull;
+      static constexpr int State_TypeShift = 32;
+      static constexpr unsigned long long State_Type = 0xffull << State_TypeShift;
+      static constexpr int State_RepresentationShift = 40;
+      static constexpr unsigned long long State_Representation = 0x3ull << State_RepresentationShift;
+      static constexpr unsigned long long State_Converting = 1ull << 42;
+      static constexpr unsigned long long State_Generation = 1ull << 43;
+
+      static dynamic::Type StateType(unsigned long long state)
+      {
+        return static_cast<dynamic::Type>((state & State_Type) >> State_TypeShift);
+      }
+
+      static Representations StateRepresentation(unsigned long long state)
+      {
+        return static_cast<Representations>((state & State_Representation) >> State_RepresentationShift);
+      }
+
+      // the bits can only be decoded with the state they were read with if only the number of writers changed,
+      // a writer that widens the type does it before it changes the bits.
+      static bool SameRepresentation(unsigned long long lhs, unsigned long long rhs)
+      {
+        return ((lhs ^ rhs) & ~State_Writers) == 0;
+      }
+
+      /**
+       * How a type is held.
+       * @param dynamic::Type type the type of a number.
+       * @return Representations how the value is held.
+       */
+      static Representations RepresentationOf(dynamic::Type type)
+      {
+        switch (type)
+        {
+        case dynamic::Floating_point_float:
+        case dynamic::Floating_point_double:
+          return Representation_Double;
+
+        case dynamic::Floating_point_long_double:
+          return Representation_Locked;
+
+        default:
+          return Representation_Integer;
+        }
+      }
+
+      /**
+       * If a value of a certain type can replace the current value without the lock.
+       * @param unsigned long long state the state when we entered.
+       * @param dynamic::Type type the type of the new value.
+       * @return bool if we can replace the value without the lock.
+       */
+      static bool IsLockFree(unsigned long long state, dynamic::Type type)
+      {
+        return (state & State_Converting) == 0 && StateRepresentation(state) != Representation_Locked && StateType(state) == type;
+      }
+
+      /**
+       * Convert a value to a number that we can hold.
+       * @throw std::runtime_error if the value is not a number, null or a string.
+       * @param const Any& value the value.
+       * @return Any the number.
+       */
+      static Any Number(const Any& value)
+      {
+        if (dynamic::is_type_copy(value.Type()))
+        {
+          throw std::runtime_error("An AtomicAny can only hold numbers.");
+        }
+        if (!dynamic::is_type_character(value.Type()))
+        {
+          return value;
+        }
+
+        // see AnyColumn::operator[]( ... )
+        Any number;
+        number._type = value.NumberType();
+        if (dynamic::is_type_floating(number._type))
+        {
+          number._ldvalue = value._ldvalue;
+          number._llivalue = static_cast<long long int>(number._ldvalue);
+        }
+        else
+        {
+          number._llivalue = value._llivalue;
+          number._ldvalue = Any::IntegerToFloating(number._type, number._llivalue);
+        }
+        return number;
+      }
+
+      /**
+       * The bits of a number in the way it is held.
+       * @param const Any& number the number.
+       * @return unsigned long long the bits.
+       */
+      static unsigned long long Encode(const Any& number)
+      {
+        if (RepresentationOf(number.Type()) == Representation_Double)
+        {
+          const auto value = static_cast<double>(number._ldvalue);
+          unsigned long long bits;
+          std::memcpy(&bits, &value, sizeof(bits));
+          return bits;
+        }
+        return static_cast<unsigned long long>(number._llivalue);
+      }
+
+      static double ToDouble(unsigned long long bits)
+      {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+      }
+
+      /**
+       * Create a value from the bits we hold.
+       * @param unsigned long long state the state the bits were read with.
+       * @param unsigned long long bits the bits.
+       * @return Any the value.
+       */
+      static Any Decode(unsigned long long state, unsigned long long bits)
+      {
+        Any value;
+        if (dynamic::is_type_null(StateType(state)))
+        {
+          return value;
+        }
+
+        value._type = StateType(state);
+        if (StateRepresentation(state) == Representation_Double)
+        {
+          // see Any::CreateFromDouble( ... )
+          value._ldvalue = static_cast<long double>(ToDouble(bits));
+          value._llivalue = static_cast<long long int>(value._ldvalue);
+        }
+        else
+        {
+          value._llivalue = static_cast<long long int>(bits);
+          value._ldvalue = Any::IntegerToFloating(value._type, value._llivalue);
+        }
+        return value;
+      }
+
+      /**
+       * Let the other threads know that we are changing the value without the lock.
+       * @return unsigned long long the state when we entered.
+       */
+      unsigned long long Enter()
+      {
+        return _state.fetch_add(1, std::memory_order_acquire);
+      }
+
+      void Leave()
+      {
+        _state.fetch_sub(1, std::memory_order_release);
+      }
+
+      /**
+       * Add or subtract a number, without the lock if the value does not have to be converted.
+       * @param const T& rhs the value, or the number, we are adding or subtracting.
+       * @param bool subtract if we are subtracting the value.
+       * @return Any the value before the operation.
+       */
+      template<class T>
+      Any FetchNumber(const T& rhs, bool subtract)
+      {
+        const auto operand = OperandOf(rhs);
+        const auto rhsType = operand.type;
+        const auto state = Enter();
+        const auto type = Any::CalculateType(StateType(state), rhsType);
+        if ((state & State_Converting) == 0 && StateRepresentation(state) != Representation_Locked && RepresentationOf(type) == StateRepresentation(state))
+        {
+          // the type is widened before the bits change, so a reader that sees the new bits also sees the new type.
+          if (type != StateType(state))
+          {
+            Widen(rhsType);
+          }
+
+          unsigned long long bits;
+          if (StateRepresentation(state) == Representation_Integer)
+          {
+            // see Any::AddNumber( ... ), booleans and nulls are added as long doubles.
+            const auto number = operand.isUnsigned || operand.isSigned ?
+              static_cast<unsigned long long>(operand.integer) :
+              static_cast<unsigned long long>(static_cast<long long int>(operand.floating));
+            bits = subtract ? _bits.fetch_sub(number, std::memory_order_acq_rel) : _bits.fetch_add(number, std::memory_order_acq_rel);
+          }
+          else
+          {
+            const auto number = operand.isUnsigned ? static_cast<long double>(static_cast<unsigned long long>(operand.integer)) :
+              operand.isSigned ? static_cast<long double>(operand.integer) :
+              operand.floating;
+            bits = _bits.load(std::memory_order_acquire);
+            for (;;)
+            {
+              const auto value = static_cast<long double>(ToDouble(bits));
+              const auto next = static_cast<double>(subtract ? value - number : value + number);
+              unsigned long long nextBits;
+              std::memcpy(&nextBits, &next, sizeof(nextBits));
+              if (_bits.compare_exchange_weak(bits, nextBits, std::memory_order_acq_rel, std::memory_order_acquire))
+              {
+                break;
+              }
+            }
+          }
+
+          // the bits might have been changed by a thread that widened the type after we entered.
+          const auto previous = Decode(_state.load(std::memory_order_relaxed), bits);
+          Leave();
+          return previous;
+        }
+        Leave();
+
+        // the value has to be converted, or it is behind the lock.
+        return Exclusive([&](Any& current)
+        {
+          if (subtract)
+          {
+            current -= rhs;
+          }
+          else
+          {
+            current += rhs;
+          }
+        });
+      }
+
+      /**
+       * Widen the type in the same representation, (an int to a long long), before we change the bits.
+       * The type is only ever widened without the lock, so the order of the threads does not matter,
+       * a reader can see the wider type with the number before it was added, but never a number that does not fit the type.
+       * @param dynamic::Type rhsType the type of the number that is added.
+       */
+      void Widen(dynamic::Type rhsType)
+      {
+        auto state = _state.load(std::memory_order_relaxed);
+        for (;;)
+        {
+          const auto type = Any::CalculateType(StateType(state), rhsType);
+          const auto next = (state & ~State_Type) | (static_cast<unsigned long long>(type) << State_TypeShift);
+          if (_state.compare_exchange_weak(state, next, std::memory_order_acq_rel, std::memory_order_relaxed))
+          {
+            return;
+          }
+        }
+      }
+
+      /**
+       * Change the value behind the lock, the threads changing the value without the lock are
+       * stopped while we convert it.
+       * @param Function function the function changing the value.
+       * @return Any the value before it was changed.
+       */
+      template<class Function>
+      Any Exclusive(Function function)
+      {
+        std::lock_guard<std::mutex> guard(_lock);
+        _state.fetch_or(State_Converting);
+        while ((_state.load() & State_Writers) != 0)
+        {
+          std::this_thread::yield();
+        }
+
+        // the writers that left might have widened the type.
+        const auto state = _state.load();
+        const auto previous = StateRepresentation(state) == Representation_Locked ? _value : Decode(state, _bits.load());
+        auto current = previous;
+        try
+        {
+          function(current);
+        }
+        catch (...)
+        {
+          // put the value back the way it was.
+          Publish(previous);
+          throw;
+        }
+        Publish(current);
+        return previous;
+      }
+
+      /**
+       * Hold a new value, the caller has the lock, or nobody else can see us yet.
+       * @param const Any& number the new value.
+       */
+      void Publish(const Any& number)
+      {
+        const auto type = number.Type();
+        const auto representation = RepresentationOf(type);
+        if (representation == Representation_Locked)
+        {
+          _value = number;
+        }
+        else
+        {
+          _value = Any();
+          _bits.store(Encode(number));
+        }
+
+        auto state = _state.load();
+        for (;;)
+        {
+          const auto next = ((state & ~(State_Type | State_Representation | State_Converting)) + State_Generation)
+            | (static_cast<unsigned long long>(type) << State_TypeShift)
+            | (static_cast<unsigned long long>(representation) << State_RepresentationShift);
+          if (_state.compare_exchange_weak(state, next))
+          {
+            return;
+          }
+        }
+      }
+
+      // the state, see State_xxx
+      std::atomic<unsigned long long> _state;
+
+      // the integer or the bits of the double.
+      std::atomic<unsigned long long> _bits;
+
+      // the lock, and the value while it is a long double.
+      mutable std::mutex _lock;
+      Any _value;
+    };
+  }
+}
@@ -0,0 +1,190 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <cstddef>        //  size_t
+#include <stdexcept>      //  std::runtime_error
+#include <string>
+
+#include "any.h"          // the values
+#include "descriptor.h"   // file descriptors
+
+namespace myodd {
+  namespace dynamic {
+    /**
+     * Write values, in their binary form, to a buffer or to a file descriptor.
+     * The stream starts with a header with the version of the format.
+     * @see Any::Serialize( ... )
+     */
+    class AnyWriter
+    {
+    public:
+      /**
+       * Append the values to a buffer.
+       * @param std::string& buffer where we are writing, it must outlive the writer.
+       */
+      explicit AnyWriter(std::string& buffer) :
+        _writer(buffer),
+        _buffer(_writer.Buffer())
+      {
+        _Binary::append_header(_buffer);
+      }
+
+      /**
+       * Write the values to a file descriptor, they are buffered until we have enough of them.
+       * @param int fd the file descriptor, it is not closed by the writer.
+       */
+      explicit AnyWriter(int fd) :
+        _writer(fd),
+        _buffer(_writer.Buffer())
+      {
+        _Binary::append_header(_buffer);
+      }
+
+      AnyWriter(const AnyWriter&) = delete;
+      AnyWriter& operator=(const AnyWriter&) = delete;
+
+      /**
+       * Write a value.
+       * @param const Any& value the value we are writing.
+       */
+      void Write(const Any& value)
+      {
+        value.Serialize(_buffer);
+        _writer.FlushIfNeeded();
+      }
+
+      /**
+       * Write the buffered values to the file descriptor, what is left is written when the writer is destroyed,
+       * call it if you need to know about errors.
+       */
+      void Flush()
+      {
+        _writer.Flush();
+      }
+
+    private:
+      _Descriptor::Writer _writer;
+      std::string& _buffer;
+    };
+
+    /**
+     * Read values written by an AnyWriter from a buffer or from a file descriptor.
+     */
+    class AnyReader
+    {
+    public:
+      /**
+       * Read the values from a buffer.
+       * @param const char* data the data, it must outlive the reader.
+       * @param size_t len the size of the data.
+       */
+      AnyReader(const char* data, size_t len) :
+        _source(data),
+        _end(data + len)
+      {
+        ReadHeader();
+      }
+
+      /**
+       * Read the values from a file descriptor, a chunk at a time.
+       * @param int fd the file descriptor, it is not closed by the reader.
+       */
+      explicit AnyReader(int fd) :
+        _reader(fd, ReadSize),
+        _source(nullptr),
+        _end(nullptr)
+      {
+        ReadHeader();
+      }
+
+      AnyReader(const AnyReader&) = delete;
+      AnyReader& operator=(const AnyReader&) = delete;
+
+      /**
+       * Read the next value.
+       * @throw std::runtime_error if the data is not a value, or the last value is truncated.
+       * @param Any& value the value we read.
+       * @return bool false if there are no more values.
+       */
+      bool Read(Any& value)
+      {
+        for (;;)
+        {
+          if (_source == _end && !Fill())
+          {
+            return false;
+          }
+
+          try
+          {
+            value = Any::Deserialize(_source, _end);
+            return true;
+          }
+          catch (const _Binary::truncated_error&)
+          {
+            // the rest of the value might still be in the file.
+            if (!Fill())
+            {
+              throw;
+            }
+          }
+        }
+      }
+
+    private:
+      /**
+       * Read and check the header of the stream.
+       */
+      void ReadHeader()
+      {
+        while (static_cast<size_t>(_end - _source) < _Binary::header_size)
+        {
+          if (!Fill())
+          {
+            throw _Binary::truncated_error();
+          }
+        }
+        _Binary::read_header(_source, _end);
+      }
+
+      /**
+       * Read more data from the file descriptor, after what we have not read yet.
+       * @return bool false if there is nothing more to read.
+       */
+      bool Fill()
+      {
+        return _reader.Fill(_source, _end) > 0;
+      }
+
+      // how much we read from the file descriptor at a time.
+      static constexpr size_t ReadSize = 64 * 1024;
+
+      _Descriptor::Reader _reader;
+      const char* _source;
+      const char* _end;
+    };
+  }
+}
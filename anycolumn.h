@@ -0,0 +1,781 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <algorithm>      //  std::all_of / std::min
+#include <cstddef>        //  size_t
+#include <cstring>        //  std::memcpy / std::memcmp / std::memset
+#include <stdexcept>      //  std::runtime_error / std::out_of_range
+#include <string>
+#include <typeinfo>       //  std::bad_cast
+#include <vector>
+
+#include "any.h"          // the values
+#include "compress.h"     // compressed column blocks
+#include "descriptor.h"   // file descriptors
+
+namespace myodd {
+  namespace dynamic {
+    /**
+     * Write a column of values that can be used where it is, (a mapped file for example), without reading it first.
+     * The column starts with the version of the format, followed by the heap, (the characters and the long doubles
+     * as they are written by Any::Serialize( ... )), then the blocks of 128 values, then the directory of the blocks,
+     * and a footer to find all of those.
+     * Each value has a type tag and a slot, (the integer, the double or where the value is in the heap), a block
+     * only has one tag if all its values have the same one, and its slots are in the smallest encoding, @see _Compress
+     * @see AnyColumn
+     */
+    class AnyColumnWriter
+    {
+    public:
+      /**
+       * Append the column to a buffer.
+       * @param std::string& buffer where we are writing, it must outlive the writer.
+       */
+      explicit AnyColumnWriter(std::string& buffer) :
+        _writer(buffer),
+        _buffer(_writer.Buffer()),
+        _position(0),
+        _closed(false)
+      {
+        AppendHeader();
+      }
+
+      /**
+       * Write the column to a file descriptor, we never go back to what we wrote,
+       * so it does not need to be a file we can seek in.
+       * @param int fd the file descriptor, it is not closed by the writer.
+       */
+      explicit AnyColumnWriter(int fd) :
+        _writer(fd),
+        _buffer(_writer.Buffer()),
+        _position(0),
+        _closed(false)
+      {
+        AppendHeader();
+      }
+
+      /**
+       * Write the rest of the column, call Close() if you need to know about errors.
+       */
+      ~AnyColumnWriter()
+      {
+        try
+        {
+          Close();
+        }
+        catch (...)
+        {
+        }
+      }
+
+      AnyColumnWriter(const AnyColumnWriter&) = delete;
+      AnyColumnWriter& operator=(const AnyColumnWriter&) = delete;
+
+      /**
+       * Add a value to the column.
+       * @throw std::runtime_error if the value is a copy of an object, or the column is closed.
+       * @param const Any& value the value we are adding.
+       */
+      void Write(const Any& value)
+      {
+        if (_closed)
+        {
+          throw std::runtime_error("The column is closed.");
+        }
+
+        if (dynamic::is_type_null(value.Type()))
+        {
+          AddSlot(value.BinaryTag(0), 0);
+          return;
+        }
+
+        // most numbers fit in their slot.
+        if (!dynamic::is_type_character(value.Type()) && !dynamic::is_type_copy(value.Type()))
+        {
+          const auto representation = value.NumberRepresentation();
+          switch (representation)
+          {
+          case Any::BinaryRepresentation_Integer:
+            AddSlot(value.BinaryTag(representation), static_cast<unsigned long long>(value._llivalue));
+            return;
+
+          case Any::BinaryRepresentation_Float:
+          case Any::BinaryRepresentation_Double:
+            // a float is a double as well.
+            AddSlot(value.BinaryTag(representation), DoubleBits(static_cast<double>(value._ldvalue)));
+            return;
+
+          default:
+            break;
+          }
+        }
+
+        // everything else is in the heap, the slot is where it is.
+        const auto size = _buffer.size();
+        value.Serialize(_buffer);
+        AddSlot(_buffer[size], _position - _Binary::column_header_size);
+        _position += _buffer.size() - size;
+        _writer.FlushIfNeeded();
+      }
+
+      /**
+       * Write the tags, the slots and the footer, nothing can be written after that.
+       */
+      void Close()
+      {
+        if (_closed)
+        {
+          return;
+        }
+        _closed = true;
+
+        const auto heapSize = _position - _Binary::column_header_size;
+
+        // the blocks and the directory are aligned to 8 bytes, from the start of the column.
+        Pad();
+        const auto blocksOffset = _position;
+        std::string directory;
+        for (size_t first = 0; first < _tags.size(); first += _Compress::block_size)
+        {
+          const auto count = std::min(_Compress::block_size, _tags.size() - first);
+          AppendBlock(directory, _position - blocksOffset, _tags.data() + first, _slots.data() + first, count);
+        }
+
+        Pad();
+        const auto directoryOffset = _position;
+        Append(directory.data(), directory.size());
+
+        char footer[_Binary::column_footer_size];
+        _Binary::store_little_endian<unsigned long long>(footer, _tags.size());
+        _Binary::store_little_endian<unsigned long long>(footer + 8, heapSize);
+        _Binary::store_little_endian<unsigned long long>(footer + 16, blocksOffset);
+        _Binary::store_little_endian<unsigned long long>(footer + 24, directoryOffset);
+        std::memcpy(footer + 32, _Binary::column_magic, sizeof(_Binary::column_magic));
+        std::memset(footer + 36, 0, 4);
+        footer[36] = static_cast<char>(_Binary::column_version);
+        Append(footer, sizeof(footer));
+        _writer.Flush();
+      }
+
+    private:
+      /**
+       * Append the column header, the magic characters and the version.
+       */
+      void AppendHeader()
+      {
+        char header[_Binary::column_header_size] = { 0 };
+        std::memcpy(header, _Binary::column_magic, sizeof(_Binary::column_magic));
+        header[4] = static_cast<char>(_Binary::column_version);
+        Append(header, sizeof(header));
+      }
+
+      /**
+       * Add the tag and the slot of a value.
+       * @param char tag the tag of the value.
+       * @param unsigned long long slot the number, or where the value is in the heap.
+       */
+      void AddSlot(char tag, unsigned long long slot)
+      {
+        _tags += tag;
+        _slots.push_back(slot);
+      }
+
+      /**
+       * Append a block of values, (their tags and their slots), and add it to the directory.
+       * The slots are a frame of reference with or without a step, or runs, whichever is the smallest.
+       * @param std::string& directory the directory of the blocks.
+       * @param unsigned long long offset where the block is, from the start of the blocks.
+       * @param const char* tags the tags of the values.
+       * @param const unsigned long long* slots the slots of the values.
+       * @param size_t count the number of values, at most _Compress::block_size.
+       */
+      void AppendBlock(std::string& directory, unsigned long long offset, const char* tags, const unsigned long long* slots, size_t count)
+      {
+        const auto uniform = std::all_of(tags, tags + count, [&](char tag) { return tag == tags[0]; });
+
+        // without a step, and with the average step, (sorted numbers).
+        unsigned long long base = 0;
+        const auto width = _Compress::frame_width(slots, count, 0, base);
+        const auto step = count > 1 ? static_cast<unsigned long long>(static_cast<long long>(slots[count - 1] - slots[0]) / static_cast<long long>(count - 1)) : 0;
+        unsigned long long stepBase = 0;
+        const auto stepWidth = _Compress::frame_width(slots, count, step, stepBase);
+        const auto runs = _Compress::count_runs(slots, count);
+
+        _block.clear();
+        if (!uniform)
+        {
+          _block.append(tags, count);
+        }
+
+        char entry[_Binary::column_block_size] = { 0 };
+        _Binary::store_little_endian(entry, offset);
+        entry[26] = uniform ? tags[0] : 0;
+        entry[27] = uniform ? 1 : 0;
+        if (runs * _Compress::run_size < _Compress::packed_size(count, std::min(width, stepWidth)))
+        {
+          _Compress::append_runs(_block, slots, count);
+          _Binary::store_little_endian<unsigned long long>(entry + 16, runs);
+          entry[24] = static_cast<char>(_Compress::Encoding_Run);
+        }
+        else if (stepWidth < width)
+        {
+          _Compress::append_frame(_block, slots, count, stepBase, step, stepWidth);
+          _Binary::store_little_endian(entry + 8, stepBase);
+          _Binary::store_little_endian(entry + 16, step);
+          entry[24] = static_cast<char>(_Compress::Encoding_Frame);
+          entry[25] = static_cast<char>(stepWidth);
+        }
+        else
+        {
+          _Compress::append_frame(_block, slots, count, base, 0, width);
+          _Binary::store_little_endian(entry + 8, base);
+          entry[24] = static_cast<char>(_Compress::Encoding_Frame);
+          entry[25] = static_cast<char>(width);
+        }
+        directory.append(entry, sizeof(entry));
+        Append(_block.data(), _block.size());
+      }
+
+      /**
+       * Get the bits of a double.
+       * @param double number the number.
+       * @return unsigned long long the bits.
+       */
+      static unsigned long long DoubleBits(double number)
+      {
+        unsigned long long bits;
+        std::memcpy(&bits, &number, sizeof(bits));
+        return bits;
+      }
+
+      /**
+       * Append some bytes to the column.
+       * @param const char* data the bytes.
+       * @param size_t len the number of bytes.
+       */
+      void Append(const char* data, size_t len)
+      {
+        _buffer.append(data, len);
+        _position += len;
+        _writer.FlushIfNeeded();
+      }
+
+      /**
+       * Pad the column to 8 bytes.
+       */
+      void Pad()
+      {
+        static const char zeros[8] = { 0 };
+        Append(zeros, static_cast<size_t>((8 - _position % 8) % 8));
+      }
+
+      _Descriptor::Writer _writer;
+      std::string& _buffer;
+
+      // where we are, from the start of the column.
+      unsigned long long _position;
+
+      // the tags and the slots are written after the heap.
+      std::string _tags;
+      std::vector<unsigned long long> _slots;
+      std::string _block;
+      bool _closed;
+    };
+
+    /**
+     * A read-only view of a column written by an AnyColumnWriter, the data is used where it is,
+     * (a mapped file for example), so opening it does not depend on the number of values.
+     * The numbers are read from their slot and the strings borrow their characters from the data.
+     * A value is decoded from its block on its own, use Integers( ... ) to decode a lot of them a block at a time.
+     */
+    class AnyColumn
+    {
+    public:
+      /**
+       * Open the column, only the header and the footer are checked.
+       * @throw std::runtime_error if the data is not a column.
+       * @param const char* data the data, it must outlive the column and the values we return.
+       * @param size_t len the size of the data.
+       */
+      AnyColumn(const char* data, size_t len) :
+        _size(0),
+        _version(0),
+        _heap(nullptr),
+        _heapEnd(nullptr),
+        _tags(nullptr),
+        _slots(nullptr)
+      {
+        const auto minimum = _Binary::column_header_size + _Binary::column_footer_size;
+        if (len < minimum
+          || 0 != std::memcmp(data, _Binary::column_magic, sizeof(_Binary::column_magic))
+          || 0 != std::memcmp(data + len - 8, _Binary::column_magic, sizeof(_Binary::column_magic)))
+        {
+          throw std::runtime_error("This is not a column of values.");
+        }
+        _version = static_cast<unsigned char>(data[4]);
+        if (_version > _Binary::column_version)
+        {
+          throw std::runtime_error("The column was written by a newer version.");
+        }
+
+        // the footer tells us where everything is, it must all be before the footer.
+        // version 1 has the tags and the slots, version 2 the blocks and their directory.
+        const char* footer = data + len - _Binary::column_footer_size;
+        const auto size = _Binary::load_little_endian<unsigned long long>(footer);
+        const auto heapSize = _Binary::load_little_endian<unsigned long long>(footer + 8);
+        const auto tagsOffset = _Binary::load_little_endian<unsigned long long>(footer + 16);
+        const auto slotsOffset = _Binary::load_little_endian<unsigned long long>(footer + 24);
+        const auto footerOffset = static_cast<unsigned long long>(len - _Binary::column_footer_size);
+        const auto blocks = size / _Compress::block_size + (0 != size % _Compress::block_size);
+        if (heapSize > tagsOffset - _Binary::column_header_size
+          || tagsOffset < _Binary::column_header_size
+          || tagsOffset > slotsOffset
+          || slotsOffset > footerOffset
+          || (_version < 2 && size > slotsOffset - tagsOffset)
+          || (_version < 2 && size > (footerOffset - slotsOffset) / 8)
+          || (_version >= 2 && blocks > (footerOffset - slotsOffset) / _Binary::column_block_size))
+        {
+          throw std::runtime_error("The column is corrupted.");
+        }
+
+        _size = static_cast<size_t>(size);
+        _heap = data + _Binary::column_header_size;
+        _heapEnd = _heap + heapSize;
+        _tags = data + tagsOffset;
+        _slots = data + slotsOffset;
+      }
+
+      /**
+       * The number of values in the column.
+       * @return size_t the number of values.
+       */
+      size_t Size() const
+      {
+        return _size;
+      }
+
+      /**
+       * The type of a value, without reading it.
+       * @param size_t index the index of the value.
+       * @return dynamic::Type the type.
+       */
+      dynamic::Type Type(size_t index) const
+      {
+        return static_cast<dynamic::Type>(Tag(index) & Any::BinaryTypeMask);
+      }
+
+      /**
+       * Read a value, the strings borrow their characters from the data.
+       * @throw std::out_of_range if the index is past the last value.
+       * @param size_t index the index of the value.
+       * @return Any the value.
+       */
+      Any operator[](size_t index) const
+      {
+        unsigned long long slot;
+        const auto tag = Tag(index, slot);
+        switch (Representation(tag))
+        {
+        case Slot_Integer:
+          {
+            Any value;
+            value._type = static_cast<dynamic::Type>(tag & Any::BinaryTypeMask);
+            value._llivalue = static_cast<long long int>(slot);
+            value._ldvalue = Any::IntegerToFloating(value._type, value._llivalue);
+            return value;
+          }
+
+        case Slot_Double:
+          {
+            // see Any::CreateFromDouble( ... )
+            Any value;
+            value._type = static_cast<dynamic::Type>(tag & Any::BinaryTypeMask);
+            value._ldvalue = SlotDouble(slot);
+            value._llivalue = static_cast<long long int>(value._ldvalue);
+            return value;
+          }
+
+        case Slot_Null:
+          return Any();
+
+        default:
+          {
+            const char* source = HeapAt(slot);
+            return Any::DeserializeBorrowed(source, _heapEnd);
+          }
+        }
+      }
+
+      /**
+       * Read a value as an integer, integers are read straight from their slot.
+       * @param size_t index the index of the value.
+       * @return long long int the number.
+       */
+      long long int Integer(size_t index) const
+      {
+        unsigned long long slot;
+        const auto tag = Tag(index, slot);
+        if (Slot_Integer == Representation(tag))
+        {
+          return static_cast<long long int>(slot);
+        }
+        return static_cast<long long int>((*this)[index]);
+      }
+
+      /**
+       * Read a value as a floating point, numbers are read straight from their slot.
+       * @param size_t index the index of the value.
+       * @return long double the number.
+       */
+      long double Floating(size_t index) const
+      {
+        unsigned long long slot;
+        const auto tag = Tag(index, slot);
+        switch (Representation(tag))
+        {
+        case Slot_Integer:
+          return Any::IntegerToFloating(static_cast<dynamic::Type>(tag & Any::BinaryTypeMask), static_cast<long long int>(slot));
+
+        case Slot_Double:
+          return SlotDouble(slot);
+
+        default:
+          return static_cast<long double>((*this)[index]);
+        }
+      }
+
+      /**
+       * Read values as integers, a block at a time, the integers are decoded straight from their block.
+       * @throw std::out_of_range if the values are past the last value.
+       * @param size_t index the index of the first value.
+       * @param size_t count the number of values.
+       * @param long long int* values where we write the numbers.
+       */
+      void Integers(size_t index, size_t count, long long int* values) const
+      {
+        if (index > _size || count > _size - index)
+        {
+          throw std::out_of_range("The index is past the last value.");
+        }
+
+        unsigned long long slots[_Compress::block_size];
+        while (count > 0)
+        {
+          const auto first = index % _Compress::block_size;
+          const auto blockCount = std::min(_Compress::block_size - first, count);
+          Block block;
+          if (_version >= 2 && ReadBlock(index / _Compress::block_size, block) && nullptr == block.tags && Slot_Integer == Representation(block.tag))
+          {
+            if (blockCount == block.count)
+            {
+              // the whole block, straight to the values.
+              DecodeBlock(block, reinterpret_cast<unsigned long long*>(values));
+            }
+            else
+            {
+              DecodeBlock(block, slots);
+              std::memcpy(values, slots + first, blockCount * sizeof(slots[0]));
+            }
+          }
+          else
+          {
+            for (size_t i = 0; i < blockCount; ++i)
+            {
+              values[i] = Integer(index + i);
+            }
+          }
+          index += blockCount;
+          values += blockCount;
+          count -= blockCount;
+        }
+      }
+
+#if MYODD_ANY_CPP17
+      /**
+      * Get a view of the characters of a string, in the data.
+      * @throw std::bad_cast if the value is not a string of characters.
+      * @param size_t index the index of the value.
+      * @return std::string_view the characters.
+      */
+      std::string_view Characters(size_t index) const
+      {
+        const auto type = Type(index);
+        if (type != dynamic::Character_char && type != dynamic::Character_signed_char && type != dynamic::Character_unsigned_char)
+        {
+          throw std::bad_cast();
+        }
+
+        // see Any::SerializeCharacters( ... ), the tag, the length and the characters.
+        const char* source = HeapAt(Slot(index));
+        _Binary::read_byte(source, _heapEnd);
+        auto units = static_cast<size_t>(_Binary::read_varint(source, _heapEnd));
+        if (units > static_cast<size_t>(_heapEnd - source))
+        {
+          throw _Binary::truncated_error();
+        }
+        if (units > 0 && '\0' == source[units - 1])
+        {
+          --units;
+        }
+        return std::string_view(source, units);
+      }
+#endif
+
+    private:
+      /**
+       * What the slot of a value holds.
+       */
+      enum SlotType
+      {
+        Slot_Null,
+        Slot_Integer,
+        Slot_Double,
+        Slot_Heap
+      };
+
+      /**
+       * Work out what the slot holds from the tag.
+       * @see AnyColumnWriter::Write( ... )
+       * @param unsigned char tag the tag.
+       * @return SlotType what the slot holds.
+       */
+      static SlotType Representation(unsigned char tag)
+      {
+        const auto type = static_cast<dynamic::Type>(tag & Any::BinaryTypeMask);
+        if (dynamic::is_type_null(type))
+        {
+          return Slot_Null;
+        }
+        if (dynamic::is_type_character(type))
+        {
+          return Slot_Heap;
+        }
+        switch (tag >> Any::BinaryRepresentationShift)
+        {
+        case Any::BinaryRepresentation_Integer:
+          return Slot_Integer;
+
+        case Any::BinaryRepresentation_Float:
+        case Any::BinaryRepresentation_Double:
+          return Slot_Double;
+
+        default:
+          return Slot_Heap;
+        }
+      }
+
+      /**
+       * Get the tag of a value.
+       * @throw std::out_of_range if the index is past the last value.
+       * @param size_t index the index of the value.
+       * @return unsigned char the tag.
+       */
+      unsigned char Tag(size_t index) const
+      {
+        if (index >= _size)
+        {
+          throw std::out_of_range("The index is past the last value.");
+        }
+        if (_version < 2)
+        {
+          return static_cast<unsigned char>(_tags[index]);
+        }
+
+        Block block;
+        ReadBlock(index / _Compress::block_size, block);
+        return nullptr == block.tags ? block.tag : static_cast<unsigned char>(block.tags[index % _Compress::block_size]);
+      }
+
+      /**
+       * Get the tag and the slot of a value, the block is only read once.
+       * @throw std::out_of_range if the index is past the last value.
+       * @param size_t index the index of the value.
+       * @param unsigned long long& slot the slot.
+       * @return unsigned char the tag.
+       */
+      unsigned char Tag(size_t index, unsigned long long& slot) const
+      {
+        if (_version < 2)
+        {
+          const auto tag = Tag(index);
+          slot = _Binary::load_little_endian<unsigned long long>(_slots + index * 8);
+          return tag;
+        }
+        if (index >= _size)
+        {
+          throw std::out_of_range("The index is past the last value.");
+        }
+
+        Block block;
+        ReadBlock(index / _Compress::block_size, block);
+        const auto i = index % _Compress::block_size;
+        if (_Compress::Encoding_Run == block.encoding)
+        {
+          slot = _Compress::run_value(block.slots, static_cast<size_t>(block.step), i);
+        }
+        else
+        {
+          slot = block.base + i * block.step + _Compress::unpack_one(block.slots, i, block.width);
+        }
+        return nullptr == block.tags ? block.tag : static_cast<unsigned char>(block.tags[i]);
+      }
+
+      /**
+       * Get the slot of a value.
+       * @param size_t index the index of the value, it must be valid.
+       * @return unsigned long long the slot.
+       */
+      unsigned long long Slot(size_t index) const
+      {
+        unsigned long long slot;
+        Tag(index, slot);
+        return slot;
+      }
+
+      /**
+       * A block of values, @see AnyColumnWriter::AppendBlock( ... )
+       */
+      struct Block
+      {
+        size_t count;
+        const char* tags;
+        const char* slots;
+        unsigned long long base;
+        unsigned long long step;
+        unsigned char encoding;
+        unsigned char width;
+        unsigned char tag;
+      };
+
+      /**
+       * Read a block from the directory.
+       * @throw std::runtime_error if the block is past the blocks.
+       * @param size_t index the index of the block, it must be valid.
+       * @param Block& block the block.
+       * @return bool true, so it can be used in a condition.
+       */
+      bool ReadBlock(size_t index, Block& block) const
+      {
+        // in version 2, the tags are the blocks and the slots the directory.
+        const char* entry = _slots + index * _Binary::column_block_size;
+        const auto offset = _Binary::load_little_endian<unsigned long long>(entry);
+        block.count = std::min(_Compress::block_size, _size - index * _Compress::block_size);
+        block.base = _Binary::load_little_endian<unsigned long long>(entry + 8);
+        block.step = _Binary::load_little_endian<unsigned long long>(entry + 16);
+        block.encoding = static_cast<unsigned char>(entry[24]);
+        block.width = static_cast<unsigned char>(entry[25]);
+        block.tag = static_cast<unsigned char>(entry[26]);
+        const auto uniform = 0 != entry[27];
+
+        size_t slotsSize = 0;
+        switch (block.encoding)
+        {
+        case _Compress::Encoding_Frame:
+          slotsSize = _Compress::packed_size(block.count, block.width);
+          break;
+
+        case _Compress::Encoding_Run:
+          slotsSize = block.step * _Compress::run_size;
+          break;
+
+        default:
+          break;
+        }
+
+        const auto blocksSize = static_cast<unsigned long long>(_slots - _tags);
+        const auto tagsSize = uniform ? 0 : block.count;
+        if (block.width > 64
+          || block.encoding > _Compress::Encoding_Run
+          || (_Compress::Encoding_Run == block.encoding && (0 == block.step || block.step > block.count))
+          || offset > blocksSize
+          || tagsSize + slotsSize > blocksSize - offset)
+        {
+          throw std::runtime_error("The column is corrupted.");
+        }
+        block.tags = uniform ? nullptr : _tags + offset;
+        block.slots = _tags + offset + tagsSize;
+
+        // the last run must end on the last value, or some values would not be in any run.
+        if (_Compress::Encoding_Run == block.encoding && !_Compress::runs_cover(block.slots, static_cast<size_t>(block.step), block.count))
+        {
+          throw std::runtime_error("The column is corrupted.");
+        }
+        return true;
+      }
+
+      /**
+       * Decode all the slots of a block.
+       * @param const Block& block the block.
+       * @param unsigned long long* slots where we write the slots, at least _Compress::block_size of them.
+       */
+      static void DecodeBlock(const Block& block, unsigned long long* slots)
+      {
+        if (_Compress::Encoding_Run == block.encoding)
+        {
+          _Compress::unpack_runs(block.slots, static_cast<size_t>(block.step), block.count, slots);
+          return;
+        }
+        _Compress::unpack_frame(block.slots, block.count, block.width, block.base, block.step, slots);
+      }
+
+      /**
+       * Get the double in a slot.
+       * @param unsigned long long slot the slot.
+       * @return double the number.
+       */
+      static double SlotDouble(unsigned long long slot)
+      {
+        double number;
+        std::memcpy(&number, &slot, sizeof(number));
+        return number;
+      }
+
+      /**
+       * Get where a value is in the heap.
+       * @throw std::runtime_error if the slot is past the heap.
+       * @param unsigned long long slot the slot of the value.
+       * @return const char* where the value is.
+       */
+      const char* HeapAt(unsigned long long slot) const
+      {
+        if (slot >= static_cast<unsigned long long>(_heapEnd - _heap))
+        {
+          throw std::runtime_error("The column is corrupted.");
+        }
+        return _heap + slot;
+      }
+
+      size_t _size;
+      unsigned char _version;
+      const char* _heap;
+      const char* _heapEnd;
+
+      // version 1, the tags and the slots, version 2, the blocks and their directory.
+      const char* _tags;
+      const char* _slots;
+    };
+  }
+}
@@ -0,0 +1,530 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <atomic>         //  std::atomic
+#include <cstddef>        //  size_t
+#include <mutex>          //  std::mutex
+#include <string>
+#include <utility>        //  std::move
+#include <vector>
+
+#include "any.h"          // the values
+
+namespace myodd {
+  namespace dynamic {
+    /**
+     * A hashed map of values that can be read and changed by several threads at the same time.
+     * The keys are spread over shards, each shard has its own lock for the threads changing it,
+     * and the threads reading it never take a lock, they never wait for the threads changing it.
+     * The keys are hashed and compared with the same rules as AnyHash and AnyEqual,
+     * so 12, 12.0 and "12" are the same key, ("12abc" is not the key 12), and a key can be looked for without creating a copy of it,
+     * (map.Find("Something", value), the characters are borrowed).
+     */
+    class AnyConcurrentMap
+    {
+    public:
+      /**
+       * Create the map.
+       * @param size_t shards the number of shards, rounded up to a power of 2, more shards means less waiting between the threads changing the map.
+       */
+      explicit AnyConcurrentMap(size_t shards = 64) :
+        _shards(nullptr),
+        _shardMask(0)
+      {
+        size_t count = 1;
+        while (count < shards)
+        {
+          count <<= 1;
+        }
+        _shards = new Shard[count];
+        _shardMask = count - 1;
+      }
+
+      AnyConcurrentMap(const AnyConcurrentMap&) = delete;
+      AnyConcurrentMap& operator=(const AnyConcurrentMap&) = delete;
+
+      ~AnyConcurrentMap()
+      {
+        delete[] _shards;
+      }
+
+      /**
+       * Add a key and its value, if the key is not in the map already.
+       * @param const Any& key the key.
+       * @param const Any& value the value.
+       * @return bool if the key was added, false if it was already in the map.
+       */
+      bool Insert(const Any& key, const Any& value)
+      {
+        return Write(key, value, false);
+      }
+
+      /**
+       * Add a key and its value, or replace the value if the key is in the map already.
+       * The threads reading the old value at the same time keep their copy of it.
+       * @param const Any& key the key.
+       * @param const Any& value the value.
+       * @return bool if the key was added, false if the value was replaced.
+       */
+      bool Assign(const Any& key, const Any& value)
+      {
+        return Write(key, value, true);
+      }
+
+      /**
+       * Change the value of a key while the other threads changing the shard wait,
+       * if the key is not in the map it is added with a null value first.
+       * The function is given a copy of the value, the value is replaced once the function returns.
+       * For example map.Update("Hits", [](Any& value){ value += 1; });
+       * @param const Any& key the key.
+       * @param Function function the function changing the value, void(Any&)
+       */
+      template<class Function>
+      void Update(const Any& key, Function function)
+      {
+        const auto hash = key.Hash();
+        auto& shard = ShardOf(hash);
+        std::lock_guard<std::mutex> guard(shard._lock);
+        auto table = shard._table.load(std::memory_order_relaxed);
+        auto& bucket = table->buckets[BucketOf(table, hash)];
+        const auto found = FindNode(bucket, hash, key);
+        Any value = found ? found->value : Any();
+        function(value);
+        if (found)
+        {
+          Replace(shard, bucket, found, new Node(hash, found->key, std::move(value)));
+        }
+        else
+        {
+          Add(shard, table, new Node(hash, key, std::move(value)));
+        }
+      }
+
+      /**
+       * Look for a key and copy its value.
+       * @param const K& key the key, a value, characters or a number.
+       * @param Any& value the value of the key, if it is in the map.
+       * @return bool if the key is in the map.
+       */
+      template<class K>
+      bool Find(const K& key, Any& value) const
+      {
+        return Read(KeyOf(key), [&](const Any& found)
+        {
+          value = found;
+        });
+      }
+
+      /**
+       * Check if a key is in the map.
+       * @param const K& key the key, a value, characters or a number.
+       * @return bool if the key is in the map.
+       */
+      template<class K>
+      bool Contains(const K& key) const
+      {
+        return Read(KeyOf(key), [](const Any&)
+        {
+        });
+      }
+
+      /**
+       * Remove a key and its value.
+       * @param const K& key the key, a value, characters or a number.
+       * @return bool if the key was in the map.
+       */
+      template<class K>
+      bool Erase(const K& key)
+      {
+        const Any& lookup = KeyOf(key);
+        const auto hash = lookup.Hash();
+        auto& shard = ShardOf(hash);
+        std::lock_guard<std::mutex> guard(shard._lock);
+        auto table = shard._table.load(std::memory_order_relaxed);
+        auto& bucket = table->buckets[BucketOf(table, hash)];
+        const auto found = FindNode(bucket, hash, lookup);
+        if (nullptr == found)
+        {
+          return false;
+        }
+        Replace(shard, bucket, found, nullptr);
+        shard._size.store(shard._size.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        return true;
+      }
+
+      /**
+       * The number of keys in the map, the other threads might be changing it.
+       * @return size_t the number of keys.
+       */
+      size_t Size() const
+      {
+        size_t size = 0;
+        for (size_t i = 0; i <= _shardMask; ++i)
+        {
+          size += _shards[i]._size.load(std::memory_order_relaxed);
+        }
+        return size;
+      }
+
+    private:
+      /**
+       * A key and its value, once a node can be seen by the readers it is never changed,
+       * other than the next node, changing a value replaces the node.
+       */
+      struct Node
+      {
+        Node(size_t h, const Any& k, Any&& v) :
+          hash(h),
+          key(k),
+          value(std::move(v)),
+          next(nullptr)
+        {
+        }
+
+        Node(size_t h, const Any& k, const Any& v) :
+          hash(h),
+          key(k),
+          value(v),
+          next(nullptr)
+        {
+        }
+
+        const size_t hash;
+        const Any key;
+        const Any value;
+        std::atomic<Node*> next;
+      };
+
+      /**
+       * The buckets of a shard, the table is replaced when it grows.
+       */
+      struct Table
+      {
+        explicit Table(size_t size) :
+          mask(size - 1),
+          buckets(new std::atomic<Node*>[size])
+        {
+          for (size_t i = 0; i < size; ++i)
+          {
+            buckets[i].store(nullptr, std::memory_order_relaxed);
+          }
+        }
+
+        ~Table()
+        {
+          delete[] buckets;
+        }
+
+        const size_t mask;
+        std::atomic<Node*>* const buckets;
+      };
+
+      /**
+       * The nodes and the tables that might still be read, they are deleted
+       * once the readers that could have seen them are gone.
+       */
+      struct Retired
+      {
+        std::vector<Node*> nodes;
+        std::vector<Table*> tables;
+      };
+
+      /**
+       * A shard of the map, the readers let the writers know they are reading in the current epoch,
+       * what is removed is kept until the readers of the epoch it was removed in are gone.
+       */
+      struct Shard
+      {
+        Shard() :
+          _table(new Table(InitialBuckets)),
+          _size(0),
+          _epoch(0)
+        {
+          _readers[0].store(0, std::memory_order_relaxed);
+          _readers[1].store(0, std::memory_order_relaxed);
+        }
+
+        ~Shard()
+        {
+          auto table = _table.load(std::memory_order_relaxed);
+          for (size_t i = 0; i <= table->mask; ++i)
+          {
+            auto node = table->buckets[i].load(std::memory_order_relaxed);
+            while (node)
+            {
+              const auto next = node->next.load(std::memory_order_relaxed);
+              delete node;
+              node = next;
+            }
+          }
+          delete table;
+          Delete(_retired[0]);
+          Delete(_retired[1]);
+        }
+
+        std::atomic<Table*> _table;
+        std::atomic<size_t> _size;
+        std::atomic<size_t> _epoch;
+        std::atomic<size_t> _readers[2];
+
+        // only used by the writers, behind the lock.
+        std::mutex _lock;
+        Retired _retired[2];
+
+        // so 2 shards are not in the same cache line.
+        char _padding[64];
+      };
+
+      static constexpr size_t InitialBuckets = 16;
+
+      static void Delete(Retired& retired)
+      {
+        for (auto node : retired.nodes)
+        {
+          delete node;
+        }
+        for (auto table : retired.tables)
+        {
+          delete table;
+        }
+        retired.nodes.clear();
+        retired.tables.clear();
+      }
+
+      /**
+       * The value we use to look for a key, the characters are borrowed and the numbers are not copied.
+       * @param const K& key the key.
+       * @return Any the key we look for.
+       */
+      static const Any& KeyOf(const Any& key) { return key; }
+      static Any KeyOf(const char* key) { return Any::Borrow(key, nullptr == key ? 0 : std::char_traits<char>::length(key)); }
+      static Any KeyOf(const wchar_t* key) { return Any::Borrow(key, nullptr == key ? 0 : std::char_traits<wchar_t>::length(key)); }
+      static Any KeyOf(const std::string& key) { return Any::Borrow(key.data(), key.size()); }
+      static Any KeyOf(const std::wstring& key) { return Any::Borrow(key.data(), key.size()); }
+#if MYODD_ANY_CPP17
+      static Any KeyOf(std::string_view key) { return Any::Borrow(key.data(), key.size()); }
+      static Any KeyOf(std::wstring_view key) { return Any::Borrow(key.data(), key.size()); }
+#endif
+      template<class T>
+      static std::enable_if_t<std::is_arithmetic<T>::value, Any> KeyOf(const T& key) { return Any(key); }
+
+      Shard& ShardOf(size_t hash) const
+      {
+        return _shards[hash & _shardMask];
+      }
+
+      size_t BucketOf(const Table* table, size_t hash) const
+      {
+        // the lowest bits are used to choose the shard.
+        return (hash / (_shardMask + 1)) & table->mask;
+      }
+
+      static Node* FindNode(const std::atomic<Node*>& bucket, size_t hash, const Any& key)
+      {
+        for (auto node = bucket.load(std::memory_order_acquire); node; node = node->next.load(std::memory_order_acquire))
+        {
+          if (node->hash == hash && AnyEqual()(node->key, key))
+          {
+            return node;
+          }
+        }
+        return nullptr;
+      }
+
+      /**
+       * Look for a key without a lock, the shard knows we are reading so the nodes we see are not deleted.
+       * @param const Any& key the key.
+       * @param Function function called with the value if the key is found.
+       * @return bool if the key was found.
+       */
+      template<class Function>
+      bool Read(const Any& key, Function function) const
+      {
+        const auto hash = key.Hash();
+        auto& shard = ShardOf(hash);
+
+        // let the writers know which epoch we are reading in, if it changed
+        // while we were doing it, we are counted in the epoch it changed to.
+        size_t epoch;
+        for (;;)
+        {
+          epoch = shard._epoch.load();
+          shard._readers[epoch & 1].fetch_add(1);
+          if (shard._epoch.load() == epoch)
+          {
+            break;
+          }
+          shard._readers[epoch & 1].fetch_sub(1);
+        }
+
+        const auto table = shard._table.load();
+        const auto node = FindNode(table->buckets[BucketOf(table, hash)], hash, key);
+        if (node)
+        {
+          function(node->value);
+        }
+        shard._readers[epoch & 1].fetch_sub(1, std::memory_order_release);
+        return nullptr != node;
+      }
+
+      /**
+       * Add or replace a value, behind the lock of the shard.
+       * @param const Any& key the key.
+       * @param const Any& value the value.
+       * @param bool assign if we replace the value when the key is already in the map.
+       * @return bool if the key was added.
+       */
+      bool Write(const Any& key, const Any& value, bool assign)
+      {
+        const auto hash = key.Hash();
+        auto& shard = ShardOf(hash);
+        std::lock_guard<std::mutex> guard(shard._lock);
+        auto table = shard._table.load(std::memory_order_relaxed);
+        auto& bucket = table->buckets[BucketOf(table, hash)];
+        const auto found = FindNode(bucket, hash, key);
+        if (found)
+        {
+          if (assign)
+          {
+            Replace(shard, bucket, found, new Node(hash, found->key, value));
+          }
+          return false;
+        }
+        Add(shard, table, new Node(hash, key, value));
+        return true;
+      }
+
+      /**
+       * Add a node at the front of its bucket, the caller has the lock of the shard.
+       * @param Shard& shard the shard.
+       * @param Table* table the current table of the shard.
+       * @param Node* node the new node.
+       */
+      void Add(Shard& shard, Table* table, Node* node)
+      {
+        const auto size = shard._size.load(std::memory_order_relaxed) + 1;
+        if (size > table->mask + 1)
+        {
+          table = Grow(shard, table);
+        }
+
+        auto& bucket = table->buckets[BucketOf(table, node->hash)];
+        node->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        bucket.store(node, std::memory_order_release);
+        shard._size.store(size, std::memory_order_relaxed);
+      }
+
+      /**
+       * Replace a node with another one, or remove it, the caller has the lock of the shard.
+       * The readers that are on the old node can still carry on to the nodes after it.
+       * @param Shard& shard the shard.
+       * @param std::atomic<Node*>& bucket the bucket of the node.
+       * @param Node* node the node we are replacing.
+       * @param Node* replacement the new node, or nullptr to remove it.
+       */
+      void Replace(Shard& shard, std::atomic<Node*>& bucket, Node* node, Node* replacement)
+      {
+        const auto next = node->next.load(std::memory_order_relaxed);
+        if (replacement)
+        {
+          replacement->next.store(next, std::memory_order_relaxed);
+        }
+
+        auto link = &bucket;
+        while (link->load(std::memory_order_relaxed) != node)
+        {
+          link = &link->load(std::memory_order_relaxed)->next;
+        }
+        link->store(replacement ? replacement : next);
+        Retire(shard, node, nullptr);
+      }
+
+      /**
+       * Double the number of buckets, the nodes are copied to the new table, so the readers
+       * of the old table are not affected, the caller has the lock of the shard.
+       * @param Shard& shard the shard.
+       * @param Table* table the current table.
+       * @return Table* the new table.
+       */
+      Table* Grow(Shard& shard, Table* table)
+      {
+        auto grown = new Table((table->mask + 1) * 2);
+        std::vector<Node*> nodes;
+        for (size_t i = 0; i <= table->mask; ++i)
+        {
+          for (auto node = table->buckets[i].load(std::memory_order_relaxed); node; node = node->next.load(std::memory_order_relaxed))
+          {
+            auto copy = new Node(node->hash, node->key, node->value);
+            auto& bucket = grown->buckets[BucketOf(grown, copy->hash)];
+            copy->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            bucket.store(copy, std::memory_order_relaxed);
+            nodes.push_back(node);
+          }
+        }
+        shard._table.store(grown);
+
+        for (auto node : nodes)
+        {
+          shard._retired[shard._epoch.load(std::memory_order_relaxed) & 1].nodes.push_back(node);
+        }
+        Retire(shard, nullptr, table);
+        return grown;
+      }
+
+      /**
+       * Keep a node, or a table, until the readers that could have seen it are gone, the caller has the lock of the shard.
+       * What was removed in the previous epoch is deleted once its readers are gone, and the epoch moves on.
+       * @param Shard& shard the shard.
+       * @param Node* node the node we removed, or nullptr.
+       * @param Table* table the table we replaced, or nullptr.
+       */
+      static void Retire(Shard& shard, Node* node, Table* table)
+      {
+        const auto epoch = shard._epoch.load(std::memory_order_relaxed);
+        auto& current = shard._retired[epoch & 1];
+        if (node)
+        {
+          current.nodes.push_back(node);
+        }
+        if (table)
+        {
+          current.tables.push_back(table);
+        }
+
+        // the readers of the previous epoch were all counted before what we removed then could be seen,
+        // once they are gone nobody can see it anymore, and new readers can use their counter again.
+        if (0 == shard._readers[(epoch + 1) & 1].load())
+        {
+          Delete(shard._retired[(epoch + 1) & 1]);
+          shard._epoch.store(epoch + 1);
+        }
+      }
+
+      Shard* _shards;
+      size_t _shardMask;
+    };
+  }
+}
@@ -0,0 +1,235 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <cstddef>        //  size_t
+#include <stdexcept>      //  std::runtime_error
+#include <string>
+#include <vector>
+
+#include "any.h"          // the values
+#include "csv.h"          // comma separated values
+#include "descriptor.h"   // file descriptors
+
+namespace myodd {
+  namespace dynamic {
+    /**
+     * Read rows of comma separated values, (RFC 4180), from a buffer or from a file descriptor.
+     * Quoted fields can contain delimiters, new lines and quotes, (written twice), lines can end with "\n" or "\r\n".
+     * Each field is a string value, numbers are worked out as we copy the characters, so "12" is a string
+     * that is also the number 12, the same as Any("12").
+     */
+    class AnyCsvReader
+    {
+    public:
+      /**
+       * Read the rows from a buffer.
+       * @param const char* data the data, it must outlive the reader.
+       * @param size_t len the size of the data.
+       * @param char delimiter the delimiter between the fields.
+       */
+      AnyCsvReader(const char* data, size_t len, char delimiter = ',') :
+        _source(data),
+        _end(data + len),
+        _delimiter(delimiter),
+        _quoted(false)
+      {
+      }
+
+      /**
+       * Read the rows from a file descriptor, a large block at a time.
+       * @param int fd the file descriptor, it is not closed by the reader.
+       * @param char delimiter the delimiter between the fields.
+       */
+      explicit AnyCsvReader(int fd, char delimiter = ',') :
+        _reader(fd, ReadSize),
+        _source(nullptr),
+        _end(nullptr),
+        _delimiter(delimiter),
+        _quoted(false)
+      {
+      }
+
+      AnyCsvReader(const AnyCsvReader&) = delete;
+      AnyCsvReader& operator=(const AnyCsvReader&) = delete;
+
+      /**
+       * Read the next row, the values already in the row are reused.
+       * An empty line is a row with one empty field.
+       * @throw std::runtime_error if a quoted field is not closed.
+       * @param std::vector<Any>& row the values of the row.
+       * @return bool false if there are no more rows.
+       */
+      bool Read(std::vector<Any>& row)
+      {
+        while (_source == _end)
+        {
+          if (!Fill(_source))
+          {
+            return false;
+          }
+        }
+
+        size_t count = 0;
+        for (;;)
+        {
+          // read the whole field, if we reach the end of the data, get more and read it again.
+          const char* start = _source;
+          const char* fieldEnd = (start != _end && *start == _Csv::quote) ? ReadQuotedField() : _Csv::find_field_end(start, _end, _delimiter);
+          if (nullptr == fieldEnd || (fieldEnd == _end && Fill(start)))
+          {
+            continue;
+          }
+
+          if (count == row.size())
+          {
+            row.emplace_back();
+          }
+          SetField(row[count++], start, fieldEnd);
+
+          // the field ends with a delimiter, the end of the line or the end of the data.
+          _source = fieldEnd;
+          if (_source == _end)
+          {
+            break;
+          }
+          const auto c = *_source++;
+          if (c == _delimiter)
+          {
+            continue;
+          }
+          if (c == '\r')
+          {
+            if (_source == _end)
+            {
+              Fill(_source);
+            }
+            if (_source != _end && *_source == '\n')
+            {
+              ++_source;
+            }
+          }
+          break;
+        }
+
+        row.resize(count);
+        return true;
+      }
+
+    private:
+      /**
+       * Read a quoted field, the characters, (without the quotes), are in _field.
+       * @return const char* the end of the field, (past the closing quote and anything up to the delimiter),
+       *                     or nullptr if we had to read more data and must read the field again.
+       */
+      const char* ReadQuotedField()
+      {
+        const char* start = _source;
+        _field.clear();
+        _quoted = true;
+        const char* it = _source + 1;
+        for (;;)
+        {
+          const char* quote = _Csv::find_quote(it, _end);
+          if (quote == _end || quote + 1 == _end)
+          {
+            // we need to know what is after the quote, and the closing quote must be in the data.
+            if (Fill(start))
+            {
+              return nullptr;
+            }
+            if (quote == _end)
+            {
+              throw std::runtime_error("The quoted field is not closed.");
+            }
+          }
+          _field.append(it, quote);
+          it = quote + 1;
+          if (it != _end && *it == _Csv::quote)
+          {
+            // a quote written twice is one quote.
+            _field += _Csv::quote;
+            ++it;
+            continue;
+          }
+
+          // anything between the closing quote and the delimiter is kept as it is.
+          const char* fieldEnd = _Csv::find_field_end(it, _end, _delimiter);
+          if (fieldEnd == _end && Fill(start))
+          {
+            return nullptr;
+          }
+          _field.append(it, fieldEnd);
+          return fieldEnd;
+        }
+      }
+
+      /**
+       * Set a value to the characters of a field.
+       * @param Any& value the value we are setting.
+       * @param const char* start the start of the field.
+       * @param const char* end the end of the field.
+       */
+      void SetField(Any& value, const char* start, const char* end)
+      {
+        if (_quoted)
+        {
+          value.AssignCharacters(_field.data(), _field.size());
+          _quoted = false;
+          return;
+        }
+        value.AssignCharacters(start, static_cast<size_t>(end - start));
+      }
+
+      /**
+       * Read more data from the file descriptor, after what we have not used yet.
+       * @param const char* from where the data we have not used yet starts, it is moved to the start of the buffer.
+       * @return bool true if the data was moved, (we must read it again), false if there is nothing more to read.
+       */
+      bool Fill(const char* from)
+      {
+        if (!_reader.CanRead())
+        {
+          return false;
+        }
+        _source = from;
+        _reader.Fill(_source, _end);
+        return true;
+      }
+
+      // how much we read from the file descriptor at a time.
+      static constexpr size_t ReadSize = 1024 * 1024;
+
+      _Descriptor::Reader _reader;
+      const char* _source;
+      const char* _end;
+      const char _delimiter;
+
+      // the characters of the last quoted field, without the quotes.
+      std::string _field;
+      bool _quoted;
+    };
+  }
+}
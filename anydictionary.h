@@ -0,0 +1,317 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <algorithm>      //  std::count
+#include <cstddef>        //  size_t
+#include <cstring>        //  std::memcmp
+#include <deque>          //  std::deque
+#include <stdexcept>      //  std::runtime_error / std::out_of_range
+#include <string>
+#include <unordered_map>  //  std::unordered_map
+#include <vector>
+
+#include "any.h"          // the values
+
+namespace myodd {
+  namespace dynamic {
+    /**
+     * A column of strings with few distinct values, (country codes, statuses and so on), each distinct string
+     * is kept once in a dictionary and each row only holds the code of its string.
+     * The strings are compared as characters, "12" and "12.0" are 2 different strings.
+     * Comparing and grouping the rows is done on the codes, the values we return borrow their characters
+     * from the dictionary, so they must not outlive the column.
+     */
+    class AnyDictionaryColumn
+    {
+    public:
+      /**
+       * The code of a string in the dictionary, they start at 0 and follow the order the strings were added.
+       */
+      typedef unsigned int Code;
+
+      /**
+       * The code of a null value, it is not in the dictionary.
+       * An enumerator rather than a static member, so it can be bound to a reference without a definition before c++17.
+       */
+      enum : Code { NullCode = 0xffffffffu };
+
+      AnyDictionaryColumn()
+      {
+      }
+
+      AnyDictionaryColumn(const AnyDictionaryColumn&) = delete;
+      AnyDictionaryColumn& operator=(const AnyDictionaryColumn&) = delete;
+
+      /**
+       * Add a value to the column, the string is added to the dictionary the first time we see it.
+       * Wide strings are kept as utf-8.
+       * @throw std::runtime_error if the value is not a string or null, or there are too many distinct strings.
+       * @param const Any& value the value we are adding.
+       * @return Code the code of the value.
+       */
+      Code Add(const Any& value)
+      {
+        if (dynamic::is_type_null(value.Type()))
+        {
+          _codes.push_back(NullCode);
+          return NullCode;
+        }
+
+        const auto key = KeyOf(value, _scratch);
+        const auto it = _lookup.find(key);
+        if (it != _lookup.end())
+        {
+          _codes.push_back(it->second);
+          return it->second;
+        }
+
+        if (_strings.size() >= NullCode)
+        {
+          throw std::runtime_error("There are too many distinct strings in the column.");
+        }
+
+        // the deque never moves the strings, so the key can point to the characters we keep.
+        const auto code = static_cast<Code>(_strings.size());
+        _strings.emplace_back(key.characters, key.length);
+        _lookup.emplace(Key{ _strings.back().data(), key.length, key.hash }, code);
+        _codes.push_back(code);
+        return code;
+      }
+
+      /**
+       * The number of rows in the column.
+       * @return size_t the number of rows.
+       */
+      size_t Size() const
+      {
+        return _codes.size();
+      }
+
+      /**
+       * The number of distinct strings in the dictionary.
+       * @return size_t the number of strings.
+       */
+      size_t DictionarySize() const
+      {
+        return _strings.size();
+      }
+
+      /**
+       * The codes of all the rows, in order.
+       * @return const std::vector<Code>& the codes.
+       */
+      const std::vector<Code>& Codes() const
+      {
+        return _codes;
+      }
+
+      /**
+       * Get the code of a string without adding it.
+       * @param const Any& value the string we are looking for.
+       * @param Code& code the code, NullCode if the value is null.
+       * @return bool false if the string is not in the dictionary, (or the value is not a string).
+       */
+      bool Find(const Any& value, Code& code) const
+      {
+        if (dynamic::is_type_null(value.Type()))
+        {
+          code = NullCode;
+          return true;
+        }
+        if (!dynamic::is_type_character(value.Type()))
+        {
+          return false;
+        }
+
+        std::string scratch;
+        const auto it = _lookup.find(KeyOf(value, scratch));
+        if (it == _lookup.end())
+        {
+          return false;
+        }
+        code = it->second;
+        return true;
+      }
+
+      /**
+       * Get the string of a code, the value borrows its characters from the dictionary.
+       * @throw std::out_of_range if the code is not in the dictionary.
+       * @param Code code the code.
+       * @return Any the string, or a null value.
+       */
+      Any Decode(Code code) const
+      {
+        if (NullCode == code)
+        {
+          return Any();
+        }
+        if (code >= _strings.size())
+        {
+          throw std::out_of_range("The code is not in the dictionary.");
+        }
+        const auto& characters = _strings[code];
+        return Any::Borrow(characters.data(), characters.size());
+      }
+
+      /**
+       * Get the value of a row, the value borrows its characters from the dictionary.
+       * @throw std::out_of_range if the index is past the last row.
+       * @param size_t index the index of the row.
+       * @return Any the value.
+       */
+      Any operator[](size_t index) const
+      {
+        if (index >= _codes.size())
+        {
+          throw std::out_of_range("The index is past the last value.");
+        }
+        return Decode(_codes[index]);
+      }
+
+      /**
+       * Count the rows that are equal to a string, the string is looked up once and then only the codes are compared.
+       * @param const Any& value the string we are looking for.
+       * @return size_t the number of rows.
+       */
+      size_t CountEqual(const Any& value) const
+      {
+        Code code;
+        if (!Find(value, code))
+        {
+          return 0;
+        }
+        return static_cast<size_t>(std::count(_codes.begin(), _codes.end(), code));
+      }
+
+      /**
+       * Get the rows that are equal to a string.
+       * @see CountEqual( ... )
+       * @param const Any& value the string we are looking for.
+       * @param std::vector<size_t>& rows the index of each row, in order, what was there is removed.
+       */
+      void FindEqual(const Any& value, std::vector<size_t>& rows) const
+      {
+        rows.clear();
+        Code code;
+        if (!Find(value, code))
+        {
+          return;
+        }
+        for (size_t i = 0; i < _codes.size(); ++i)
+        {
+          if (_codes[i] == code)
+          {
+            rows.push_back(i);
+          }
+        }
+      }
+
+      /**
+       * Count the rows of each string, (group by), the index of each count is the code of the string.
+       * @param std::vector<size_t>& counts the number of rows for each code, what was there is removed.
+       * @return size_t the number of null rows, (they do not have a code in the dictionary).
+       */
+      size_t GroupCount(std::vector<size_t>& counts) const
+      {
+        counts.assign(_strings.size() + 1, 0);
+
+        // the null code wraps around to the last count.
+        for (const auto code : _codes)
+        {
+          ++counts[static_cast<Code>(code + 1)];
+        }
+        const auto nulls = counts[0];
+        counts.erase(counts.begin());
+        return nulls;
+      }
+
+    private:
+      /**
+       * The characters of a string in the dictionary, or of a string we are looking for.
+       */
+      struct Key
+      {
+        const char* characters;
+        size_t length;
+        size_t hash;
+
+        bool operator==(const Key& other) const
+        {
+          return length == other.length && 0 == std::memcmp(characters, other.characters, length);
+        }
+      };
+
+      struct KeyHash
+      {
+        size_t operator()(const Key& key) const
+        {
+          return key.hash;
+        }
+      };
+
+      /**
+       * Get the characters of a string, the wide strings are converted to utf-8.
+       * @throw std::runtime_error if the value is not a string.
+       * @param const Any& value the string.
+       * @param std::string& scratch where we convert the wide strings.
+       * @return Key the characters, they point to the value, or to the scratch string.
+       */
+      static Key KeyOf(const Any& value, std::string& scratch)
+      {
+        const char* characters;
+        size_t length;
+        switch (value.Type())
+        {
+        case dynamic::Character_char:
+        case dynamic::Character_signed_char:
+        case dynamic::Character_unsigned_char:
+          characters = nullptr == value._cvalue ? "" : value._cvalue;
+          length = nullptr == value._cvalue ? 0 : value.CharactersLength<char>();
+          break;
+
+        case dynamic::Character_wchar_t:
+          value.CreateString(scratch);
+          characters = scratch.data();
+          length = scratch.size();
+          break;
+
+        default:
+          throw std::runtime_error("Only strings can be added to a dictionary column.");
+        }
+        return Key{ characters, length, static_cast<size_t>(dynamic::hash_bytes(characters, length)) };
+      }
+
+      // the code of each row.
+      std::vector<Code> _codes;
+
+      // the distinct strings, in the order of their codes, and their codes.
+      std::deque<std::string> _strings;
+      std::unordered_map<Key, Code, KeyHash> _lookup;
+
+      std::string _scratch;
+    };
+  }
+}
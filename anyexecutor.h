@@ -0,0 +1,487 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <algorithm>      //  std::sort / std::inplace_merge
+#include <atomic>         //  std::atomic
+#include <cstddef>        //  size_t
+#include <iterator>       //  std::iterator_traits / std::back_inserter
+#include <memory>         //  std::unique_ptr
+#include <stdexcept>      //  std::runtime_error
+#include <string>
+#include <thread>         //  std::thread::hardware_concurrency
+#include <vector>
+
+#include "any.h"          // the values
+#include "anycolumn.h"    // columns of values
+#include "anytokenizer.h" // whitespace separated tokens
+#include "executor.h"     // work stealing threads
+
+namespace myodd {
+  namespace dynamic {
+    /**
+     * Run loops over values, columns and ranges of indexes on several threads, (@see _Executor::Pool).
+     * The range is split in parts of at most the grain size, and the idle threads steal the parts that are left,
+     * so the parts do not all need to take the same time. The grain only depends on the size of the loop,
+     * so the sums and the reductions do not depend on the number of threads. The thread calling the loop runs parts as well,
+     * and a loop can be run from inside another loop.
+     * The sorting, aggregation, parsing and serialization helpers use the same threads, use Default() to share them.
+     */
+    class AnyExecutor
+    {
+    public:
+      /**
+       * Create the threads.
+       * @param size_t threads the number of threads running the loops, including the thread calling them, 0 for one per core.
+       * @param size_t grain the largest number of values in one part, 0 to cut the loop in 256 parts.
+       */
+      explicit AnyExecutor(size_t threads = 0, size_t grain = 0) :
+        _pool(0 != threads ? threads : HardwareThreads()),
+        _grain(grain)
+      {
+      }
+
+      AnyExecutor(const AnyExecutor&) = delete;
+      AnyExecutor& operator=(const AnyExecutor&) = delete;
+
+      /**
+       * The executor shared by everything that does not need its own, with one thread per core.
+       * @return AnyExecutor& the shared executor.
+       */
+      static AnyExecutor& Default()
+      {
+        static AnyExecutor executor;
+        return executor;
+      }
+
+      /**
+       * The number of threads running the loops, including the thread calling them.
+       * @return size_t the number of threads.
+       */
+      size_t Threads() const
+      {
+        return _pool.Size();
+      }
+
+      /**
+       * The largest number of values in one part, 0 if it is worked out from the size of the loop.
+       * @return size_t the grain size.
+       */
+      size_t GrainSize() const
+      {
+        return _grain.load(std::memory_order_relaxed);
+      }
+
+      /**
+       * Set the largest number of values in one part, smaller parts share the work better,
+       * larger ones cost less to hand over to another thread.
+       * @param size_t grain the grain size, 0 to work it out from the size of the loop.
+       */
+      void SetGrainSize(size_t grain)
+      {
+        _grain.store(grain, std::memory_order_relaxed);
+      }
+
+      /**
+       * Call a function for parts of a range of indexes, on several threads.
+       * @throw the first exception thrown by the function, once all the parts are done.
+       * @param size_t begin the first index.
+       * @param size_t end one past the last index.
+       * @param Function function called with each part, void(size_t begin, size_t end)
+       */
+      template<class Function>
+      void ParallelFor(size_t begin, size_t end, Function function)
+      {
+        For(begin, end, Grain(end - begin, 1), 1, function);
+      }
+
+      /**
+       * Work out a value for parts of a range of indexes, on several threads, and combine them.
+       * The parts are always combined in the same order, from the first to the last, (floating points are added in the same order).
+       * @throw the first exception thrown by the functions, once all the parts are done.
+       * @param size_t begin the first index.
+       * @param size_t end one past the last index.
+       * @param const T& identity the value we start from, and the result if the range is empty.
+       * @param Map map works out the value of a part, T(size_t begin, size_t end)
+       * @param Combine combine combines 2 values, T(const T&, const T&)
+       * @return T the combined value.
+       */
+      template<class T, class Map, class Combine>
+      T ParallelReduce(size_t begin, size_t end, const T& identity, Map map, Combine combine)
+      {
+        return Reduce(begin, end, Grain(end - begin, 1), identity, map, combine);
+      }
+
+      /**
+       * Call a function for each value of a range, on several threads.
+       * @param Iterator first the first value, (a random access iterator).
+       * @param Iterator last one past the last value.
+       * @param Function function called with each value, void(Any&), (or void(const Any&)).
+       */
+      template<class Iterator, class Function>
+      void ParallelForEach(Iterator first, Iterator last, Function function)
+      {
+        ParallelFor(0, static_cast<size_t>(last - first), [&](size_t begin, size_t end)
+        {
+          for (auto it = Advance(first, begin); it != Advance(first, end); ++it)
+          {
+            function(*it);
+          }
+        });
+      }
+
+      /**
+       * Call a function for parts of a column, on several threads, the parts start and end
+       * on the blocks of the column, so each block is only decoded once.
+       * For example column.Integers(begin, end - begin, values) for each part.
+       * @param const AnyColumn& column the column.
+       * @param Function function called with each part, void(size_t begin, size_t end)
+       */
+      template<class Function>
+      void ParallelFor(const AnyColumn& column, Function function)
+      {
+        const auto size = column.Size();
+        For(0, size, Grain(size, _Compress::block_size), _Compress::block_size, function);
+      }
+
+      /**
+       * Work out a value for parts of a column, on several threads, and combine them, (@see ParallelFor( const AnyColumn&, ... )).
+       * @param const AnyColumn& column the column.
+       * @param const T& identity the value we start from, and the result if the column is empty.
+       * @param Map map works out the value of a part, T(size_t begin, size_t end)
+       * @param Combine combine combines 2 values, T(const T&, const T&)
+       * @return T the combined value.
+       */
+      template<class T, class Map, class Combine>
+      T ParallelReduce(const AnyColumn& column, const T& identity, Map map, Combine combine)
+      {
+        const auto size = column.Size();
+        return Reduce(0, size, Grain(size, _Compress::block_size), identity, map, combine);
+      }
+
+      /**
+       * Sort values, on several threads, each part is sorted and then the parts are merged.
+       * @param Iterator first the first value, (a random access iterator).
+       * @param Iterator last one past the last value.
+       * @param Compare compare the comparator, AnyLess by default, (the same rules as operator<).
+       */
+      template<class Iterator, class Compare = AnyLess>
+      void Sort(Iterator first, Iterator last, Compare compare = Compare())
+      {
+        const auto count = static_cast<size_t>(last - first);
+        const auto grain = Grain(count, 1);
+        const auto parts = (count + grain - 1) / grain;
+        For(0, parts, 1, 1, [&](size_t begin, size_t end)
+        {
+          for (auto part = begin; part < end; ++part)
+          {
+            std::sort(Advance(first, part * grain), Advance(first, std::min(count, (part + 1) * grain)), compare);
+          }
+        });
+
+        // merge the sorted parts 2 by 2, the last merges are done by fewer threads.
+        for (auto width = grain; width < count; width *= 2)
+        {
+          const auto pairs = (count + 2 * width - 1) / (2 * width);
+          For(0, pairs, 1, 1, [&](size_t begin, size_t end)
+          {
+            for (auto pair = begin; pair < end; ++pair)
+            {
+              const auto low = pair * 2 * width;
+              const auto middle = std::min(count, low + width);
+              const auto high = std::min(count, low + 2 * width);
+              std::inplace_merge(Advance(first, low), Advance(first, middle), Advance(first, high), compare);
+            }
+          });
+        }
+      }
+
+      /**
+       * Add values, on several threads, with the same rules as operator+=, (int + double is a double).
+       * @param Iterator first the first value, (a random access iterator).
+       * @param Iterator last one past the last value.
+       * @return Any the total, null if there are no values.
+       */
+      template<class Iterator>
+      Any Sum(Iterator first, Iterator last)
+      {
+        return ParallelReduce(0, static_cast<size_t>(last - first), Any(), [&](size_t begin, size_t end)
+        {
+          Any total;
+          for (auto it = Advance(first, begin); it != Advance(first, end); ++it)
+          {
+            total += *it;
+          }
+          return total;
+        },
+        [](const Any& lhs, const Any& rhs)
+        {
+          return lhs + rhs;
+        });
+      }
+
+      /**
+       * Serialize values, on several threads, each part is written to its own buffer
+       * and the buffers are joined in order, the same as calling Any::Serialize( ... ) for each value.
+       * @throw std::runtime_error if a value is a copy of an object, we cannot write those.
+       * @param Iterator first the first value, (a random access iterator).
+       * @param Iterator last one past the last value.
+       * @return std::string the values, one after the other.
+       */
+      template<class Iterator>
+      std::string Serialize(Iterator first, Iterator last)
+      {
+        const auto count = static_cast<size_t>(last - first);
+        const auto grain = Grain(count, 1);
+        std::vector<std::string> buffers((count + grain - 1) / grain);
+        For(0, buffers.size(), 1, 1, [&](size_t begin, size_t end)
+        {
+          for (auto part = begin; part < end; ++part)
+          {
+            for (auto it = Advance(first, part * grain); it != Advance(first, std::min(count, (part + 1) * grain)); ++it)
+            {
+              it->Serialize(buffers[part]);
+            }
+          }
+        });
+        return Join(buffers);
+      }
+
+      /**
+       * Read whitespace separated tokens, on several threads, (@see AnyTokenizer).
+       * The data is split on the spaces, so a token is never split between 2 parts.
+       * @param const char* data the data.
+       * @param size_t len the size of the data.
+       * @return std::vector<Any> the tokens, in order.
+       */
+      std::vector<Any> Tokenize(const char* data, size_t len)
+      {
+        // a part is at least a page of characters.
+        const auto grain = std::max<size_t>(Grain(len, 1), 4096);
+        std::vector<size_t> starts;
+        for (size_t start = 0; start < len; start += grain)
+        {
+          // move the start past the token we are in.
+          while (start < len && start > 0 && !_Token::is_space(data[start - 1]))
+          {
+            ++start;
+          }
+          if (starts.empty() || start > starts.back())
+          {
+            starts.push_back(start);
+          }
+        }
+        starts.push_back(len);
+
+        std::vector<std::vector<Any>> parts(starts.size() - 1);
+        For(0, parts.size(), 1, 1, [&](size_t begin, size_t end)
+        {
+          for (auto part = begin; part < end; ++part)
+          {
+            AnyTokenizer tokenizer(data + starts[part], starts[part + 1] - starts[part]);
+            Any token;
+            while (tokenizer.Read(token))
+            {
+              parts[part].push_back(token);
+            }
+          }
+        });
+        return Join(parts);
+      }
+
+    private:
+      /**
+       * Call a function for a part of a range, the part is split in 2 until it is no larger than the grain,
+       * the second half is given to the other threads and we carry on with the first half.
+       */
+      template<class Function>
+      class ForTask : public _Executor::Task
+      {
+      public:
+        ForTask(_Executor::Group& group, _Executor::Pool& pool, size_t begin, size_t end, size_t grain, size_t align, Function& function) :
+          _Executor::Task(group),
+          _pool(pool),
+          _begin(begin),
+          _end(end),
+          _grain(grain),
+          _align(align),
+          _function(function)
+        {
+        }
+
+      protected:
+        void Execute() override
+        {
+          while (_end - _begin > _grain)
+          {
+            // the halves start on a multiple of the alignment, (the blocks of a column).
+            auto half = (_end - _begin) / 2 / _align * _align;
+            half = 0 == half ? _align : half;
+            std::unique_ptr<ForTask> task(new ForTask(_group, _pool, _begin + half, _end, _grain, _align, _function));
+            _group.Add();
+            try
+            {
+              _pool.Push(task.get());
+            }
+            catch (...)
+            {
+              _group.Done();
+              throw;
+            }
+            task.release();
+            _end = _begin + half;
+          }
+          _function(_begin, _end);
+        }
+
+      private:
+        _Executor::Pool& _pool;
+        size_t _begin;
+        size_t _end;
+        const size_t _grain;
+        const size_t _align;
+        Function& _function;
+      };
+
+      /**
+       * Move an iterator forward, the offset is the difference type of the iterator
+       * so it is not mistaken for an Any we are adding to the value.
+       * @param Iterator first the iterator.
+       * @param size_t offset how far we move it.
+       * @return Iterator the iterator we moved.
+       */
+      template<class Iterator>
+      static Iterator Advance(Iterator first, size_t offset)
+      {
+        return first + static_cast<typename std::iterator_traits<Iterator>::difference_type>(offset);
+      }
+
+      static size_t HardwareThreads()
+      {
+        const auto threads = std::thread::hardware_concurrency();
+        return 0 == threads ? 1 : threads;
+      }
+
+      /**
+       * The size of the parts of a loop.
+       * @param size_t count the number of values in the loop.
+       * @param size_t align the parts are a multiple of it.
+       * @return size_t the grain size.
+       */
+      size_t Grain(size_t count, size_t align) const
+      {
+        // the same parts whatever the number of threads, enough for the threads that finish first to steal some.
+        auto grain = GrainSize();
+        if (0 == grain)
+        {
+          grain = count / AutoParts;
+        }
+        grain = std::max<size_t>(grain, 1);
+        return (grain + align - 1) / align * align;
+      }
+
+      template<class Function>
+      void For(size_t begin, size_t end, size_t grain, size_t align, Function function)
+      {
+        if (begin >= end)
+        {
+          return;
+        }
+
+        // the task is created before it is added to the group, so we never wait for a task that does not exist.
+        _Executor::Group group;
+        auto task = new ForTask<Function>(group, _pool, begin, end, grain, align, function);
+        group.Add();
+        task->Run();
+        _pool.Wait(group);
+        group.Rethrow();
+      }
+
+      template<class T, class Map, class Combine>
+      T Reduce(size_t begin, size_t end, size_t grain, const T& identity, Map& map, Combine& combine)
+      {
+        if (begin >= end)
+        {
+          return identity;
+        }
+
+        const auto count = end - begin;
+        std::vector<T> results((count + grain - 1) / grain, identity);
+        For(0, results.size(), 1, 1, [&](size_t first, size_t last)
+        {
+          for (auto part = first; part < last; ++part)
+          {
+            results[part] = map(begin + part * grain, std::min(end, begin + (part + 1) * grain));
+          }
+        });
+
+        auto result = identity;
+        for (const auto& value : results)
+        {
+          result = combine(result, value);
+        }
+        return result;
+      }
+
+      static std::string Join(const std::vector<std::string>& buffers)
+      {
+        size_t size = 0;
+        for (const auto& buffer : buffers)
+        {
+          size += buffer.size();
+        }
+        std::string joined;
+        joined.reserve(size);
+        for (const auto& buffer : buffers)
+        {
+          joined += buffer;
+        }
+        return joined;
+      }
+
+      static std::vector<Any> Join(std::vector<std::vector<Any>>& parts)
+      {
+        size_t size = 0;
+        for (const auto& part : parts)
+        {
+          size += part.size();
+        }
+        std::vector<Any> joined;
+        joined.reserve(size);
+        for (auto& part : parts)
+        {
+          std::move(part.begin(), part.end(), std::back_inserter(joined));
+        }
+        return joined;
+      }
+
+      // the number of parts of a loop when the grain size is not set.
+      static constexpr size_t AutoParts = 256;
+
+      _Executor::Pool _pool;
+      std::atomic<size_t> _grain;
+    };
+  }
+}
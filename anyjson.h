@@ -0,0 +1,953 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <algorithm>      //  std::find_if
+#include <cmath>          //  std::isfinite
+#include <cstddef>        //  size_t
+#include <cstdlib>        //  std::strtold
+#include <cstring>        //  std::memcmp
+#include <limits>         //  std::numeric_limits
+#include <stdexcept>      //  std::runtime_error
+#include <string>
+#include <utility>        //  std::move / std::pair
+#include <vector>
+
+#include "any.h"          // the values
+#include "descriptor.h"   // file descriptors
+#include "json.h"         // json documents
+
+namespace myodd {
+  namespace dynamic {
+    /**
+     * The arrays and the objects of a JSON document, (@see AnyJsonReader), they are held in a value as a copy.
+     * The objects keep their keys in the order they were read, the keys are strings.
+     *   if (value.IsCopyOf<AnyJsonArray>()) { const AnyJsonArray* items = value; ... }
+     */
+    typedef std::vector<Any> AnyJsonArray;
+    typedef std::vector<std::pair<Any, Any>> AnyJsonObject;
+
+    /**
+     * Read JSON documents, (RFC 8259), from a buffer or from a file descriptor.
+     * A stream can have more than one document, separated by spaces, (one per line for example)
+     * The numbers without decimals or exponents are long long, (or unsigned long long if they are too big),
+     * the others are long double, the same as the numbers of a string, @see Any::NumberType()
+     * The strings are utf-8 with the escapes decoded.
+     *
+     * The handler of Read( ... ) is called for each part of the document as we read it,
+     *   void StartArray() / void EndArray()
+     *   void StartObject() / void EndObject()
+     *   void Key(const Any& key)
+     *   void Value(const Any& value)
+     * The keys and the values are only valid during the call, copy them to keep them.
+     */
+    class AnyJsonReader
+    {
+    public:
+      /**
+       * Read the documents from a buffer.
+       * @param const char* data the data, it must outlive the reader.
+       * @param size_t len the size of the data.
+       */
+      AnyJsonReader(const char* data, size_t len) :
+        _source(data),
+        _end(data + len)
+      {
+      }
+
+      /**
+       * Read the documents from a file descriptor, a large block at a time.
+       * @param int fd the file descriptor, it is not closed by the reader.
+       */
+      explicit AnyJsonReader(int fd) :
+        _reader(fd, ReadSize),
+        _source(nullptr),
+        _end(nullptr)
+      {
+      }
+
+      AnyJsonReader(const AnyJsonReader&) = delete;
+      AnyJsonReader& operator=(const AnyJsonReader&) = delete;
+
+      /**
+       * Read the next document and call the handler for each part of it.
+       * @throw std::runtime_error if the document is not valid, or it is truncated.
+       * @param Handler& handler the handler, @see AnyJsonReader
+       * @return bool false if there are no more documents.
+       */
+      template<class Handler>
+      bool Read(Handler& handler)
+      {
+        if (!SkipSpaces())
+        {
+          return false;
+        }
+
+        _containers.clear();
+        for (;;)
+        {
+          // we are expecting a value.
+          ExpectToken();
+          const auto c = *_source;
+          if (c == '[' || c == '{')
+          {
+            ++_source;
+            _containers += c;
+            if (c == '[')
+            {
+              handler.StartArray();
+            }
+            else
+            {
+              handler.StartObject();
+            }
+
+            ExpectToken();
+            if (*_source != (c == '[' ? ']' : '}'))
+            {
+              if (c == '{')
+              {
+                ReadKey(handler);
+              }
+              continue;
+            }
+          }
+          else
+          {
+            ReadScalar();
+            handler.Value(_value);
+          }
+
+          // after a value, there is another value or the end of the arrays/objects.
+          for (;;)
+          {
+            if (_containers.empty())
+            {
+              return true;
+            }
+
+            ExpectToken();
+            const auto next = *_source++;
+            if (next == ',')
+            {
+              if (_containers.back() == '{')
+              {
+                ReadKey(handler);
+              }
+              break;
+            }
+            if (next == ']' && _containers.back() == '[')
+            {
+              _containers.pop_back();
+              handler.EndArray();
+              continue;
+            }
+            if (next == '}' && _containers.back() == '{')
+            {
+              _containers.pop_back();
+              handler.EndObject();
+              continue;
+            }
+            throw std::runtime_error("Expected a ',' or the end of the JSON array/object.");
+          }
+        }
+      }
+
+      /**
+       * Read the next document as nested values, the arrays and objects are AnyJsonArray and AnyJsonObject.
+       * @throw std::runtime_error if the document is not valid, or it is truncated.
+       * @param Any& document the document.
+       * @return bool false if there are no more documents.
+       */
+      bool Read(Any& document)
+      {
+        DocumentBuilder builder(document);
+        return Read(builder);
+      }
+
+    private:
+      /**
+       * The handler that builds the nested values of a document.
+       */
+      class DocumentBuilder
+      {
+      public:
+        explicit DocumentBuilder(Any& document) : _document(document) {}
+
+        void StartArray()
+        {
+          AnyJsonArray* array = Add(Any(AnyJsonArray()));
+          _containers.push_back(Container{ array, nullptr });
+        }
+
+        void StartObject()
+        {
+          AnyJsonObject* object = Add(Any(AnyJsonObject()));
+          _containers.push_back(Container{ nullptr, object });
+        }
+
+        void EndArray() { _containers.pop_back(); }
+        void EndObject() { _containers.pop_back(); }
+        void Key(const Any& key) { _key = key; }
+        void Value(const Any& value) { Add(value); }
+
+      private:
+        /**
+         * Add a value to the array/object we are building, or set the document.
+         * @param Any value the value we are adding, it is moved in place.
+         * @return const Any& the value we added, (copies of an array/object share it).
+         */
+        const Any& Add(Any value)
+        {
+          if (_containers.empty())
+          {
+            _document = std::move(value);
+            return _document;
+          }
+          if (nullptr != _containers.back()._array)
+          {
+            _containers.back()._array->push_back(std::move(value));
+            return _containers.back()._array->back();
+          }
+          _containers.back()._object->emplace_back(std::move(_key), std::move(value));
+          return _containers.back()._object->back().second;
+        }
+
+        struct Container
+        {
+          AnyJsonArray* _array;
+          AnyJsonObject* _object;
+        };
+
+        Any& _document;
+        std::vector<Container> _containers;
+        Any _key;
+      };
+
+      /**
+       * Make sure there is a token, we are in the middle of a document.
+       * @throw std::runtime_error if the document is truncated.
+       */
+      void ExpectToken()
+      {
+        if (!SkipSpaces())
+        {
+          throw std::runtime_error("The JSON document is truncated.");
+        }
+      }
+
+      /**
+       * Skip the spaces before the next token.
+       * @return bool false if there is nothing after the spaces.
+       */
+      bool SkipSpaces()
+      {
+        for (;;)
+        {
+          while (_source != _end && _Json::is_space(*_source))
+          {
+            ++_source;
+          }
+          if (_source != _end)
+          {
+            return true;
+          }
+          if (!Fill(_source))
+          {
+            return false;
+          }
+        }
+      }
+
+      /**
+       * Read the key of an object, and the ':' after it.
+       * @param Handler& handler the handler we give the key to.
+       */
+      template<class Handler>
+      void ReadKey(Handler& handler)
+      {
+        ExpectToken();
+        if (*_source != '"')
+        {
+          throw std::runtime_error("Expected the key of a JSON object.");
+        }
+        ReadScalar();
+        handler.Key(_value);
+
+        ExpectToken();
+        if (*_source++ != ':')
+        {
+          throw std::runtime_error("Expected a ':' after the key of a JSON object.");
+        }
+      }
+
+      /**
+       * Read a string, a number, true, false or null into _value.
+       * If we reach the end of the data we get more and read it again.
+       */
+      void ReadScalar()
+      {
+        for (;;)
+        {
+          bool done;
+          switch (*_source)
+          {
+          case '"':
+            done = TryReadString();
+            break;
+
+          case 't':
+            done = TryReadLiteral("true", 4);
+            break;
+
+          case 'f':
+            done = TryReadLiteral("false", 5);
+            break;
+
+          case 'n':
+            done = TryReadLiteral("null", 4);
+            break;
+
+          default:
+            done = TryReadNumber();
+            break;
+          }
+
+          if (done)
+          {
+            return;
+          }
+          if (!Fill(_source))
+          {
+            throw std::runtime_error("The JSON document is truncated.");
+          }
+        }
+      }
+
+      /**
+       * Read true, false or null.
+       * @param const char* literal the word we are expecting.
+       * @param size_t len the length of the word.
+       * @return bool false if we need more data.
+       */
+      bool TryReadLiteral(const char* literal, size_t len)
+      {
+        if (static_cast<size_t>(_end - _source) < len)
+        {
+          return false;
+        }
+        if (0 != std::memcmp(_source, literal, len))
+        {
+          throw std::runtime_error("Unexpected characters in the JSON document.");
+        }
+        _source += len;
+
+        if (*literal == 'n')
+        {
+          _value.CleanValues();
+          _value._type = dynamic::Misc_null;
+        }
+        else
+        {
+          _value.CreateFromInteger(*literal == 't');
+        }
+        return true;
+      }
+
+      /**
+       * Read a string and decode the escapes, the string is a narrow string.
+       * @return bool false if we need more data.
+       */
+      bool TryReadString()
+      {
+        const char* it = _source + 1;
+        bool escaped = false;
+        for (;;)
+        {
+          const char* special = _Json::find_string_special(it, _end);
+          if (special == _end)
+          {
+            return false;
+          }
+
+          if (*special == '"')
+          {
+            if (escaped)
+            {
+              _scratch.append(it, special);
+              _value.AssignCharacters(_scratch.data(), _scratch.size());
+            }
+            else
+            {
+              _value.AssignCharacters(_source + 1, static_cast<size_t>(special - _source - 1));
+            }
+            _source = special + 1;
+            return true;
+          }
+
+          if (*special != '\\')
+          {
+            throw std::runtime_error("The control characters of a JSON string must be escaped.");
+          }
+
+          // the characters before the escape.
+          if (!escaped)
+          {
+            _scratch.clear();
+            escaped = true;
+          }
+          _scratch.append(it, special);
+
+          const auto escape = ReadEscape(special + 1);
+          if (nullptr == escape)
+          {
+            return false;
+          }
+          it = escape;
+        }
+      }
+
+      /**
+       * Decode an escape into _scratch.
+       * @param const char* source the characters after the '\'
+       * @return const char* past the escape, or nullptr if we need more data.
+       */
+      const char* ReadEscape(const char* source)
+      {
+        if (source == _end)
+        {
+          return nullptr;
+        }
+
+        switch (*source)
+        {
+        case '"':  _scratch += '"'; return source + 1;
+        case '\\': _scratch += '\\'; return source + 1;
+        case '/':  _scratch += '/'; return source + 1;
+        case 'b':  _scratch += '\b'; return source + 1;
+        case 'f':  _scratch += '\f'; return source + 1;
+        case 'n':  _scratch += '\n'; return source + 1;
+        case 'r':  _scratch += '\r'; return source + 1;
+        case 't':  _scratch += '\t'; return source + 1;
+        case 'u':
+          break;
+
+        default:
+          throw std::runtime_error("Invalid escape in a JSON string.");
+        }
+
+        if (_end - source < 5)
+        {
+          return nullptr;
+        }
+        auto codepoint = _Json::read_hex4(source + 1);
+        source += 5;
+        if (codepoint >= 0xDC00 && codepoint <= 0xDFFF)
+        {
+          throw std::runtime_error("Invalid escape in a JSON string.");
+        }
+        if (codepoint >= 0xD800 && codepoint <= 0xDBFF)
+        {
+          // a high surrogate must be followed by an escaped low surrogate.
+          if (_end - source < 6)
+          {
+            return nullptr;
+          }
+          const auto low = (source[0] == '\\' && source[1] == 'u') ? _Json::read_hex4(source + 2) : -1;
+          if (low < 0xDC00 || low > 0xDFFF)
+          {
+            throw std::runtime_error("Invalid escape in a JSON string.");
+          }
+          codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+          source += 6;
+        }
+        if (codepoint < 0)
+        {
+          throw std::runtime_error("Invalid escape in a JSON string.");
+        }
+        _Json::append_utf8(_scratch, static_cast<unsigned long>(codepoint));
+        return source;
+      }
+
+      /**
+       * Read a number, -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+       * @return bool false if we need more data.
+       */
+      bool TryReadNumber()
+      {
+        // find the end of the number first, it might not all be in the data yet.
+        const char* end = _source;
+        while (end != _end && ((*end >= '0' && *end <= '9') || *end == '-' || *end == '+' || *end == '.' || *end == 'e' || *end == 'E'))
+        {
+          ++end;
+        }
+        if (end == _end && _reader.CanRead())
+        {
+          return false;
+        }
+
+        const char* it = _source;
+        const bool negative = (it != end && *it == '-');
+        if (negative)
+        {
+          ++it;
+        }
+
+        // the whole number, no leading zeros.
+        unsigned long long mantissa = 0;
+        bool overflow = false;
+        const char* digits = it;
+        if (it != end && *it == '0')
+        {
+          ++it;
+        }
+        else
+        {
+          for (; it != end && *it >= '0' && *it <= '9'; ++it)
+          {
+            overflow = overflow || !AddDigit(mantissa, *it);
+          }
+        }
+        if (it == digits)
+        {
+          throw std::runtime_error("Unexpected characters in the JSON document.");
+        }
+
+        // the decimals and the exponent.
+        int exponent = 0;
+        bool floating = false;
+        if (it != end && *it == '.')
+        {
+          floating = true;
+          const char* decimals = ++it;
+          for (; it != end && *it >= '0' && *it <= '9'; ++it)
+          {
+            overflow = overflow || !AddDigit(mantissa, *it);
+            --exponent;
+          }
+          if (it == decimals)
+          {
+            throw std::runtime_error("Invalid JSON number.");
+          }
+        }
+        if (it != end && (*it == 'e' || *it == 'E'))
+        {
+          floating = true;
+          ++it;
+          const bool negativeExponent = (it != end && *it == '-');
+          if (it != end && (*it == '-' || *it == '+'))
+          {
+            ++it;
+          }
+          const char* exponentDigits = it;
+          int value = 0;
+          for (; it != end && *it >= '0' && *it <= '9'; ++it)
+          {
+            // past that, the number is 0 or infinite anyway.
+            value = value < 100000 ? value * 10 + (*it - '0') : value;
+          }
+          if (it == exponentDigits)
+          {
+            throw std::runtime_error("Invalid JSON number.");
+          }
+          exponent += negativeExponent ? -value : value;
+        }
+        if (it != end)
+        {
+          throw std::runtime_error("Invalid JSON number.");
+        }
+
+        if (!floating && !overflow)
+        {
+          // the integers that fit are integers, (negative numbers down to the smallest long long).
+          if (!negative)
+          {
+            if (mantissa > static_cast<unsigned long long>(std::numeric_limits<long long>::max()))
+            {
+              _value.CreateFromInteger(mantissa);
+            }
+            else
+            {
+              _value.CreateFromInteger(static_cast<long long>(mantissa));
+            }
+            _source = end;
+            return true;
+          }
+          if (mantissa <= static_cast<unsigned long long>(std::numeric_limits<long long>::max()) + 1)
+          {
+            _value.CreateFromInteger(static_cast<long long>(0ull - mantissa));
+            _source = end;
+            return true;
+          }
+        }
+
+        long double number = 0;
+        if (overflow || !Any::FastPathFloatingPoint(mantissa, exponent, number))
+        {
+          // the 'C' library needs a terminated string.
+          _scratch.assign(_source, end);
+          number = std::strtold(_scratch.c_str(), nullptr);
+        }
+        else if (negative)
+        {
+          number = -number;
+        }
+        _value.CreateFromDouble(number);
+        _source = end;
+        return true;
+      }
+
+      /**
+       * Add a digit to the mantissa.
+       * @param unsigned long long& mantissa the mantissa.
+       * @param char digit the digit.
+       * @return bool false if the mantissa would overflow.
+       */
+      static bool AddDigit(unsigned long long& mantissa, char digit)
+      {
+        const auto value = static_cast<unsigned>(digit - '0');
+        if (mantissa > (std::numeric_limits<unsigned long long>::max() - value) / 10)
+        {
+          return false;
+        }
+        mantissa = mantissa * 10 + value;
+        return true;
+      }
+
+      /**
+       * Read more data from the file descriptor, after what we have not used yet.
+       * @param const char* from where the data we have not used yet starts, it is moved to the start of the buffer.
+       * @return bool true if the data was moved, (we must read it again), false if there is nothing more to read.
+       */
+      bool Fill(const char* from)
+      {
+        if (!_reader.CanRead())
+        {
+          return false;
+        }
+        _source = from;
+        _reader.Fill(_source, _end);
+        return true;
+      }
+
+      // how much we read from the file descriptor at a time.
+      static constexpr size_t ReadSize = 1024 * 1024;
+
+      _Descriptor::Reader _reader;
+      const char* _source;
+      const char* _end;
+
+      // the arrays, ('['), and objects, ('{'), we are in.
+      std::string _containers;
+
+      // the value we give to the handler, and the decoded characters of a string.
+      Any _value;
+      std::string _scratch;
+    };
+
+    /**
+     * Write JSON documents, (RFC 8259), to a buffer or to a file descriptor.
+     * The documents can be written a part at a time, or as nested values, (@see AnyJsonReader::Read( Any& ))
+     * More than one document can be written, one per line.
+     * The numbers use the shortest representation that reads back to the same value,
+     * infinite numbers and NaN are written as null.
+     */
+    class AnyJsonWriter
+    {
+    public:
+      /**
+       * Append the documents to a buffer.
+       * @param std::string& buffer where we are writing, it must outlive the writer.
+       */
+      explicit AnyJsonWriter(std::string& buffer) :
+        _writer(buffer),
+        _buffer(_writer.Buffer()),
+        _first(true),
+        _afterKey(false),
+        _documents(false)
+      {
+      }
+
+      /**
+       * Write the documents to a file descriptor.
+       * @param int fd the file descriptor, it is not closed by the writer.
+       */
+      explicit AnyJsonWriter(int fd) :
+        _writer(fd),
+        _buffer(_writer.Buffer()),
+        _first(true),
+        _afterKey(false),
+        _documents(false)
+      {
+      }
+
+      AnyJsonWriter(const AnyJsonWriter&) = delete;
+      AnyJsonWriter& operator=(const AnyJsonWriter&) = delete;
+
+      /**
+       * Start an array, the values that follow are in it until EndArray()
+       */
+      void StartArray()
+      {
+        BeforeValue();
+        _buffer += '[';
+        _containers += '[';
+        _first = true;
+      }
+
+      /**
+       * End the current array.
+       * @throw std::runtime_error if we are not in an array.
+       */
+      void EndArray()
+      {
+        EndContainer('[', ']');
+      }
+
+      /**
+       * Start an object, the keys and values that follow are in it until EndObject()
+       */
+      void StartObject()
+      {
+        BeforeValue();
+        _buffer += '{';
+        _containers += '{';
+        _first = true;
+      }
+
+      /**
+       * End the current object.
+       * @throw std::runtime_error if we are not in an object, or a key has no value.
+       */
+      void EndObject()
+      {
+        if (_afterKey)
+        {
+          throw std::runtime_error("The key of the JSON object has no value.");
+        }
+        EndContainer('{', '}');
+      }
+
+      /**
+       * Write the key of the next value of an object, numbers are written as strings.
+       * @throw std::runtime_error if we are not in an object, or the previous key has no value.
+       * @param const Any& key the key.
+       */
+      void Key(const Any& key)
+      {
+        if (_containers.empty() || _containers.back() != '{' || _afterKey)
+        {
+          throw std::runtime_error("A JSON key must be followed by a value, in an object.");
+        }
+        if (!_first)
+        {
+          _buffer += ',';
+        }
+        _first = false;
+        WriteString(key);
+        _buffer += ':';
+        _afterKey = true;
+      }
+
+      /**
+       * Write a value, arrays and objects, (AnyJsonArray and AnyJsonObject), are written with their values.
+       * @throw std::runtime_error if the value is a copy of something else, or it is in an object without a key.
+       * @param const Any& value the value.
+       */
+      void Write(const Any& value)
+      {
+        if (value.IsCopyOf<AnyJsonArray>())
+        {
+          StartArray();
+          for (const auto& item : *static_cast<const AnyJsonArray*>(value))
+          {
+            Write(item);
+          }
+          EndArray();
+          return;
+        }
+
+        if (value.IsCopyOf<AnyJsonObject>())
+        {
+          StartObject();
+          for (const auto& item : *static_cast<const AnyJsonObject*>(value))
+          {
+            Key(item.first);
+            Write(item.second);
+          }
+          EndObject();
+          return;
+        }
+
+        if (dynamic::is_type_copy(value.Type()) || dynamic::Misc_unknown == value.Type())
+        {
+          throw std::runtime_error("Unable to write a copy of an object as JSON.");
+        }
+
+        BeforeValue();
+        switch (value.Type())
+        {
+        case dynamic::Misc_null:
+          _buffer += "null";
+          break;
+
+        case dynamic::Boolean_bool:
+          _buffer += value._llivalue ? "true" : "false";
+          break;
+
+        case dynamic::Character_signed_char:
+        case dynamic::Character_unsigned_char:
+        case dynamic::Character_char:
+        case dynamic::Character_wchar_t:
+          WriteString(value);
+          break;
+
+        default:
+          if (std::isfinite(value._ldvalue))
+          {
+            char buffer[dynamic::format_buffer_size];
+            char* end = value.FormatNumber(buffer);
+            _buffer.append(buffer, end);
+
+            // a floating point that looks like an integer would be read back as an integer.
+            if (dynamic::is_type_floating(value.Type()) && std::find_if(buffer, end, [](char c) { return c == '.' || c == 'e' || c == 'E'; }) == end)
+            {
+              _buffer += ".0";
+            }
+          }
+          else
+          {
+            _buffer += "null";
+          }
+          break;
+        }
+        AfterValue();
+      }
+
+      /**
+       * Write what we have to the file descriptor, what is left is written when the writer is destroyed,
+       * call it if you need to know about errors.
+       */
+      void Flush()
+      {
+        _writer.Flush();
+      }
+
+    private:
+      /**
+       * Add what goes before a value, the ',' between the values of an array or the new line between documents.
+       * @throw std::runtime_error if we are in an object and there is no key.
+       */
+      void BeforeValue()
+      {
+        if (_containers.empty())
+        {
+          if (_documents)
+          {
+            _buffer += '\n';
+          }
+          _documents = true;
+          return;
+        }
+
+        if (_containers.back() == '{')
+        {
+          if (!_afterKey)
+          {
+            throw std::runtime_error("A value of a JSON object must have a key.");
+          }
+          _afterKey = false;
+          return;
+        }
+
+        if (!_first)
+        {
+          _buffer += ',';
+        }
+        _first = false;
+      }
+
+      /**
+       * Write what we have once we have enough.
+       */
+      void AfterValue()
+      {
+        _writer.FlushIfNeeded();
+      }
+
+      /**
+       * End the current array/object.
+       * @throw std::runtime_error if we are not in that kind of container.
+       * @param char open the character that started it.
+       * @param char close the character that ends it.
+       */
+      void EndContainer(char open, char close)
+      {
+        if (_containers.empty() || _containers.back() != open)
+        {
+          throw std::runtime_error("The JSON array/object was not started.");
+        }
+        _containers.pop_back();
+        _buffer += close;
+        _first = false;
+        AfterValue();
+      }
+
+      /**
+       * Write a value as a string, wide strings are written as utf-8
+       * @param const Any& value the value.
+       */
+      void WriteString(const Any& value)
+      {
+        switch (value.Type())
+        {
+        case dynamic::Character_signed_char:
+        case dynamic::Character_unsigned_char:
+        case dynamic::Character_char:
+          _Json::append_string(_buffer, value._cvalue, value.CharactersLength<char>());
+          break;
+
+        default:
+          value.CreateString(_scratch);
+          _Json::append_string(_buffer, _scratch.data(), _scratch.size());
+          break;
+        }
+      }
+
+      _Descriptor::Writer _writer;
+      std::string& _buffer;
+
+      // the arrays, ('['), and objects, ('{'), we are in.
+      std::string _containers;
+
+      // if this is the first value of the array/object, if we wrote a key and if we wrote a document.
+      bool _first;
+      bool _afterKey;
+      bool _documents;
+
+      std::string _scratch;
+    };
+  }
+}
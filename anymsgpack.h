@@ -0,0 +1,583 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <cstddef>        //  size_t
+#include <cstring>        //  std::memcpy
+#include <limits>         //  std::numeric_limits
+#include <stdexcept>      //  std::runtime_error / std::length_error
+#include <string>
+
+#include "any.h"          // the values
+#include "anyjson.h"      // the arrays and the objects
+#include "descriptor.h"   // file descriptors
+#include "msgpack.h"      // MessagePack values
+
+namespace myodd {
+  namespace dynamic {
+    /**
+     * Write values in the MessagePack format, to a buffer or to a file descriptor.
+     * Integers are written in the smallest format they fit in, floats as float32, doubles and long doubles
+     * as float64, (there is nothing bigger), strings as utf-8, and the copies of AnyJsonArray/AnyJsonObject
+     * as arrays and maps, nothing is converted to a string and back.
+     * @see AnyMsgPackReader
+     */
+    class AnyMsgPackWriter
+    {
+    public:
+      /**
+       * Append the values to a buffer.
+       * @param std::string& buffer where we are writing, it must outlive the writer.
+       */
+      explicit AnyMsgPackWriter(std::string& buffer) :
+        _writer(buffer),
+        _buffer(_writer.Buffer())
+      {
+      }
+
+      /**
+       * Write the values to a file descriptor, they are buffered until we have enough of them.
+       * @param int fd the file descriptor, it is not closed by the writer.
+       */
+      explicit AnyMsgPackWriter(int fd) :
+        _writer(fd),
+        _buffer(_writer.Buffer())
+      {
+      }
+
+      AnyMsgPackWriter(const AnyMsgPackWriter&) = delete;
+      AnyMsgPackWriter& operator=(const AnyMsgPackWriter&) = delete;
+
+      /**
+       * Start an array, the next values we write are the values of the array.
+       * @throw std::length_error if there are more than 2^32 - 1 values.
+       * @param size_t size the number of values in the array.
+       */
+      void StartArray(size_t size)
+      {
+        _MsgPack::append_array_header(_buffer, size);
+      }
+
+      /**
+       * Start a map, the next values we write are the keys and the values of the map, one after the other.
+       * @throw std::length_error if there are more than 2^32 - 1 pairs.
+       * @param size_t size the number of key/value pairs in the map.
+       */
+      void StartObject(size_t size)
+      {
+        _MsgPack::append_map_header(_buffer, size);
+      }
+
+      /**
+       * Write a value, or a whole document.
+       * @throw std::runtime_error if the value is a copy of an object that is not an array/object.
+       * @param const Any& value the value.
+       */
+      void Write(const Any& value)
+      {
+        if (value.IsCopyOf<AnyJsonArray>())
+        {
+          const auto& array = *static_cast<const AnyJsonArray*>(value);
+          StartArray(array.size());
+          for (const auto& item : array)
+          {
+            Write(item);
+          }
+          return;
+        }
+
+        if (value.IsCopyOf<AnyJsonObject>())
+        {
+          const auto& object = *static_cast<const AnyJsonObject*>(value);
+          StartObject(object.size());
+          for (const auto& item : object)
+          {
+            Write(item.first);
+            Write(item.second);
+          }
+          return;
+        }
+
+        switch (value.Type())
+        {
+        case dynamic::Misc_null:
+          _buffer += static_cast<char>(_MsgPack::Format_Nil);
+          break;
+
+        case dynamic::Boolean_bool:
+          _buffer += static_cast<char>(value._llivalue ? _MsgPack::Format_True : _MsgPack::Format_False);
+          break;
+
+        case dynamic::Character_signed_char:
+        case dynamic::Character_unsigned_char:
+        case dynamic::Character_char:
+          {
+            const auto length = value.CharactersLength<char>();
+            _MsgPack::append_string_header(_buffer, length);
+            _buffer.append(value._cvalue, length);
+          }
+          break;
+
+        case dynamic::Character_wchar_t:
+          value.CreateString(_scratch);
+          _MsgPack::append_string_header(_buffer, _scratch.size());
+          _buffer.append(_scratch);
+          break;
+
+        case dynamic::Integer_short_int:
+        case dynamic::Integer_int:
+        case dynamic::Integer_long_int:
+        case dynamic::Integer_long_long_int:
+          _MsgPack::append_integer(_buffer, value._llivalue);
+          break;
+
+        case dynamic::Integer_unsigned_short_int:
+        case dynamic::Integer_unsigned_int:
+        case dynamic::Integer_unsigned_long_int:
+        case dynamic::Integer_unsigned_long_long_int:
+          _MsgPack::append_unsigned(_buffer, static_cast<unsigned long long>(value._llivalue));
+          break;
+
+        case dynamic::Floating_point_float:
+          _MsgPack::append_float(_buffer, static_cast<float>(value._ldvalue));
+          break;
+
+        case dynamic::Floating_point_double:
+        case dynamic::Floating_point_long_double:
+          _MsgPack::append_double(_buffer, static_cast<double>(value._ldvalue));
+          break;
+
+        case dynamic::Misc_copy:
+        case dynamic::Misc_copy_ptr:
+          throw std::runtime_error("Unable to write a copy of an object as MessagePack.");
+
+        default:
+          throw std::runtime_error("Unknown data Type");
+        }
+
+        _writer.FlushIfNeeded();
+      }
+
+      /**
+       * Write what we have to the file descriptor, what is left is written when the writer is destroyed,
+       * call it if you need to know about errors.
+       */
+      void Flush()
+      {
+        _writer.Flush();
+      }
+
+    private:
+      _Descriptor::Writer _writer;
+      std::string& _buffer;
+
+      std::string _scratch;
+    };
+
+    /**
+     * Read MessagePack values from a buffer, from a file descriptor, or from the data we are given as it arrives.
+     * The integers are int if they fit, long long otherwise, (unsigned long long past LLONG_MAX), float32 are floats,
+     * float64 are doubles, strings and binaries are strings, arrays are copies of AnyJsonArray and maps copies of AnyJsonObject.
+     * The extension types are not supported.
+     * @see AnyMsgPackWriter
+     */
+    class AnyMsgPackReader
+    {
+    public:
+      /**
+       * Read the values we are given with Append( ... ), a value that is not all there
+       * is kept until we are given the rest of it, (messages from a socket for example).
+       */
+      AnyMsgPackReader() :
+        _append(true),
+        _borrow(false),
+        _source(nullptr),
+        _end(nullptr)
+      {
+      }
+
+      /**
+       * Read the values from a buffer.
+       * @param const char* data the data, it must outlive the reader.
+       * @param size_t len the size of the data.
+       * @param bool borrow if the strings borrow their characters from the data rather than copy them,
+       *                    the data must then outlive the values, (and any view/pointer we return).
+       */
+      AnyMsgPackReader(const char* data, size_t len, bool borrow = false) :
+        _append(false),
+        _borrow(borrow),
+        _source(data),
+        _end(data + len)
+      {
+      }
+
+      /**
+       * Read the values from a file descriptor, a chunk at a time.
+       * @param int fd the file descriptor, it is not closed by the reader.
+       */
+      explicit AnyMsgPackReader(int fd) :
+        _reader(fd, ReadSize),
+        _append(false),
+        _borrow(false),
+        _source(nullptr),
+        _end(nullptr)
+      {
+      }
+
+      AnyMsgPackReader(const AnyMsgPackReader&) = delete;
+      AnyMsgPackReader& operator=(const AnyMsgPackReader&) = delete;
+
+      /**
+       * Give the reader more data, (only if it was created without any).
+       * @throw std::runtime_error if the reader reads from a buffer or a file descriptor.
+       * @param const char* data the data, it is copied.
+       * @param size_t len the size of the data.
+       */
+      void Append(const char* data, size_t len)
+      {
+        if (!_append)
+        {
+          throw std::runtime_error("Only a reader created without data can be given more data.");
+        }
+
+        _reader.Append(_source, _end, data, len);
+      }
+
+      /**
+       * Read the next value, arrays and maps are read as a whole.
+       * If the value holds the only copy of an array/map we write over it, (and over its values), rather than create a new one.
+       * @throw std::runtime_error if the data is not a value, or the last value is truncated.
+       * @param Any& value the value we read, it is only valid if we return true.
+       * @return bool false if there are no more values, (or, if we are given the data, the next value is not all there yet).
+       */
+      bool Read(Any& value)
+      {
+        for (;;)
+        {
+          if (_source == _end && !Fill())
+          {
+            return false;
+          }
+
+          const char* source = _source;
+          try
+          {
+            ReadValue(source, value, 0);
+            _source = source;
+            return true;
+          }
+          catch (const _Binary::truncated_error&)
+          {
+            // the rest of the value might still be in the file, or still to come.
+            if (!Fill())
+            {
+              if (_append)
+              {
+                return false;
+              }
+              throw;
+            }
+          }
+        }
+      }
+
+    private:
+      /**
+       * Read a value.
+       * @param const char*& source where we are reading from, moved past the value.
+       * @param Any& value the value we read.
+       * @param size_t depth how many arrays/maps we are in.
+       */
+      void ReadValue(const char*& source, Any& value, size_t depth)
+      {
+        const auto format = _Binary::read_byte(source, _end);
+        if (format < _MsgPack::Format_Fixmap)
+        {
+          value.CreateFromInteger(static_cast<int>(format));
+          return;
+        }
+        if (format >= _MsgPack::Format_Negative_Fixint)
+        {
+          value.CreateFromInteger(static_cast<int>(format) - 0x100);
+          return;
+        }
+        if (format < _MsgPack::Format_Fixarray)
+        {
+          ReadMap(source, value, format & 0x0f, depth);
+          return;
+        }
+        if (format < _MsgPack::Format_Fixstr)
+        {
+          ReadArray(source, value, format & 0x0f, depth);
+          return;
+        }
+        if (format < _MsgPack::Format_Nil)
+        {
+          ReadString(source, value, format & 0x1f);
+          return;
+        }
+
+        switch (format)
+        {
+        case _MsgPack::Format_Nil:
+          value.CleanValues();
+          value._type = dynamic::Misc_null;
+          return;
+
+        case _MsgPack::Format_False:
+        case _MsgPack::Format_True:
+          value.CreateFromInteger(_MsgPack::Format_True == format);
+          return;
+
+        case _MsgPack::Format_Bin8:
+        case _MsgPack::Format_Str8:
+          ReadString(source, value, _MsgPack::read_big_endian<unsigned char>(source, _end));
+          return;
+
+        case _MsgPack::Format_Bin16:
+        case _MsgPack::Format_Str16:
+          ReadString(source, value, _MsgPack::read_big_endian<unsigned short>(source, _end));
+          return;
+
+        case _MsgPack::Format_Bin32:
+        case _MsgPack::Format_Str32:
+          ReadString(source, value, _MsgPack::read_big_endian<unsigned int>(source, _end));
+          return;
+
+        case _MsgPack::Format_Float32:
+          {
+            const auto bits = _MsgPack::read_big_endian<unsigned int>(source, _end);
+            float number;
+            std::memcpy(&number, &bits, sizeof(number));
+            value.CreateFromDouble(number);
+          }
+          return;
+
+        case _MsgPack::Format_Float64:
+          {
+            const auto bits = _MsgPack::read_big_endian<unsigned long long>(source, _end);
+            double number;
+            std::memcpy(&number, &bits, sizeof(number));
+            value.CreateFromDouble(number);
+          }
+          return;
+
+        case _MsgPack::Format_Uint8:
+          SetInteger(value, _MsgPack::read_big_endian<unsigned char>(source, _end));
+          return;
+
+        case _MsgPack::Format_Uint16:
+          SetInteger(value, _MsgPack::read_big_endian<unsigned short>(source, _end));
+          return;
+
+        case _MsgPack::Format_Uint32:
+          SetInteger(value, _MsgPack::read_big_endian<unsigned int>(source, _end));
+          return;
+
+        case _MsgPack::Format_Uint64:
+          {
+            const auto number = _MsgPack::read_big_endian<unsigned long long>(source, _end);
+            if (number > static_cast<unsigned long long>(std::numeric_limits<long long>::max()))
+            {
+              value.CreateFromInteger(number);
+            }
+            else
+            {
+              SetInteger(value, static_cast<long long>(number));
+            }
+          }
+          return;
+
+        case _MsgPack::Format_Int8:
+          SetInteger(value, static_cast<signed char>(_MsgPack::read_big_endian<unsigned char>(source, _end)));
+          return;
+
+        case _MsgPack::Format_Int16:
+          SetInteger(value, static_cast<short>(_MsgPack::read_big_endian<unsigned short>(source, _end)));
+          return;
+
+        case _MsgPack::Format_Int32:
+          SetInteger(value, static_cast<int>(_MsgPack::read_big_endian<unsigned int>(source, _end)));
+          return;
+
+        case _MsgPack::Format_Int64:
+          SetInteger(value, static_cast<long long>(_MsgPack::read_big_endian<unsigned long long>(source, _end)));
+          return;
+
+        case _MsgPack::Format_Array16:
+          ReadArray(source, value, _MsgPack::read_big_endian<unsigned short>(source, _end), depth);
+          return;
+
+        case _MsgPack::Format_Array32:
+          ReadArray(source, value, _MsgPack::read_big_endian<unsigned int>(source, _end), depth);
+          return;
+
+        case _MsgPack::Format_Map16:
+          ReadMap(source, value, _MsgPack::read_big_endian<unsigned short>(source, _end), depth);
+          return;
+
+        case _MsgPack::Format_Map32:
+          ReadMap(source, value, _MsgPack::read_big_endian<unsigned int>(source, _end), depth);
+          return;
+
+        default:
+          throw std::runtime_error("Unsupported MessagePack value, the extension types cannot be read.");
+        }
+      }
+
+      /**
+       * Set an integer, as an int if it fits.
+       * @param Any& value the value we are setting.
+       * @param long long number the number.
+       */
+      static void SetInteger(Any& value, long long number)
+      {
+        if (number >= std::numeric_limits<int>::min() && number <= std::numeric_limits<int>::max())
+        {
+          value.CreateFromInteger(static_cast<int>(number));
+        }
+        else
+        {
+          value.CreateFromInteger(number);
+        }
+      }
+
+      /**
+       * Read the characters of a string/binary.
+       * @param const char*& source where we are reading from, moved past the characters.
+       * @param Any& value the value we read.
+       * @param size_t len the number of characters.
+       */
+      void ReadString(const char*& source, Any& value, size_t len)
+      {
+        if (static_cast<size_t>(_end - source) < len)
+        {
+          throw _Binary::truncated_error();
+        }
+        if (_borrow)
+        {
+          value.BorrowFromCharacters(source, len);
+        }
+        else
+        {
+          value.AssignCharacters(source, len);
+        }
+        source += len;
+      }
+
+      /**
+       * Read the values of an array.
+       * @param const char*& source where we are reading from, moved past the array.
+       * @param Any& value the value we read.
+       * @param size_t size the number of values.
+       * @param size_t depth how many arrays/maps we are in.
+       */
+      void ReadArray(const char*& source, Any& value, size_t size, size_t depth)
+      {
+        // each value is at least one byte, so we can check the size before we allocate anything.
+        CheckContainer(source, size, depth);
+        auto& array = *Reuse<AnyJsonArray>(value);
+        array.resize(size);
+        for (auto& item : array)
+        {
+          ReadValue(source, item, depth + 1);
+        }
+      }
+
+      /**
+       * Read the keys and the values of a map.
+       * @param const char*& source where we are reading from, moved past the map.
+       * @param Any& value the value we read.
+       * @param size_t size the number of key/value pairs.
+       * @param size_t depth how many arrays/maps we are in.
+       */
+      void ReadMap(const char*& source, Any& value, size_t size, size_t depth)
+      {
+        CheckContainer(source, size * 2, depth);
+        auto& object = *Reuse<AnyJsonObject>(value);
+        object.resize(size);
+        for (auto& item : object)
+        {
+          ReadValue(source, item.first, depth + 1);
+          ReadValue(source, item.second, depth + 1);
+        }
+      }
+
+      /**
+       * Check that we have enough data for the values of an array/map, and that it is not nested too deeply.
+       * @param const char* source where the values start.
+       * @param size_t values the number of values.
+       * @param size_t depth how many arrays/maps we are in.
+       */
+      void CheckContainer(const char* source, size_t values, size_t depth) const
+      {
+        if (depth >= MaxDepth)
+        {
+          throw std::runtime_error("The MessagePack arrays/maps are nested too deeply.");
+        }
+        if (values > static_cast<size_t>(_end - source))
+        {
+          throw _Binary::truncated_error();
+        }
+      }
+
+      /**
+       * Get the array/map we are writing to, we reuse the one we have if nobody else is using it.
+       * @param Any& value the value we are reading.
+       * @return T* the array/map.
+       */
+      template<class T>
+      static T* Reuse(Any& value)
+      {
+        if (!value.IsCopyOf<T>() || 1 != value._unkvalue->_counter.load(std::memory_order_relaxed))
+        {
+          value = Any(T());
+        }
+        return static_cast<T*>(value);
+      }
+
+      /**
+       * Read more data from the file descriptor, after what we have not read yet.
+       * @return bool false if there is nothing more to read.
+       */
+      bool Fill()
+      {
+        return _reader.Fill(_source, _end) > 0;
+      }
+
+      // how much we read from the file descriptor at a time.
+      static constexpr size_t ReadSize = 64 * 1024;
+
+      // how many arrays/maps can be in one another, we read them recursively.
+      static constexpr size_t MaxDepth = 512;
+
+      _Descriptor::Reader _reader;
+      bool _append;
+      bool _borrow;
+      const char* _source;
+      const char* _end;
+    };
+  }
+}
@@ -0,0 +1,131 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <cstddef>        //  size_t
+#include <istream>        //  std::istream
+
+#include "any.h"          // the values
+#include "descriptor.h"   // file descriptors and streams
+#include "token.h"        // whitespace separated tokens
+
+namespace myodd {
+  namespace dynamic {
+    /**
+     * Read whitespace separated tokens, from a buffer or from a stream, a large block at a time.
+     * Each token is a string value, numbers are worked out as we copy the characters, so "12" is a string
+     * that is also the number 12, the same as Any("12"), (and the same as reading it with operator>>).
+     */
+    class AnyTokenizer
+    {
+    public:
+      /**
+       * Read the tokens from a buffer.
+       * @param const char* data the data, it must outlive the tokenizer.
+       * @param size_t len the size of the data.
+       */
+      AnyTokenizer(const char* data, size_t len) :
+        _source(data),
+        _end(data + len)
+      {
+      }
+
+      /**
+       * Read the tokens from a stream, a large block at a time.
+       * The stream is read past the last token we return, so nothing else should read from it.
+       * @param std::istream& stream the stream, it must outlive the tokenizer.
+       */
+      explicit AnyTokenizer(std::istream& stream) :
+        _reader(stream, ReadSize),
+        _source(nullptr),
+        _end(nullptr)
+      {
+      }
+
+      AnyTokenizer(const AnyTokenizer&) = delete;
+      AnyTokenizer& operator=(const AnyTokenizer&) = delete;
+
+      /**
+       * Read the next token, the value reuses its character buffer if it can.
+       * @param Any& value the value we read, it is only changed if we return true.
+       * @return bool false if there are no more tokens.
+       */
+      bool Read(Any& value)
+      {
+        for (;;)
+        {
+          _source = _Token::skip_spaces(_source, _end);
+          if (_source != _end)
+          {
+            break;
+          }
+          if (!Fill(_source))
+          {
+            return false;
+          }
+        }
+
+        for (;;)
+        {
+          // read the whole token, if we reach the end of the data, get more and read it again.
+          const char* start = _source;
+          const char* tokenEnd = _Token::find_token_end(start, _end);
+          if (tokenEnd == _end && Fill(start))
+          {
+            continue;
+          }
+
+          value.AssignCharacters(start, static_cast<size_t>(tokenEnd - start));
+          _source = tokenEnd;
+          return true;
+        }
+      }
+
+    private:
+      /**
+       * Read more data from the stream, after what we have not used yet.
+       * @param const char* from where the data we have not used yet starts, it is moved to the start of the buffer.
+       * @return bool true if the data was moved, (we must read it again), false if there is nothing more to read.
+       */
+      bool Fill(const char* from)
+      {
+        if (!_reader.CanRead())
+        {
+          return false;
+        }
+        _source = from;
+        _reader.Fill(_source, _end);
+        return true;
+      }
+
+      // how much we read from the stream at a time.
+      static constexpr size_t ReadSize = 1024 * 1024;
+
+      _Descriptor::Reader _reader;
+      const char* _source;
+      const char* _end;
+    };
+  }
+}
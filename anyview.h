@@ -0,0 +1,147 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <atomic>         //  std::atomic
+#include <cstddef>        //  size_t
+#include <limits>         //  std::numeric_limits
+#include <mutex>          //  std::mutex
+#include <stdexcept>      //  std::out_of_range
+#include <vector>
+
+#include "any.h"          // the values
+
+namespace myodd {
+  namespace dynamic {
+    /**
+     * A read-only view of the values written by an AnyWriter, the data is used where it is,
+     * (a mapped file for example), and a value is only read when we ask for it.
+     * The numbers are read as they are and the strings borrow their characters from the data.
+     * Opening the view only checks the header, the data is walked once, the first time we need to know
+     * where the values are, and we keep 4 bytes per value, (8 if the data is larger than 4Gb).
+     * @see Any::DeserializeBorrowed( ... )
+     */
+    class AnyView
+    {
+    public:
+      /**
+       * Create the view, only the header is read.
+       * @throw std::runtime_error if the data is not a stream of values.
+       * @param const char* data the data, it must outlive the view and the values we return.
+       * @param size_t len the size of the data.
+       */
+      AnyView(const char* data, size_t len) :
+        _data(data),
+        _end(data + len),
+        _values(data),
+        _indexed(false)
+      {
+        _Binary::read_header(_values, _end);
+      }
+
+      AnyView(const AnyView&) = delete;
+      AnyView& operator=(const AnyView&) = delete;
+
+      /**
+       * The number of values in the view.
+       * @throw std::runtime_error if a value is not a value, or is truncated.
+       * @return size_t the number of values.
+       */
+      size_t Size() const
+      {
+        Index();
+        return _small.empty() ? _large.size() : _small.size();
+      }
+
+      /**
+       * Read a value, the strings borrow their characters from the data.
+       * @throw std::out_of_range if the index is past the last value.
+       * @throw std::runtime_error if a value is not a value, or is truncated.
+       * @param size_t index the index of the value.
+       * @return Any the value.
+       */
+      Any operator[](size_t index) const
+      {
+        if (index >= Size())
+        {
+          throw std::out_of_range("The index is past the last value.");
+        }
+        const char* source = _data + (_small.empty() ? _large[index] : _small[index]);
+        return Any::DeserializeBorrowed(source, _end);
+      }
+
+    private:
+      /**
+       * Walk the data to know where each value is, only the first call does it.
+       */
+      void Index() const
+      {
+        if (_indexed.load(std::memory_order_acquire))
+        {
+          return;
+        }
+
+        // if a value is corrupted we throw and the next call walks the data again.
+        std::lock_guard<std::mutex> guard(_lock);
+        if (!_indexed.load(std::memory_order_relaxed))
+        {
+          const auto small = static_cast<unsigned long long>(_end - _data) <= std::numeric_limits<unsigned int>::max();
+          std::vector<unsigned int> smallOffsets;
+          std::vector<size_t> largeOffsets;
+          for (const char* source = _values; source != _end; )
+          {
+            const auto offset = static_cast<size_t>(source - _data);
+            if (small)
+            {
+              smallOffsets.push_back(static_cast<unsigned int>(offset));
+            }
+            else
+            {
+              largeOffsets.push_back(offset);
+            }
+            Any::SkipSerialized(source, _end);
+          }
+          smallOffsets.shrink_to_fit();
+          largeOffsets.shrink_to_fit();
+          _small.swap(smallOffsets);
+          _large.swap(largeOffsets);
+          _indexed.store(true, std::memory_order_release);
+        }
+      }
+
+      const char* _data;
+      const char* _end;
+
+      // where the first value starts, after the header.
+      const char* _values;
+
+      // where each value starts, from the start of the data, only one of them is used.
+      mutable std::mutex _lock;
+      mutable std::atomic<bool> _indexed;
+      mutable std::vector<unsigned int> _small;
+      mutable std::vector<size_t> _large;
+    };
+  }
+}
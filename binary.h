@@ -0,0 +1,464 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <cmath>          //  std::frexp / std::ldexp
+#include <cstddef>        //  size_t
+#include <cstring>        //  std::memcpy
+#include <limits>         //  std::numeric_limits
+#include <stdexcept>      //  std::runtime_error
+#include <string>
+
+// on little endian cpus the numbers are copied as they are.
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_MSC_VER)
+#   define MYODD_ANY_LITTLE_ENDIAN 1
+#else
+#   define MYODD_ANY_LITTLE_ENDIAN 0
+#endif
+
+/**
+ * The helpers used to write values in a compact binary form and read them back.
+ * All the numbers are written little endian, whatever the cpu is.
+ */
+namespace myodd {
+  namespace dynamic {
+    namespace _Binary
+    {
+      /**
+       * The version of the binary format, it is written at the start of a stream.
+       * The readers refuse to read a version newer than the one they know.
+       */
+      static constexpr unsigned char version = 1;
+
+      /**
+       * The characters written before the version at the start of a stream.
+       */
+      static constexpr char magic[] = { 'A', 'N', 'Y' };
+
+      /**
+       * The size of the stream header, the magic characters and the version.
+       */
+      static constexpr size_t header_size = sizeof(magic) + 1;
+
+      /**
+       * The characters at the start and at the end of a column.
+       */
+      static constexpr char column_magic[] = { 'A', 'N', 'Y', 'C' };
+
+      /**
+       * The version of the column format, the slots of version 2 are in compressed blocks.
+       * The columns of version 1 can still be read.
+       */
+      static constexpr unsigned char column_version = 2;
+
+      /**
+       * The size of the column header, the magic characters, the version and 3 bytes of padding.
+       */
+      static constexpr size_t column_header_size = 8;
+
+      /**
+       * The size of the column footer, the number of values, the size of the heap, where the tags
+       * and the slots are, (version 1), or where the blocks and their directory are, (version 2),
+       * the magic characters, the version and 3 bytes of padding.
+       */
+      static constexpr size_t column_footer_size = 40;
+
+      /**
+       * The size of a block in the directory of a column, where the block is, the base, the step,
+       * (or the number of runs), the encoding, the width, the tag, the flags and 4 bytes of padding.
+       */
+      static constexpr size_t column_block_size = 32;
+
+      /**
+       * The error thrown when we need more data to read a value.
+       * When reading a stream it only means that we have to read more of it.
+       */
+      class truncated_error : public std::runtime_error
+      {
+      public:
+        truncated_error() : std::runtime_error("The binary value is truncated.") {}
+      };
+
+      /**
+       * Zigzag encode a signed number so small negative numbers are small as well.
+       * @param long long value the value we are encoding.
+       * @return unsigned long long the encoded value.
+       */
+      inline unsigned long long zigzag(long long value)
+      {
+        return (static_cast<unsigned long long>(value) << 1) ^ (0ull - (static_cast<unsigned long long>(value) >> 63));
+      }
+
+      /**
+       * Decode a zigzag encoded number.
+       * @param unsigned long long value the encoded value.
+       * @return long long the value.
+       */
+      inline long long unzigzag(unsigned long long value)
+      {
+        return static_cast<long long>((value >> 1) ^ (0ull - (value & 1)));
+      }
+
+      /**
+       * Append a number, 7 bits at a time, the high bit is set if more bits follow.
+       * @param std::string& buffer where we are writing.
+       * @param unsigned long long value the number.
+       */
+      inline void append_varint(std::string& buffer, unsigned long long value)
+      {
+        char bytes[10];
+        size_t len = 0;
+        while (value >= 0x80)
+        {
+          bytes[len++] = static_cast<char>((value & 0x7f) | 0x80);
+          value >>= 7;
+        }
+        bytes[len++] = static_cast<char>(value);
+        buffer.append(bytes, len);
+      }
+
+      /**
+       * Read a number written with append_varint( ... )
+       * @param const char*& source where we are reading from, moved past the number.
+       * @param const char* end the end of the data.
+       * @return unsigned long long the number.
+       */
+      inline unsigned long long read_varint(const char*& source, const char* end)
+      {
+        unsigned long long value = 0;
+        for (unsigned int shift = 0; shift < 64; shift += 7)
+        {
+          if (source == end)
+          {
+            throw truncated_error();
+          }
+          const auto byte = static_cast<unsigned char>(*source++);
+          value |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+          if (0 == (byte & 0x80))
+          {
+            return value;
+          }
+        }
+        throw std::runtime_error("The binary number is too long.");
+      }
+
+      /**
+       * Read a single byte.
+       * @param const char*& source where we are reading from, moved past the byte.
+       * @param const char* end the end of the data.
+       * @return unsigned char the byte.
+       */
+      inline unsigned char read_byte(const char*& source, const char* end)
+      {
+        if (source == end)
+        {
+          throw truncated_error();
+        }
+        return static_cast<unsigned char>(*source++);
+      }
+
+      /**
+       * Store an unsigned number, little endian.
+       * @param char* destination where we are writing, it must have room for the number.
+       * @param Bits bits the number.
+       */
+      template<class Bits>
+      void store_little_endian(char* destination, Bits bits)
+      {
+#if MYODD_ANY_LITTLE_ENDIAN
+        std::memcpy(destination, &bits, sizeof(bits));
+#else
+        for (size_t i = 0; i < sizeof(Bits); ++i)
+        {
+          destination[i] = static_cast<char>((bits >> (i * 8)) & 0xff);
+        }
+#endif
+      }
+
+      /**
+       * Load an unsigned number, little endian.
+       * @param const char* source where we are reading from, it must hold the whole number.
+       * @return Bits the number.
+       */
+      template<class Bits>
+      Bits load_little_endian(const char* source)
+      {
+        Bits bits = 0;
+#if MYODD_ANY_LITTLE_ENDIAN
+        std::memcpy(&bits, source, sizeof(bits));
+#else
+        for (size_t i = 0; i < sizeof(Bits); ++i)
+        {
+          bits |= static_cast<Bits>(static_cast<unsigned char>(source[i])) << (i * 8);
+        }
+#endif
+        return bits;
+      }
+
+      /**
+       * Append the raw bits of a float/double.
+       * @param std::string& buffer where we are writing.
+       * @param T value the value, the bits are written as they are.
+       */
+      template<class T, class Bits>
+      void append_bits(std::string& buffer, const T value)
+      {
+        static_assert(sizeof(T) == sizeof(Bits), "The bits must be the same size as the value.");
+        Bits bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        char bytes[sizeof(Bits)];
+        store_little_endian(bytes, bits);
+        buffer.append(bytes, sizeof(bytes));
+      }
+
+      /**
+       * Read the raw bits of a float/double written with append_bits( ... )
+       * @param const char*& source where we are reading from, moved past the value.
+       * @param const char* end the end of the data.
+       * @return T the value.
+       */
+      template<class T, class Bits>
+      T read_bits(const char*& source, const char* end)
+      {
+        if (static_cast<size_t>(end - source) < sizeof(Bits))
+        {
+          throw truncated_error();
+        }
+        const auto bits = load_little_endian<Bits>(source);
+        source += sizeof(Bits);
+
+        T value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+      }
+
+      inline void append_float(std::string& buffer, const float value) { append_bits<float, unsigned int>(buffer, value); }
+      inline void append_double(std::string& buffer, const double value) { append_bits<double, unsigned long long>(buffer, value); }
+      inline float read_float(const char*& source, const char* end) { return read_bits<float, unsigned int>(source, end); }
+      inline double read_double(const char*& source, const char* end) { return read_bits<double, unsigned long long>(source, end); }
+
+      /**
+       * The kind of long double we wrote.
+       */
+      enum FloatingClass
+      {
+        FloatingClass_Positive = 0,
+        FloatingClass_Negative = 1,
+        FloatingClass_Infinity = 2,
+        FloatingClass_Negative_Infinity = 3,
+        FloatingClass_NaN = 4,
+
+        // the significand has more than 64 bits, (a 128 bit long double), it is written in 2 parts.
+        FloatingClass_Positive_Wide = 5,
+        FloatingClass_Negative_Wide = 6
+      };
+
+      static_assert(std::numeric_limits<long double>::digits <= 128, "A long double is written in at most 2 parts of 64 bits.");
+
+      /**
+       * Split a positive long double in its first 64 bits and the bits left over.
+       * @param long double value the value, positive and finite.
+       * @param long long& exponent the power of 2 of the part.
+       * @param unsigned long long& significand the odd significand of the part.
+       * @return long double the bits left over, 0 unless the significand has more than 64 bits.
+       */
+      inline long double split_floating(const long double value, long long& exponent, unsigned long long& significand)
+      {
+        // the significand is [0.5, 1) so its first 64 bits fit in 64 bits, we drop the trailing zeros
+        // so most values only need a couple of bytes.
+        int power = 0;
+        significand = static_cast<unsigned long long>(std::ldexp(std::frexp(value, &power), 64));
+        power -= 64;
+        const auto rest = value - std::ldexp(static_cast<long double>(significand), power);
+        while (0 != significand && 0 == (significand & 1))
+        {
+          significand >>= 1;
+          ++power;
+        }
+        exponent = power;
+        return rest;
+      }
+
+      /**
+       * Append a long double, the size of a long double is not the same everywhere
+       * so we write it as an odd significand and a power of 2.
+       * The significands of more than 64 bits are written in 2 parts, so all the digits are kept,
+       * a reader with a smaller long double rounds the value.
+       * @param std::string& buffer where we are writing.
+       * @param long double value the value.
+       */
+      inline void append_floating(std::string& buffer, const long double value)
+      {
+        if (std::isnan(value))
+        {
+          buffer += static_cast<char>(FloatingClass_NaN);
+          return;
+        }
+        if (std::isinf(value))
+        {
+          buffer += static_cast<char>(value < 0 ? FloatingClass_Negative_Infinity : FloatingClass_Infinity);
+          return;
+        }
+        long long exponent = 0;
+        unsigned long long significand = 0;
+        const auto rest = split_floating(std::fabs(value), exponent, significand);
+        if (0 == rest)
+        {
+          buffer += static_cast<char>(std::signbit(value) ? FloatingClass_Negative : FloatingClass_Positive);
+          append_varint(buffer, zigzag(exponent));
+          append_varint(buffer, significand);
+          return;
+        }
+
+        buffer += static_cast<char>(std::signbit(value) ? FloatingClass_Negative_Wide : FloatingClass_Positive_Wide);
+        append_varint(buffer, zigzag(exponent));
+        append_varint(buffer, significand);
+        split_floating(rest, exponent, significand);
+        append_varint(buffer, zigzag(exponent));
+        append_varint(buffer, significand);
+      }
+
+      /**
+       * Read a long double written with append_floating( ... )
+       * @param const char*& source where we are reading from, moved past the value.
+       * @param const char* end the end of the data.
+       * @return long double the value.
+       */
+      inline long double read_floating(const char*& source, const char* end)
+      {
+        const auto floatingClass = read_byte(source, end);
+        switch (floatingClass)
+        {
+        case FloatingClass_NaN:
+          return std::numeric_limits<long double>::quiet_NaN();
+
+        case FloatingClass_Infinity:
+          return std::numeric_limits<long double>::infinity();
+
+        case FloatingClass_Negative_Infinity:
+          return -std::numeric_limits<long double>::infinity();
+
+        case FloatingClass_Positive:
+        case FloatingClass_Negative:
+          {
+            const auto exponent = unzigzag(read_varint(source, end));
+            const auto significand = read_varint(source, end);
+            const auto value = std::ldexp(static_cast<long double>(significand), static_cast<int>(exponent));
+            return (FloatingClass_Negative == floatingClass) ? -value : value;
+          }
+
+        case FloatingClass_Positive_Wide:
+        case FloatingClass_Negative_Wide:
+          {
+            const auto exponent = unzigzag(read_varint(source, end));
+            const auto significand = read_varint(source, end);
+            const auto restExponent = unzigzag(read_varint(source, end));
+            const auto restSignificand = read_varint(source, end);
+            const auto value = std::ldexp(static_cast<long double>(significand), static_cast<int>(exponent))
+              + std::ldexp(static_cast<long double>(restSignificand), static_cast<int>(restExponent));
+            return (FloatingClass_Negative_Wide == floatingClass) ? -value : value;
+          }
+
+        default:
+          throw std::runtime_error("Unknown binary floating point.");
+        }
+      }
+
+      /**
+       * Move past some bytes.
+       * @param const char*& source where we are reading from, moved past the bytes.
+       * @param const char* end the end of the data.
+       * @param size_t len the number of bytes.
+       */
+      inline void skip(const char*& source, const char* end, size_t len)
+      {
+        if (static_cast<size_t>(end - source) < len)
+        {
+          throw truncated_error();
+        }
+        source += len;
+      }
+
+      /**
+       * Move past a long double written with append_floating( ... )
+       * @param const char*& source where we are reading from, moved past the value.
+       * @param const char* end the end of the data.
+       */
+      inline void skip_floating(const char*& source, const char* end)
+      {
+        const auto floatingClass = read_byte(source, end);
+        if (FloatingClass_Positive == floatingClass || FloatingClass_Negative == floatingClass)
+        {
+          read_varint(source, end);
+          read_varint(source, end);
+        }
+        else if (FloatingClass_Positive_Wide == floatingClass || FloatingClass_Negative_Wide == floatingClass)
+        {
+          for (int i = 0; i < 4; ++i)
+          {
+            read_varint(source, end);
+          }
+        }
+        else if (floatingClass > FloatingClass_Negative_Wide)
+        {
+          throw std::runtime_error("Unknown binary floating point.");
+        }
+      }
+
+      /**
+       * Append the stream header, the magic characters and the version.
+       * @param std::string& buffer where we are writing.
+       */
+      inline void append_header(std::string& buffer)
+      {
+        buffer.append(magic, sizeof(magic));
+        buffer += static_cast<char>(version);
+      }
+
+      /**
+       * Read and check the stream header.
+       * @param const char*& source where we are reading from, moved past the header.
+       * @param const char* end the end of the data.
+       */
+      inline void read_header(const char*& source, const char* end)
+      {
+        if (static_cast<size_t>(end - source) < header_size)
+        {
+          throw truncated_error();
+        }
+        if (0 != std::memcmp(source, magic, sizeof(magic)))
+        {
+          throw std::runtime_error("This is not a binary stream of values.");
+        }
+        if (static_cast<unsigned char>(source[sizeof(magic)]) > version)
+        {
+          throw std::runtime_error("The binary stream was written by a newer version.");
+        }
+        source += header_size;
+      }
+    }
+  }
+}
@@ -11,7 +11,7 @@ mkdir -p bin
 cd bin
 
 # Compile
-$CXX -c -o main.o ../examples/main.cpp -I../
+$CXX -c -o main.o ../examples/main.cpp -I../ -pthread
 
 # Link
-$CXX -o main main.o
\ No newline at end of file
+$CXX -o main main.o -pthread
\ No newline at end of file
@@ -0,0 +1,382 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <cstddef>        //  size_t
+#include <string>
+#include <utility>        //  std::index_sequence
+
+#include "binary.h"       //  little endian numbers
+#include "simd.h"         //  instruction sets
+
+/**
+ * The encodings of the blocks of slots of a column, (@see AnyColumnWriter).
+ * Each block is either a frame of reference, (a base, a step and the bits left over for each value),
+ * or runs of the same value, the writer picks the smallest one for each block.
+ * Sorted numbers with a regular step, (timestamps), only need the bits of their jitter,
+ * small numbers, (counters), only need their own bits, and repeated values are runs.
+ */
+namespace myodd {
+  namespace dynamic {
+    namespace _Compress
+    {
+      /**
+       * The number of values in each block, only the last block can have less.
+       */
+      static constexpr size_t block_size = 128;
+
+      /**
+       * How the slots of a block are encoded.
+       */
+      enum Encoding : unsigned char
+      {
+        // value[i] = base + i * step + the width bits of value i.
+        Encoding_Frame = 0,
+
+        // the value and the index of the last value of each run.
+        Encoding_Run = 1
+      };
+
+      /**
+       * The size of a run, the value and the index of the last value of the run in the block.
+       */
+      static constexpr size_t run_size = 9;
+
+      /**
+       * The number of bits needed to hold a number.
+       * @param unsigned long long value the number.
+       * @return unsigned int the number of bits, (0 for 0).
+       */
+      inline unsigned int bit_width(unsigned long long value)
+      {
+        unsigned int width = 0;
+        for (; value != 0; value >>= 1)
+        {
+          ++width;
+        }
+        return width;
+      }
+
+      /**
+       * The number of bytes needed to pack some numbers.
+       * @param size_t count the number of numbers.
+       * @param unsigned int width the number of bits of each number.
+       * @return size_t the number of bytes.
+       */
+      inline size_t packed_size(size_t count, unsigned int width)
+      {
+        return (count * width + 7) / 8;
+      }
+
+      /**
+       * Append numbers, width bits each, lowest bits first.
+       * @param std::string& buffer where we are writing.
+       * @param const unsigned long long* values the numbers, they must fit in width bits.
+       * @param size_t count the number of numbers.
+       * @param unsigned int width the number of bits of each number.
+       */
+      inline void pack(std::string& buffer, const unsigned long long* values, size_t count, unsigned int width)
+      {
+        // we write 8 bytes at a time, (and one more when a number is across 9 bytes).
+        const auto start = buffer.size();
+        const auto size = packed_size(count, width);
+        buffer.append(size + 9, '\0');
+        char* destination = &buffer[start];
+        for (size_t i = 0; width > 0 && i < count; ++i)
+        {
+          const auto bit = i * width;
+          const auto shift = static_cast<unsigned int>(bit & 7);
+          char* word = destination + (bit >> 3);
+          _Binary::store_little_endian(word, _Binary::load_little_endian<unsigned long long>(word) | (values[i] << shift));
+          if (shift + width > 64)
+          {
+            word[8] = static_cast<char>(static_cast<unsigned char>(word[8]) | (values[i] >> (64 - shift)));
+          }
+        }
+        buffer.resize(start + size);
+      }
+
+      /**
+       * Read one of the numbers written by pack( ... )
+       * The data must have 9 readable bytes after the packed numbers, (it is never the end of a column).
+       * @param const char* source the packed numbers.
+       * @param size_t index the index of the number.
+       * @param unsigned int width the number of bits of each number.
+       * @return unsigned long long the number.
+       */
+      inline unsigned long long unpack_one(const char* source, size_t index, unsigned int width)
+      {
+        if (0 == width)
+        {
+          return 0;
+        }
+        const auto bit = index * width;
+        const auto shift = static_cast<unsigned int>(bit & 7);
+        const char* word = source + (bit >> 3);
+        auto value = _Binary::load_little_endian<unsigned long long>(word) >> shift;
+        if (shift + width > 64)
+        {
+          value |= static_cast<unsigned long long>(static_cast<unsigned char>(word[8])) << (64 - shift);
+        }
+        return width == 64 ? value : value & ((1ull << width) - 1);
+      }
+
+      /**
+       * Decode a frame of reference block, the width is known at compile time so the
+       * shifts and the masks are constants and the loop has no branches left in it.
+       * @param const char* source the packed numbers.
+       * @param size_t count the number of values.
+       * @param unsigned long long base the first value.
+       * @param unsigned long long step what we add for each value.
+       * @param unsigned long long* values where we write the values.
+       */
+      template<unsigned int Width>
+      void unpack_frame(const char* source, size_t count, unsigned long long base, unsigned long long step, unsigned long long* values)
+      {
+        static constexpr unsigned long long mask = Width == 64 ? ~0ull : (1ull << Width) - 1;
+        for (size_t i = 0; i < count; ++i)
+        {
+          unsigned long long bits = 0;
+          if (Width > 0)
+          {
+            const auto bit = i * Width;
+            const auto shift = static_cast<unsigned int>(bit & 7);
+            const char* word = source + (bit >> 3);
+            bits = _Binary::load_little_endian<unsigned long long>(word) >> shift;
+            if (Width > 57 && shift + Width > 64)
+            {
+              bits |= static_cast<unsigned long long>(static_cast<unsigned char>(word[8])) << ((64 - shift) & 63);
+            }
+          }
+          values[i] = base + i * step + (bits & mask);
+        }
+      }
+
+#if MYODD_ANY_SIMD
+      /**
+       * Decode a frame of reference block, 4 values at a time, each value is gathered from the byte
+       * it starts at and shifted into place, the widths over 57 bits can be across 9 bytes so they are not done here.
+       * @see unpack_frame( ... )
+       * @param unsigned int width the number of bits of each number, (1 to 57).
+       */
+      MYODD_ANY_TARGET_AVX2
+      inline void unpack_frame_avx2(const char* source, size_t count, unsigned int width, unsigned long long base, unsigned long long step, unsigned long long* values)
+      {
+        const __m256i mask = _mm256_set1_epi64x(static_cast<long long>((1ull << width) - 1));
+        const __m256i seven = _mm256_set1_epi64x(7);
+        const __m256i bitStep = _mm256_set1_epi64x(static_cast<long long>(4 * width));
+        const __m256i valueStep = _mm256_set1_epi64x(static_cast<long long>(4 * step));
+        __m256i bits = _mm256_set_epi64x(3ll * width, 2ll * width, width, 0);
+        __m256i start = _mm256_set_epi64x(static_cast<long long>(base + 3 * step), static_cast<long long>(base + 2 * step), static_cast<long long>(base + step), static_cast<long long>(base));
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+          const __m256i words = _mm256_i64gather_epi64(reinterpret_cast<const long long*>(source), _mm256_srli_epi64(bits, 3), 1);
+          const __m256i residuals = _mm256_and_si256(_mm256_srlv_epi64(words, _mm256_and_si256(bits, seven)), mask);
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), _mm256_add_epi64(start, residuals));
+          bits = _mm256_add_epi64(bits, bitStep);
+          start = _mm256_add_epi64(start, valueStep);
+        }
+        for (; i < count; ++i)
+        {
+          values[i] = base + i * step + unpack_one(source, i, width);
+        }
+      }
+#endif
+
+      typedef void (*unpack_frame_function)(const char*, size_t, unsigned long long, unsigned long long, unsigned long long*);
+
+      /**
+       * Get the decoder of a width, one for each width from 0 to 64.
+       */
+      template<size_t... Widths>
+      unpack_frame_function unpack_frame_for(unsigned int width, std::index_sequence<Widths...>)
+      {
+        static constexpr unpack_frame_function functions[] = { &unpack_frame<static_cast<unsigned int>(Widths)>... };
+        return functions[width];
+      }
+
+      /**
+       * Decode a frame of reference block.
+       * @see unpack_frame( ... )
+       * @param unsigned int width the number of bits of each number, (0 to 64).
+       */
+      inline void unpack_frame(const char* source, size_t count, unsigned int width, unsigned long long base, unsigned long long step, unsigned long long* values)
+      {
+#if MYODD_ANY_SIMD && MYODD_ANY_LITTLE_ENDIAN
+        static const auto avx2 = _Simd::instruction_set() >= _Simd::InstructionSet_AVX2;
+        if (avx2 && width > 0 && width <= 57)
+        {
+          unpack_frame_avx2(source, count, width, base, step, values);
+          return;
+        }
+#endif
+        unpack_frame_for(width, std::make_index_sequence<65>())(source, count, base, step, values);
+      }
+
+      /**
+       * Work out the base and the width of a frame of reference block for a given step.
+       * The numbers are compared as signed numbers, the maths wrap around so every step gives the values back.
+       * @param const unsigned long long* values the values.
+       * @param size_t count the number of values, at least 1.
+       * @param unsigned long long step what we add for each value.
+       * @param unsigned long long& base the base of the block.
+       * @return unsigned int the width of the block.
+       */
+      inline unsigned int frame_width(const unsigned long long* values, size_t count, unsigned long long step, unsigned long long& base)
+      {
+        auto lowest = static_cast<long long>(values[0]);
+        auto highest = lowest;
+        for (size_t i = 1; i < count; ++i)
+        {
+          const auto residual = static_cast<long long>(values[i] - i * step);
+          lowest = residual < lowest ? residual : lowest;
+          highest = residual > highest ? residual : highest;
+        }
+        base = static_cast<unsigned long long>(lowest);
+        return bit_width(static_cast<unsigned long long>(highest) - static_cast<unsigned long long>(lowest));
+      }
+
+      /**
+       * Append the residuals of a frame of reference block.
+       * @param std::string& buffer where we are writing.
+       * @param const unsigned long long* values the values.
+       * @param size_t count the number of values.
+       * @param unsigned long long base the base of the block.
+       * @param unsigned long long step what we add for each value.
+       * @param unsigned int width the width of the block.
+       */
+      inline void append_frame(std::string& buffer, const unsigned long long* values, size_t count, unsigned long long base, unsigned long long step, unsigned int width)
+      {
+        unsigned long long residuals[block_size];
+        for (size_t i = 0; i < count; ++i)
+        {
+          residuals[i] = values[i] - base - i * step;
+        }
+        pack(buffer, residuals, count, width);
+      }
+
+      /**
+       * Count the runs of the same value.
+       * @param const unsigned long long* values the values.
+       * @param size_t count the number of values.
+       * @return size_t the number of runs.
+       */
+      inline size_t count_runs(const unsigned long long* values, size_t count)
+      {
+        size_t runs = count > 0 ? 1 : 0;
+        for (size_t i = 1; i < count; ++i)
+        {
+          runs += values[i] != values[i - 1];
+        }
+        return runs;
+      }
+
+      /**
+       * Append the runs of a block, all the values and then the index of the last value of each run.
+       * @param std::string& buffer where we are writing.
+       * @param const unsigned long long* values the values.
+       * @param size_t count the number of values, at most block_size.
+       */
+      inline void append_runs(std::string& buffer, const unsigned long long* values, size_t count)
+      {
+        std::string ends;
+        for (size_t i = 0; i < count; ++i)
+        {
+          if (i + 1 == count || values[i + 1] != values[i])
+          {
+            char bytes[8];
+            _Binary::store_little_endian(bytes, values[i]);
+            buffer.append(bytes, sizeof(bytes));
+            ends += static_cast<char>(i);
+          }
+        }
+        buffer += ends;
+      }
+
+      /**
+       * Read one value of a block of runs.
+       * @param const char* source the runs.
+       * @param size_t runs the number of runs.
+       * @param size_t index the index of the value in the block.
+       * @return unsigned long long the value.
+       */
+      inline unsigned long long run_value(const char* source, size_t runs, size_t index)
+      {
+        // the ends are sorted, we look for the first run that ends at or after the index.
+        const auto* ends = reinterpret_cast<const unsigned char*>(source + runs * 8);
+        size_t low = 0;
+        size_t high = runs - 1;
+        while (low < high)
+        {
+          const auto middle = (low + high) / 2;
+          if (ends[middle] < index)
+          {
+            low = middle + 1;
+          }
+          else
+          {
+            high = middle;
+          }
+        }
+        return _Binary::load_little_endian<unsigned long long>(source + low * 8);
+      }
+
+      /**
+       * Check that the runs end on the last value of the block, so every value is in a run.
+       * @param const char* source the runs.
+       * @param size_t runs the number of runs, at least 1.
+       * @param size_t count the number of values in the block.
+       * @return bool if the last run ends on, or after, the last value.
+       */
+      inline bool runs_cover(const char* source, size_t runs, size_t count)
+      {
+        const auto* ends = reinterpret_cast<const unsigned char*>(source + runs * 8);
+        return static_cast<size_t>(ends[runs - 1]) + 1 >= count;
+      }
+
+      /**
+       * Decode a block of runs, the runs must cover the block, @see runs_cover( ... )
+       * @param const char* source the runs.
+       * @param size_t runs the number of runs.
+       * @param size_t count the number of values in the block.
+       * @param unsigned long long* values where we write the values.
+       */
+      inline void unpack_runs(const char* source, size_t runs, size_t count, unsigned long long* values)
+      {
+        const auto* ends = reinterpret_cast<const unsigned char*>(source + runs * 8);
+        size_t i = 0;
+        for (size_t run = 0; run < runs; ++run)
+        {
+          const auto value = _Binary::load_little_endian<unsigned long long>(source + run * 8);
+          for (; i <= ends[run] && i < count; ++i)
+          {
+            values[i] = value;
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,161 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <cstddef>        //  size_t
+#include <cstring>        //  memchr
+
+#include "simd.h"         //  instruction sets
+
+/**
+ * Find the characters that end a field of comma separated values, (RFC 4180)
+ * The delimiter can be any single character, (',', ';', '\t' and so on).
+ */
+namespace myodd {
+  namespace dynamic {
+    namespace _Csv
+    {
+      /**
+       * The quote around a field, a quote inside a quoted field is written twice.
+       */
+      static constexpr char quote = '"';
+
+      /**
+       * Check if a character ends an unquoted field.
+       * @param const char c the character we are checking.
+       * @param const char delimiter the delimiter between fields.
+       * @return bool if the field ends before that character.
+       */
+      inline bool is_field_end(const char c, const char delimiter)
+      {
+        return c == delimiter || c == '\n' || c == '\r';
+      }
+
+      /**
+       * Find the end of an unquoted field, one character at a time.
+       * @param const char* source the start of the field.
+       * @param const char* end the end of the data.
+       * @param const char delimiter the delimiter between fields.
+       * @return const char* the delimiter or the end of line, or end if there is none.
+       */
+      inline const char* find_field_end_scalar(const char* source, const char* end, const char delimiter)
+      {
+        while (source != end && !is_field_end(*source, delimiter))
+        {
+          ++source;
+        }
+        return source;
+      }
+
+#if MYODD_ANY_SIMD
+      /**
+       * Find the end of an unquoted field, 16 characters at a time.
+       * @see find_field_end_scalar
+       */
+      inline const char* find_field_end_sse2(const char* source, const char* end, const char delimiter)
+      {
+        const __m128i delimiters = _mm_set1_epi8(delimiter);
+        const __m128i newlines = _mm_set1_epi8('\n');
+        const __m128i returns = _mm_set1_epi8('\r');
+        for (; end - source >= 16; source += 16)
+        {
+          const __m128i characters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+          const __m128i found = _mm_or_si128(_mm_cmpeq_epi8(characters, delimiters),
+            _mm_or_si128(_mm_cmpeq_epi8(characters, newlines), _mm_cmpeq_epi8(characters, returns)));
+          const auto mask = static_cast<unsigned int>(_mm_movemask_epi8(found));
+          if (mask != 0)
+          {
+            return source + _Simd::trailing_zeros(mask);
+          }
+        }
+        return find_field_end_scalar(source, end, delimiter);
+      }
+
+      /**
+       * Find the end of an unquoted field, 32 characters at a time.
+       * @see find_field_end_scalar
+       */
+      MYODD_ANY_TARGET_AVX2
+      inline const char* find_field_end_avx2(const char* source, const char* end, const char delimiter)
+      {
+        const __m256i delimiters = _mm256_set1_epi8(delimiter);
+        const __m256i newlines = _mm256_set1_epi8('\n');
+        const __m256i returns = _mm256_set1_epi8('\r');
+        for (; end - source >= 32; source += 32)
+        {
+          const __m256i characters = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source));
+          const __m256i found = _mm256_or_si256(_mm256_cmpeq_epi8(characters, delimiters),
+            _mm256_or_si256(_mm256_cmpeq_epi8(characters, newlines), _mm256_cmpeq_epi8(characters, returns)));
+          const auto mask = static_cast<unsigned int>(_mm256_movemask_epi8(found));
+          if (mask != 0)
+          {
+            return source + _Simd::trailing_zeros(mask);
+          }
+        }
+        return find_field_end_sse2(source, end, delimiter);
+      }
+#endif
+
+      /**
+       * Find the end of an unquoted field using the best instruction set.
+       * Most fields are short, so we check the first few characters one at a time.
+       * @see find_field_end_scalar
+       */
+      inline const char* find_field_end(const char* source, const char* end, const char delimiter)
+      {
+#if MYODD_ANY_SIMD
+        static const auto avx2 = _Simd::instruction_set() >= _Simd::InstructionSet_AVX2;
+        const char* shortEnd = (end - source > 16) ? source + 16 : end;
+        for (; source != shortEnd; ++source)
+        {
+          if (is_field_end(*source, delimiter))
+          {
+            return source;
+          }
+        }
+        if (source == end)
+        {
+          return end;
+        }
+        return avx2 ? find_field_end_avx2(source, end, delimiter) : find_field_end_sse2(source, end, delimiter);
+#else
+        return find_field_end_scalar(source, end, delimiter);
+#endif
+      }
+
+      /**
+       * Find the next quote in a quoted field.
+       * @param const char* source where we are in the field.
+       * @param const char* end the end of the data.
+       * @return const char* the quote, or end if there is none.
+       */
+      inline const char* find_quote(const char* source, const char* end)
+      {
+        const auto found = static_cast<const char*>(std::memchr(source, quote, static_cast<size_t>(end - source)));
+        return found ? found : end;
+      }
+    }
+  }
+}
@@ -0,0 +1,320 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <cerrno>         //  errno / EINTR
+#include <cstddef>        //  size_t
+#include <cstring>        //  std::memmove
+#include <istream>        //  std::istream
+#include <stdexcept>      //  std::runtime_error
+#include <string>
+
+#if defined(_WIN32)
+#   include <io.h>        //  _read / _write
+#else
+#   include <unistd.h>    //  read / write
+#endif
+
+/**
+ * The helpers used to read and write the values to a file descriptor, (a file, a pipe or a socket),
+ * the readers and the writers of all the formats share the buffers below.
+ */
+namespace myodd {
+  namespace dynamic {
+    namespace _Descriptor
+    {
+      /**
+       * Write all the bytes to a file descriptor.
+       * @param int fd the file descriptor.
+       * @param const char* data the bytes we are writing.
+       * @param size_t len the number of bytes.
+       */
+      inline void write_all(int fd, const char* data, size_t len)
+      {
+        while (len > 0)
+        {
+#if defined(_WIN32)
+          const auto written = _write(fd, data, static_cast<unsigned int>(len > 0x40000000 ? 0x40000000 : len));
+#else
+          const auto written = ::write(fd, data, len);
+#endif
+          if (written < 0)
+          {
+            if (EINTR == errno)
+            {
+              continue;
+            }
+            throw std::runtime_error("Unable to write to the file descriptor.");
+          }
+          data += written;
+          len -= static_cast<size_t>(written);
+        }
+      }
+
+      /**
+       * Read some bytes from a file descriptor.
+       * @param int fd the file descriptor.
+       * @param char* data where we are reading to.
+       * @param size_t len the most bytes we want.
+       * @return size_t the number of bytes we read, 0 at the end of the file.
+       */
+      inline size_t read_some(int fd, char* data, size_t len)
+      {
+        for (;;)
+        {
+#if defined(_WIN32)
+          const auto read = _read(fd, data, static_cast<unsigned int>(len > 0x40000000 ? 0x40000000 : len));
+#else
+          const auto read = ::read(fd, data, len);
+#endif
+          if (read < 0)
+          {
+            if (EINTR == errno)
+            {
+              continue;
+            }
+            throw std::runtime_error("Unable to read from the file descriptor.");
+          }
+          return static_cast<size_t>(read);
+        }
+      }
+
+      /**
+       * The data of a reader, read from a file descriptor or a stream a block at a time.
+       * The reader keeps where it is in the data, (source), and where the data ends, (end),
+       * when it needs more, what it has not used yet is moved to the start of the buffer and a block is read after it.
+       * We read at least as much as we already have, so a value longer than a block is not read over and over again.
+       */
+      class Reader
+      {
+      public:
+        /**
+         * Nothing to read, the reader has all its data already, (or is given it with Append( ... )).
+         */
+        Reader() :
+          _fd(-1),
+          _stream(nullptr),
+          _blockSize(0),
+          _endOfFile(true)
+        {
+        }
+
+        /**
+         * Read from a file descriptor.
+         * @param int fd the file descriptor, it is not closed.
+         * @param size_t blockSize how much we read at a time.
+         */
+        Reader(int fd, size_t blockSize) :
+          _fd(fd),
+          _stream(nullptr),
+          _blockSize(blockSize),
+          _endOfFile(fd < 0)
+        {
+        }
+
+        /**
+         * Read from a stream, its eofbit is set once we reach the end of it.
+         * @param std::istream& stream the stream, it must outlive us.
+         * @param size_t blockSize how much we read at a time.
+         */
+        Reader(std::istream& stream, size_t blockSize) :
+          _fd(-1),
+          _stream(&stream),
+          _blockSize(blockSize),
+          _endOfFile(false)
+        {
+        }
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        /**
+         * If there could be more to read.
+         * @return bool false if we have nothing to read from, or we reached the end of it.
+         */
+        bool CanRead() const
+        {
+          return !_endOfFile;
+        }
+
+        /**
+         * Read more data after what the reader has not used yet.
+         * @param const char*& source where the data the reader has not used yet starts, it is set to the start of the buffer.
+         * @param const char*& end where the data ends, it is set to the end of what we read.
+         * @return size_t the number of bytes we read, 0 at the end of the file, (the data might still have moved).
+         */
+        size_t Fill(const char*& source, const char*& end)
+        {
+          if (_endOfFile)
+          {
+            return 0;
+          }
+
+          // keep what has not been used yet and make room for a block after it.
+          const auto unread = static_cast<size_t>(end - source);
+          const auto size = unread > _blockSize ? unread : _blockSize;
+          Keep(source, unread);
+          _data.resize(unread + size);
+
+          const auto read = nullptr != _stream ?
+            static_cast<size_t>(_stream->rdbuf()->sgetn(&_data[unread], static_cast<std::streamsize>(size))) :
+            read_some(_fd, &_data[unread], size);
+          _data.resize(unread + read);
+          source = _data.data();
+          end = source + _data.size();
+
+          if (0 == read)
+          {
+            _endOfFile = true;
+            if (nullptr != _stream)
+            {
+              _stream->setstate(std::ios_base::eofbit);
+            }
+          }
+          return read;
+        }
+
+        /**
+         * Add some data after what the reader has not used yet, (data that arrives a chunk at a time).
+         * @param const char*& source where the data the reader has not used yet starts, it is set to the start of the buffer.
+         * @param const char*& end where the data ends, it is set to the end of the data we added.
+         * @param const char* data the data, it is copied.
+         * @param size_t len the size of the data.
+         */
+        void Append(const char*& source, const char*& end, const char* data, size_t len)
+        {
+          Keep(source, static_cast<size_t>(end - source));
+          _data.append(data, len);
+          source = _data.data();
+          end = source + _data.size();
+        }
+
+      private:
+        /**
+         * Move the data that has not been used yet to the start of the buffer, and drop what is after it.
+         * @param const char* source the data, in the buffer or not.
+         * @param size_t unread the size of the data.
+         */
+        void Keep(const char* source, size_t unread)
+        {
+          if (unread > 0 && source != _data.data())
+          {
+            std::memmove(&_data[0], source, unread);
+          }
+          _data.resize(unread);
+        }
+
+        std::string _data;
+        int _fd;
+        std::istream* _stream;
+        const size_t _blockSize;
+        bool _endOfFile;
+      };
+
+      /**
+       * The buffer of a writer, either the buffer we were given, or ours that we write to a file descriptor once we have enough.
+       * What is left is written when we are destroyed, call Flush() if you need to know about errors.
+       */
+      class Writer
+      {
+      public:
+        /**
+         * Append to a buffer.
+         * @param std::string& buffer the buffer, it must outlive us.
+         */
+        explicit Writer(std::string& buffer) :
+          _buffer(buffer),
+          _fd(-1)
+        {
+        }
+
+        /**
+         * Write to a file descriptor.
+         * @param int fd the file descriptor, it is not closed.
+         */
+        explicit Writer(int fd) :
+          _buffer(_pending),
+          _fd(fd)
+        {
+        }
+
+        ~Writer()
+        {
+          try
+          {
+            Flush();
+          }
+          catch (...)
+          {
+          }
+        }
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        /**
+         * Where the writer appends what it writes.
+         * @return std::string& the buffer.
+         */
+        std::string& Buffer()
+        {
+          return _buffer;
+        }
+
+        /**
+         * Write what we have to the file descriptor once we have enough.
+         */
+        void FlushIfNeeded()
+        {
+          if (_fd >= 0 && _pending.size() >= FlushSize)
+          {
+            Flush();
+          }
+        }
+
+        /**
+         * Write what we have to the file descriptor.
+         */
+        void Flush()
+        {
+          if (_fd < 0 || _pending.empty())
+          {
+            return;
+          }
+          write_all(_fd, _pending.data(), _pending.size());
+          _pending.clear();
+        }
+
+      private:
+        // how much we buffer before we write to the file descriptor.
+        static constexpr size_t FlushSize = 64 * 1024;
+
+        std::string _pending;
+        std::string& _buffer;
+        int _fd;
+      };
+    }
+  }
+}
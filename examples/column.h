@@ -0,0 +1,310 @@
+/*
+ * column.h
+ *
+ *  Sample of writing columns of values and reading them where they are,
+ *  each block of 128 values is a frame of reference, (with or without a step), or runs.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
+#include <assert.h>
+#include <iostream>
+
+#include "../any.h"
+#include "../anycolumn.h"
+
+/**
+ * Write integers to a column.
+ * @param const std::vector<long long>& numbers the numbers.
+ * @return std::string the column.
+ */
+std::string SampleColumnOf(const std::vector<long long>& numbers)
+{
+  std::string data;
+  ::myodd::dynamic::AnyColumnWriter writer(data);
+  for (const auto number : numbers)
+  {
+    writer.Write(number);
+  }
+  writer.Close();
+  return data;
+}
+
+/**
+ * Read a column back, one value at a time and a block at a time, it must be the numbers we wrote.
+ * @param const std::string& data the column.
+ * @param const std::vector<long long>& numbers the numbers we wrote.
+ */
+void SampleColumnCheck(const std::string& data, const std::vector<long long>& numbers)
+{
+  const ::myodd::dynamic::AnyColumn column(data.data(), data.size());
+  assert(column.Size() == numbers.size());
+  for (size_t i = 0; i < numbers.size(); ++i)
+  {
+    assert(column.Integer(i) == numbers[i]);
+    assert(column[i] == numbers[i]);
+    assert(column.Type(i) == ::myodd::dynamic::Integer_long_long_int);
+  }
+
+  // the whole column, and parts that start and end in the middle of the blocks.
+  std::vector<long long> values(numbers.size());
+  column.Integers(0, values.size(), values.data());
+  assert(values == numbers);
+  if (numbers.size() > 200)
+  {
+    column.Integers(100, 100, values.data());
+    assert(std::equal(values.begin(), values.begin() + 100, numbers.begin() + 100));
+  }
+}
+
+void SampleColumn()
+{
+  const size_t count = 1280;
+  std::mt19937_64 random(42);
+
+  // runs, frames with a step, frames without a step and values that need all their bits.
+  std::vector<long long> constant, timestamps, counters, noise;
+  for (size_t i = 0; i < count; ++i)
+  {
+    constant.push_back(i < count / 2 ? 7 : -7);
+    timestamps.push_back(1600000000LL + static_cast<long long>(i) * 60 + (i % 4 == 1 ? 1 : 0));
+    counters.push_back(static_cast<long long>(i % 16));
+    noise.push_back(static_cast<long long>(random()));
+  }
+
+  const auto constantData = SampleColumnOf(constant);
+  const auto timestampsData = SampleColumnOf(timestamps);
+  const auto countersData = SampleColumnOf(counters);
+  const auto noiseData = SampleColumnOf(noise);
+  SampleColumnCheck(constantData, constant);
+  SampleColumnCheck(timestampsData, timestamps);
+  SampleColumnCheck(countersData, counters);
+  SampleColumnCheck(noiseData, noise);
+
+  // a run is 9 bytes, the timestamps only keep 1 bit of jitter, the counters 4 bits and the noise all 64.
+  assert(constantData.size() < timestampsData.size());
+  assert(timestampsData.size() < countersData.size());
+  assert(countersData.size() < noiseData.size());
+  assert(noiseData.size() > count * 8);
+
+  // negative numbers, a descending step and a last block that is not full.
+  std::vector<long long> mixed;
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    mixed.push_back(i < 500 ? -static_cast<long long>(i) * 1000 : static_cast<long long>(i % 3) - 1);
+  }
+  SampleColumnCheck(SampleColumnOf(mixed), mixed);
+
+  // every width, decoded by the function the cpu uses, (4 values at a time with AVX2), and one value at a time.
+  for (unsigned int width = 0; width <= 64; ++width)
+  {
+    for (size_t values = 1; values <= ::myodd::dynamic::_Compress::block_size; values += 31)
+    {
+      const auto mask = width == 64 ? ~0ull : (1ull << width) - 1;
+      std::vector<unsigned long long> numbers(values);
+      for (auto& number : numbers)
+      {
+        number = random() & mask;
+      }
+
+      std::string packed;
+      ::myodd::dynamic::_Compress::pack(packed, numbers.data(), values, width);
+      packed.append(16, '\0');
+
+      std::vector<unsigned long long> unpacked(values);
+      ::myodd::dynamic::_Compress::unpack_frame(packed.data(), values, width, 1000, 3, unpacked.data());
+      for (size_t i = 0; i < values; ++i)
+      {
+        assert(unpacked[i] == 1000 + i * 3 + numbers[i]);
+        assert(::myodd::dynamic::_Compress::unpack_one(packed.data(), i, width) == numbers[i]);
+      }
+    }
+  }
+
+  // the end of the last run of a block is moved before the end of the block, (a corrupted file).
+  {
+    std::vector<long long> runs(128, 5);
+    std::fill(runs.begin() + 64, runs.end(), 1LL << 40);
+    auto data = SampleColumnOf(runs);
+    SampleColumnCheck(data, runs);
+
+    // the 2 values and then the 2 ends.
+    const auto footer = data.data() + data.size() - ::myodd::dynamic::_Binary::column_footer_size;
+    const auto blocks = ::myodd::dynamic::_Binary::load_little_endian<unsigned long long>(footer + 16);
+    assert(data[blocks + 16] == 63 && data[blocks + 17] == 127);
+    data[blocks + 17] = 100;
+
+    const ::myodd::dynamic::AnyColumn column(data.data(), data.size());
+    bool corrupted = false;
+    try
+    {
+      std::vector<long long> values(128);
+      column.Integers(0, values.size(), values.data());
+    }
+    catch (const std::runtime_error&)
+    {
+      corrupted = true;
+    }
+    assert(corrupted);
+    (void)corrupted;
+  }
+
+  // values of every kind, the numbers are in their slot and everything else in the heap.
+  {
+    const std::vector<::myodd::dynamic::Any> values = {
+      12, -3LL, 4294967295u, 18446744073709551615ull, true, 'a',
+      0.5f, -2.25, 1.5L, nullptr,
+      "Hello", "", std::string(300, 'x'), L"Wide", "12.5"
+    };
+    std::string data;
+    {
+      ::myodd::dynamic::AnyColumnWriter writer(data);
+      for (const auto& value : values)
+      {
+        writer.Write(value);
+      }
+
+      // a closed column cannot be written to, (and the destructor does not close it again).
+      writer.Close();
+      bool closed = false;
+      try
+      {
+        writer.Write(1);
+      }
+      catch (const std::runtime_error&)
+      {
+        closed = true;
+      }
+      assert(closed);
+      (void)closed;
+    }
+
+    const ::myodd::dynamic::AnyColumn column(data.data(), data.size());
+    assert(column.Size() == values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+      assert(column.Type(i) == values[i].Type());
+      assert(column[i].Type() == values[i].Type());
+      assert(column[i] == values[i]);
+    }
+    assert(column.Integer(0) == 12);
+    assert(column.Integer(3) == -1);
+    assert(column.Floating(3) == 18446744073709551615.0L);
+    assert(column.Floating(7) == -2.25L);
+    assert(column.Floating(8) == 1.5L);
+    assert(column.Integer(14) == 12);
+    assert(column[13] == L"Wide");
+#if MYODD_ANY_CPP17
+    assert(column.Characters(10) == "Hello");
+    assert(column.Characters(11).empty());
+    assert(column.Characters(12) == std::string(300, 'x'));
+    bool characters = true;
+    try
+    {
+      column.Characters(0);
+    }
+    catch (const std::bad_cast&)
+    {
+      characters = false;
+    }
+    assert(!characters);
+    (void)characters;
+#endif
+
+    // the strings borrow their characters from the column.
+    const std::string hello = column[10];
+    assert(hello == "Hello");
+
+    // past the end.
+    bool past = false;
+    try
+    {
+      column[values.size()];
+    }
+    catch (const std::out_of_range&)
+    {
+      past = true;
+    }
+    assert(past);
+    past = false;
+    try
+    {
+      long long numbers[2];
+      column.Integers(values.size() - 1, 2, numbers);
+    }
+    catch (const std::out_of_range&)
+    {
+      past = true;
+    }
+    assert(past);
+    (void)past;
+
+    // data that is not a column, or a column that was cut short.
+    for (const auto& wrong : { std::string("not a column of values, just some text that is long enough"), data.substr(0, data.size() - 1) })
+    {
+      bool rejected = false;
+      try
+      {
+        ::myodd::dynamic::AnyColumn other(wrong.data(), wrong.size());
+      }
+      catch (const std::runtime_error&)
+      {
+        rejected = true;
+      }
+      assert(rejected);
+      (void)rejected;
+    }
+  }
+
+  // the same column written to a file descriptor, it is written 64Kb at a time.
+  {
+    std::vector<long long> numbers;
+    for (size_t i = 0; i < 100000; ++i)
+    {
+      numbers.push_back(static_cast<long long>(random() % 1000000));
+    }
+
+    std::FILE* file = std::tmpfile();
+    assert(file != nullptr);
+    {
+      ::myodd::dynamic::AnyColumnWriter writer(fileno(file));
+      for (size_t i = 0; i < numbers.size(); ++i)
+      {
+        // some strings, so the heap is flushed as well.
+        if (i % 1000 == 0)
+        {
+          writer.Write(std::to_string(numbers[i]));
+        }
+        else
+        {
+          writer.Write(numbers[i]);
+        }
+      }
+    }
+
+    std::string data;
+    std::rewind(file);
+    char buffer[4096];
+    for (size_t read; (read = std::fread(buffer, 1, sizeof(buffer), file)) > 0;)
+    {
+      data.append(buffer, read);
+    }
+    std::fclose(file);
+
+    const ::myodd::dynamic::AnyColumn column(data.data(), data.size());
+    assert(column.Size() == numbers.size());
+    std::vector<long long> values(numbers.size());
+    column.Integers(0, values.size(), values.data());
+    assert(values == numbers);
+    assert(column.Type(1000) == ::myodd::dynamic::Character_char);
+    assert(column[1000] == std::to_string(numbers[1000]));
+  }
+
+  std::cout << "All columns are good!";
+}
@@ -0,0 +1,181 @@
+/*
+ * compare.h
+ *
+ *  Sample of comparing numbers of different types
+ */
+
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <cstring>
+#include <cstdlib>
+#include <assert.h>
+#include <iostream>
+
+#include "../any.h"
+
+/**
+ * A number as it would be in c++, we use it to check how the values compare.
+ * Integers are compared exactly, (-1 < 4294967295u), booleans are compared as unsigned integers
+ * and a floating point compares the other value as the largest floating point of both, (int and float are compared as floats).
+ */
+struct SampleNumber
+{
+  enum Kind
+  {
+    Kind_Boolean,
+    Kind_Signed,
+    Kind_Unsigned,
+    Kind_Float,
+    Kind_Double,
+    Kind_Long_Double
+  };
+
+  template<class T>
+  static SampleNumber Create(const T value)
+  {
+    SampleNumber number;
+    number.kind = std::is_floating_point<T>::value ? (sizeof(T) == sizeof(float) ? Kind_Float : (std::is_same<T, double>::value ? Kind_Double : Kind_Long_Double))
+                                                   : (std::is_same<T, bool>::value ? Kind_Boolean : (std::is_signed<T>::value ? Kind_Signed : Kind_Unsigned));
+    number.integer = static_cast<long long>(value);
+    number.floating = static_cast<long double>(value);
+    return number;
+  }
+
+  template<class F>
+  F As() const
+  {
+    switch (kind)
+    {
+    case Kind_Boolean:
+    case Kind_Signed:
+      return static_cast<F>(integer);
+    case Kind_Unsigned:
+      return static_cast<F>(static_cast<unsigned long long>(integer));
+    default:
+      return static_cast<F>(floating);
+    }
+  }
+
+  template<class F>
+  static ::myodd::dynamic::Any::Ordering OrderAs(const SampleNumber& lhs, const SampleNumber& rhs)
+  {
+    const auto l = lhs.As<F>();
+    const auto r = rhs.As<F>();
+    return l < r ? ::myodd::dynamic::Any::Ordering_Less : (r < l ? ::myodd::dynamic::Any::Ordering_Greater : (l == r ? ::myodd::dynamic::Any::Ordering_Equal : ::myodd::dynamic::Any::Ordering_Unordered));
+  }
+
+  static ::myodd::dynamic::Any::Ordering Order(const SampleNumber& lhs, const SampleNumber& rhs)
+  {
+    const auto kind = lhs.kind > rhs.kind ? lhs.kind : rhs.kind;
+    switch (kind)
+    {
+    case Kind_Float:
+      return OrderAs<float>(lhs, rhs);
+    case Kind_Double:
+      return OrderAs<double>(lhs, rhs);
+    case Kind_Long_Double:
+      return OrderAs<long double>(lhs, rhs);
+    default:
+      break;
+    }
+
+    // booleans are compared as unsigned integers, (true < -1)
+    if (lhs.kind == Kind_Boolean || rhs.kind == Kind_Boolean)
+    {
+      return OrderAs<unsigned long long>(lhs, rhs);
+    }
+
+    // a negative number is less than any unsigned number.
+    if (lhs.kind != rhs.kind)
+    {
+      const auto negative = (lhs.kind == Kind_Signed ? lhs.integer : rhs.integer) < 0;
+      if (negative)
+      {
+        return lhs.kind == Kind_Signed ? ::myodd::dynamic::Any::Ordering_Less : ::myodd::dynamic::Any::Ordering_Greater;
+      }
+    }
+    if (lhs.kind == Kind_Signed && rhs.kind == Kind_Signed)
+    {
+      return OrderAs<long long>(lhs, rhs);
+    }
+    return OrderAs<unsigned long long>(lhs, rhs);
+  }
+
+  Kind kind;
+  long long integer;
+  long double floating;
+};
+
+/**
+ * Add a value of a type, and the same number as c++ sees it.
+ */
+template<class T>
+void SampleAddNumbers(std::vector< ::myodd::dynamic::Any>& values, std::vector<SampleNumber>& numbers, std::initializer_list<T> list)
+{
+  for (const auto value : list)
+  {
+    values.push_back(value);
+    numbers.push_back(SampleNumber::Create(value));
+  }
+}
+
+void SampleCompare()
+{
+  std::vector< ::myodd::dynamic::Any> values;
+  std::vector<SampleNumber> numbers;
+
+  SampleAddNumbers<bool>(values, numbers, { false, true });
+  SampleAddNumbers<short>(values, numbers, { std::numeric_limits<short>::min(), -1, 0, 1, 12, std::numeric_limits<short>::max() });
+  SampleAddNumbers<unsigned short>(values, numbers, { 0, 1, 12, std::numeric_limits<unsigned short>::max() });
+  SampleAddNumbers<int>(values, numbers, { std::numeric_limits<int>::min(), -16777217, -1, 0, 1, 12, 16777216, 16777217, std::numeric_limits<int>::max() });
+  SampleAddNumbers<unsigned int>(values, numbers, { 0, 1, 12, 16777217, 2147483648u, std::numeric_limits<unsigned int>::max() });
+  SampleAddNumbers<long>(values, numbers, { std::numeric_limits<long>::min(), -1, 0, 1, 12, std::numeric_limits<long>::max() });
+  SampleAddNumbers<unsigned long>(values, numbers, { 0, 1, 12, std::numeric_limits<unsigned long>::max() });
+  SampleAddNumbers<long long>(values, numbers, { std::numeric_limits<long long>::min(), -4294967296LL, -1, 0, 1, 12, 4294967295LL, 9007199254740993LL, std::numeric_limits<long long>::max() });
+  SampleAddNumbers<unsigned long long>(values, numbers, { 0, 1, 12, 4294967296ULL, 9007199254740993ULL, 9223372036854775808ULL, std::numeric_limits<unsigned long long>::max() });
+  SampleAddNumbers<float>(values, numbers, { -std::numeric_limits<float>::infinity(), -16777216.0f, -1.5f, -1.0f, -0.0f, 0.0f, 0.1f, 1.0f, 12.0f, 12.5f, 16777216.0f, 4294967296.0f, std::numeric_limits<float>::max(), std::numeric_limits<float>::quiet_NaN() });
+  SampleAddNumbers<double>(values, numbers, { -std::numeric_limits<double>::infinity(), -1.5, -1.0, 0.0, 0.1, 1.0, 12.0, 12.5, 16777217.0, 9007199254740992.0, 9223372036854775808.0, 18446744073709551616.0, std::numeric_limits<double>::quiet_NaN() });
+  SampleAddNumbers<long double>(values, numbers, { -1.5L, -1.0L, 0.0L, 0.1L, 1.0L, 12.0L, 12.5L, 9007199254740993.0L, std::numeric_limits<long double>::infinity() });
+
+  // null is 0
+  values.push_back(::myodd::dynamic::Any());
+  numbers.push_back(SampleNumber::Create(0));
+
+  // strings that are numbers are long long, unsigned long long or long double.
+  const char* strings[] = { "-9223372036854775808", "-12", "-1", "0", "1", "12", "12.0", "12.5", "-1.5", "0.1", "16777217", "9223372036854775807", "18446744073709551615" };
+  for (const auto string : strings)
+  {
+    values.push_back(string);
+    values.push_back(std::wstring(string, string + strlen(string)));
+    const auto isFloating = nullptr != strchr(string, '.');
+    const auto number = isFloating ? SampleNumber::Create(strtold(string, nullptr)) : ('-' == string[0] ? SampleNumber::Create(strtoll(string, nullptr, 10)) : SampleNumber::Create(strtoull(string, nullptr, 10)));
+    numbers.push_back(number);
+    numbers.push_back(number);
+  }
+
+  // every value compared to every other value.
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    for (size_t j = 0; j < values.size(); ++j)
+    {
+      const auto& lhs = values[i];
+      const auto& rhs = values[j];
+      const auto order = lhs.CompareTo(rhs);
+      assert( order == SampleNumber::Order(numbers[i], numbers[j]) );
+      assert( (lhs == rhs) == (order == ::myodd::dynamic::Any::Ordering_Equal) );
+      assert( (lhs != rhs) == (order != ::myodd::dynamic::Any::Ordering_Equal) );
+      assert( (lhs < rhs) == (order == ::myodd::dynamic::Any::Ordering_Less) );
+      assert( (lhs > rhs) == (order == ::myodd::dynamic::Any::Ordering_Greater) );
+
+      // <= and >= are not > and not <, so NaN <= NaN.
+      assert( (lhs <= rhs) == (order != ::myodd::dynamic::Any::Ordering_Greater) );
+      assert( (lhs >= rhs) == (order != ::myodd::dynamic::Any::Ordering_Less) );
+      (void)order;
+    }
+  }
+
+  assert( values.size() == numbers.size() );
+  std::cout << "All comparisons are good!";
+}
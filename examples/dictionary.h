@@ -0,0 +1,182 @@
+/*
+ * dictionary.h
+ *
+ *  Sample of a column of strings with few distinct values, each string is kept once
+ *  and the rows are counted and grouped by their codes.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <assert.h>
+#include <iostream>
+
+#include "../any.h"
+#include "../anydictionary.h"
+
+void SampleDictionary()
+{
+  typedef ::myodd::dynamic::AnyDictionaryColumn Column;
+
+  // the codes follow the order the strings were added, nulls have their own code.
+  {
+    // the strings are compared as characters, not as numbers, and wide strings are kept as utf-8,
+    // so they are the same as their narrow string.
+    const std::vector<::myodd::dynamic::Any> values = {
+      "FR", "GB", nullptr, "FR", ::myodd::dynamic::Any(), "", "",
+      "12", "12.0", std::string("12\0", 3), L"\x20AC", "\xE2\x82\xAC", L"FR"
+    };
+    Column column;
+    std::vector<Column::Code> codes;
+    for (const auto& value : values)
+    {
+      codes.push_back(column.Add(value));
+    }
+    assert(codes == std::vector<Column::Code>({ 0, 1, Column::NullCode, 0, Column::NullCode, 2, 2, 3, 4, 5, 6, 6, 0 }));
+    assert(column.Codes() == codes);
+    assert(column.Size() == 13);
+    assert(column.DictionarySize() == 7);
+
+    const std::string euro = column.Decode(6);
+    assert(column.Decode(6).Type() == ::myodd::dynamic::Character_char);
+    assert(euro == "\xE2\x82\xAC");
+    (void)euro;
+
+    Column::Code code = 0;
+    assert(column.Find(L"GB", code) && code == 1);
+    assert(column.Find(nullptr, code) && code == Column::NullCode);
+    assert(!column.Find("DE", code));
+    assert(!column.Find(12, code));
+    assert(column.DictionarySize() == 7);
+
+    // only strings and nulls can be added.
+    bool added = true;
+    try
+    {
+      column.Add(12);
+    }
+    catch (const std::runtime_error&)
+    {
+      added = false;
+    }
+    assert(!added);
+    assert(column.Size() == 13);
+    (void)added;
+    (void)code;
+  }
+
+  // the rows are counted, found and grouped by their codes.
+  {
+    static const char* countries[] = { "FR", "GB", "DE", "IT", "ES" };
+    Column column;
+    std::vector<size_t> expected(5, 0);
+    size_t nulls = 0;
+    for (size_t i = 0; i < 10000; ++i)
+    {
+      if (i % 7 == 0)
+      {
+        column.Add(nullptr);
+        ++nulls;
+        continue;
+      }
+      const auto country = (i * i + i / 3) % 5;
+      column.Add(countries[country]);
+      ++expected[country];
+    }
+    assert(column.Size() == 10000);
+    assert(column.DictionarySize() == 5);
+
+    std::vector<size_t> counts = { 42 };
+    assert(column.GroupCount(counts) == nulls);
+    assert(counts.size() == 5);
+    for (size_t code = 0; code < counts.size(); ++code)
+    {
+      // the codes follow the order the countries were first seen.
+      const std::string country = column.Decode(static_cast<Column::Code>(code));
+      size_t index = 0;
+      while (country != countries[index])
+      {
+        ++index;
+      }
+      assert(counts[code] == expected[index]);
+      assert(column.CountEqual(country) == expected[index]);
+      (void)index;
+    }
+    assert(column.CountEqual(nullptr) == nulls);
+    assert(column.CountEqual("DE") == expected[2]);
+    assert(column.CountEqual("PL") == 0);
+
+    std::vector<size_t> rows = { 42 };
+    column.FindEqual(nullptr, rows);
+    assert(rows.size() == nulls);
+    for (const auto row : rows)
+    {
+      assert(row % 7 == 0);
+      assert(column[row].Type() == ::myodd::dynamic::Misc_null);
+      (void)row;
+    }
+    column.FindEqual("PL", rows);
+    assert(rows.empty());
+  }
+
+  // the values borrow their characters from the dictionary, they do not move when more strings are added.
+  {
+    Column column;
+    column.Add("first");
+    const auto first = column[0];
+    assert(first == "first");
+#if MYODD_ANY_CPP17
+    const std::string_view view = first;
+#endif
+    for (int i = 0; i < 100000; ++i)
+    {
+      column.Add(std::to_string(i));
+    }
+    assert(first == "first");
+    assert(column.Decode(0) == "first");
+    assert(column[50000] == "49999");
+#if MYODD_ANY_CPP17
+    const std::string_view again = column.Decode(0);
+    assert(view.data() == again.data());
+    assert(view == "first");
+    (void)view;
+    (void)again;
+#endif
+
+    // a copy has its own characters, so it can outlive the column.
+    ::myodd::dynamic::Any copy;
+    {
+      Column other;
+      other.Add("a copy");
+      const auto borrowed = other[0];
+      copy = borrowed;
+    }
+    assert(copy == "a copy");
+
+    bool past = false;
+    try
+    {
+      column.Decode(static_cast<Column::Code>(column.DictionarySize()));
+    }
+    catch (const std::out_of_range&)
+    {
+      past = true;
+    }
+    assert(past);
+    past = false;
+    try
+    {
+      column[column.Size()];
+    }
+    catch (const std::out_of_range&)
+    {
+      past = true;
+    }
+    assert(past);
+    (void)past;
+  }
+
+  std::cout << "All dictionaries are good!";
+}
@@ -0,0 +1,367 @@
+/*
+ * documents.h
+ *
+ *  Sample of writing JSON documents and reading them back, as nested values,
+ *  a part at a time and through a file descriptor.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <assert.h>
+#include <iostream>
+
+#include "../any.h"
+#include "../anyjson.h"
+
+/**
+ * Create a random document, arrays and objects nested a few times with every kind of value.
+ * @param std::mt19937_64& random the numbers we use.
+ * @param int depth how many more arrays/objects we can nest.
+ * @return ::myodd::dynamic::Any the document.
+ */
+::myodd::dynamic::Any SampleDocumentOf(std::mt19937_64& random, int depth)
+{
+  const auto kind = random() % (depth > 0 ? 9 : 7);
+  switch (kind)
+  {
+  case 0:
+    return nullptr;
+
+  case 1:
+    return random() % 2 == 0;
+
+  case 2:
+    return static_cast<long long>(random());
+
+  case 3:
+    return static_cast<unsigned long long>(random()) | (1ull << 63);
+
+  case 4:
+  {
+    // any finite double.
+    for (;;)
+    {
+      const auto bits = random();
+      double number;
+      std::memcpy(&number, &bits, sizeof(number));
+      if (std::isfinite(number))
+      {
+        return number;
+      }
+    }
+  }
+
+  case 5:
+  case 6:
+  {
+    // quotes, escapes, control characters and characters of every utf-8 length.
+    static const unsigned long codepoints[] = { '"', '\\', '/', '\b', '\n', '\t', 0x01, 0x1F, 'a', 'Z', ' ', 0xE9, 0x20AC, 0xFFFD, 0x1F600, 0x10FFFF };
+    std::string characters;
+    const auto length = random() % 12;
+    for (size_t i = 0; i < length; ++i)
+    {
+      ::myodd::dynamic::_Json::append_utf8(characters, codepoints[random() % (sizeof(codepoints) / sizeof(codepoints[0]))]);
+    }
+    return characters;
+  }
+
+  case 7:
+  {
+    ::myodd::dynamic::AnyJsonArray array;
+    const auto length = random() % 5;
+    for (size_t i = 0; i < length; ++i)
+    {
+      array.push_back(SampleDocumentOf(random, depth - 1));
+    }
+    return array;
+  }
+
+  default:
+  {
+    ::myodd::dynamic::AnyJsonObject object;
+    const auto length = random() % 5;
+    for (size_t i = 0; i < length; ++i)
+    {
+      object.emplace_back("key" + std::to_string(i), SampleDocumentOf(random, depth - 1));
+    }
+    return object;
+  }
+  }
+}
+
+/**
+ * Check that a document we read back has the same arrays and objects as the document we wrote,
+ * the keys and the other values are checked by the given function, (each format reads them back its own way).
+ * @param const ::myodd::dynamic::Any& document the document we wrote.
+ * @param const ::myodd::dynamic::Any& back the document we read.
+ * @param Check check the function checking a key or a value, void(const Any& value, const Any& back)
+ */
+template<class Check>
+void SampleDocumentCompare(const ::myodd::dynamic::Any& document, const ::myodd::dynamic::Any& back, Check check)
+{
+  if (document.IsCopyOf<::myodd::dynamic::AnyJsonArray>())
+  {
+    assert(back.IsCopyOf<::myodd::dynamic::AnyJsonArray>());
+    const ::myodd::dynamic::AnyJsonArray* lhs = document;
+    const ::myodd::dynamic::AnyJsonArray* rhs = back;
+    assert(lhs->size() == rhs->size());
+    for (size_t i = 0; i < lhs->size(); ++i)
+    {
+      SampleDocumentCompare((*lhs)[i], (*rhs)[i], check);
+    }
+    return;
+  }
+
+  if (document.IsCopyOf<::myodd::dynamic::AnyJsonObject>())
+  {
+    assert(back.IsCopyOf<::myodd::dynamic::AnyJsonObject>());
+    const ::myodd::dynamic::AnyJsonObject* lhs = document;
+    const ::myodd::dynamic::AnyJsonObject* rhs = back;
+    assert(lhs->size() == rhs->size());
+    for (size_t i = 0; i < lhs->size(); ++i)
+    {
+      check((*lhs)[i].first, (*rhs)[i].first);
+      SampleDocumentCompare((*lhs)[i].second, (*rhs)[i].second, check);
+    }
+    return;
+  }
+
+  check(document, back);
+}
+
+/**
+ * Check that a key or a value we read back from JSON is the one we wrote.
+ * The floating points are written with the shortest number that is the same double,
+ * and read back as the nearest long double to that number, (which is not always the same double once rounded again).
+ * @param const ::myodd::dynamic::Any& document the key or the value we wrote.
+ * @param const ::myodd::dynamic::Any& back the key or the value we read.
+ */
+void SampleDocumentCheckValue(const ::myodd::dynamic::Any& document, const ::myodd::dynamic::Any& back)
+{
+  if (document.Type() == ::myodd::dynamic::Floating_point_double)
+  {
+    assert(back.Type() == ::myodd::dynamic::Floating_point_long_double);
+    std::string json;
+    ::myodd::dynamic::AnyJsonWriter writer(json);
+    writer.Write(document);
+    assert(std::strtod(json.c_str(), nullptr) == static_cast<double>(document));
+    assert(std::strtold(json.c_str(), nullptr) == static_cast<long double>(back));
+    assert(std::signbit(static_cast<long double>(back)) == std::signbit(static_cast<double>(document)));
+    return;
+  }
+
+  if (document.Type() == ::myodd::dynamic::Character_char)
+  {
+    assert(back.Type() == ::myodd::dynamic::Character_char);
+    const std::string lhs = document;
+    const std::string rhs = back;
+    assert(lhs == rhs);
+    (void)lhs;
+    (void)rhs;
+    return;
+  }
+
+  // the integers that fit in a long long are long long.
+  assert(back.Type() == (document.Type() == ::myodd::dynamic::Integer_long_long_int ? ::myodd::dynamic::Integer_long_long_int : document.Type()));
+  assert(back == document);
+  (void)document;
+  (void)back;
+}
+
+/**
+ * Check that a document we read back is the document we wrote.
+ * @param const ::myodd::dynamic::Any& document the document we wrote.
+ * @param const ::myodd::dynamic::Any& back the document we read.
+ */
+void SampleDocumentCheck(const ::myodd::dynamic::Any& document, const ::myodd::dynamic::Any& back)
+{
+  SampleDocumentCompare(document, back, SampleDocumentCheckValue);
+}
+
+/**
+ * Write a document.
+ * @param const ::myodd::dynamic::Any& document the document.
+ * @return std::string the JSON.
+ */
+std::string SampleDocumentWrite(const ::myodd::dynamic::Any& document)
+{
+  std::string json;
+  ::myodd::dynamic::AnyJsonWriter writer(json);
+  writer.Write(document);
+  return json;
+}
+
+/**
+ * Read a single document.
+ * @param const std::string& json the JSON.
+ * @return ::myodd::dynamic::Any the document.
+ */
+::myodd::dynamic::Any SampleDocumentRead(const std::string& json)
+{
+  ::myodd::dynamic::AnyJsonReader reader(json.data(), json.size());
+  ::myodd::dynamic::Any document;
+  const auto read = reader.Read(document);
+  assert(read);
+  const auto more = reader.Read(document);
+  assert(!more);
+  (void)read;
+  (void)more;
+  return document;
+}
+
+/**
+ * Count the parts of a document as we read them.
+ */
+struct SampleDocumentCounter
+{
+  int arrays = 0;
+  int objects = 0;
+  int keys = 0;
+  int values = 0;
+  int depth = 0;
+
+  void StartArray() { ++arrays; ++depth; }
+  void EndArray() { --depth; }
+  void StartObject() { ++objects; ++depth; }
+  void EndObject() { --depth; }
+  void Key(const ::myodd::dynamic::Any&) { ++keys; }
+  void Value(const ::myodd::dynamic::Any&) { ++values; }
+};
+
+void SampleDocuments()
+{
+  // a document with every kind of value, and the way it is written back.
+  {
+    const std::string json = "{ \"a\" : [1, -2, 3.5, 1E2, -0.0, \"x\\u00e9\\ud83d\\ude00\\n\\u0001\\/\", true, false, null],\n\t\"b\":{}, \"c\":[] }";
+    const auto document = SampleDocumentRead(json);
+    assert(document.IsCopyOf<::myodd::dynamic::AnyJsonObject>());
+    const ::myodd::dynamic::AnyJsonObject* object = document;
+    assert(object->size() == 3);
+    assert((*object)[0].first == "a");
+    const ::myodd::dynamic::AnyJsonArray* array = (*object)[0].second;
+    assert(array->size() == 9);
+    assert((*array)[0].Type() == ::myodd::dynamic::Integer_long_long_int);
+    assert((*array)[2] == 3.5);
+    assert((*array)[3] == 100);
+    assert((*array)[5] == "x\xC3\xA9\xF0\x9F\x98\x80\n\x01/");
+    assert(SampleDocumentWrite(document) == "{\"a\":[1,-2,3.5,100.0,-0.0,\"x\xC3\xA9\xF0\x9F\x98\x80\\n\\u0001/\",true,false,null],\"b\":{},\"c\":[]}");
+
+    // the same document, a part at a time.
+    SampleDocumentCounter counter;
+    ::myodd::dynamic::AnyJsonReader reader(json.data(), json.size());
+    const auto read = reader.Read(counter);
+    assert(read);
+    assert(counter.arrays == 2 && counter.objects == 2 && counter.keys == 3 && counter.values == 9 && counter.depth == 0);
+    (void)object;
+    (void)array;
+    (void)read;
+  }
+
+  // the limits of the integers, (the numbers that do not fit are floating points).
+  assert(SampleDocumentRead("9223372036854775807").Type() == ::myodd::dynamic::Integer_long_long_int);
+  assert(SampleDocumentRead("-9223372036854775808") == std::numeric_limits<long long>::min());
+  assert(SampleDocumentRead("18446744073709551615").Type() == ::myodd::dynamic::Integer_unsigned_long_long_int);
+  assert(SampleDocumentRead("18446744073709551616").Type() == ::myodd::dynamic::Floating_point_long_double);
+  assert(SampleDocumentRead("-9223372036854775809").Type() == ::myodd::dynamic::Floating_point_long_double);
+  assert(SampleDocumentRead("1e400") == 1e400L);
+  assert(SampleDocumentWrite(std::numeric_limits<double>::infinity()) == "null");
+
+  // random documents, written, read back and written again.
+  {
+    std::mt19937_64 random(42);
+    for (int i = 0; i < 2000; ++i)
+    {
+      const auto document = SampleDocumentOf(random, 4);
+      const auto json = SampleDocumentWrite(document);
+      const auto back = SampleDocumentRead(json);
+      SampleDocumentCheck(document, back);
+
+      // the floating points are long double now, so they might need more digits, but no more after that.
+      const auto again = SampleDocumentWrite(back);
+      assert(SampleDocumentWrite(SampleDocumentRead(again)) == again);
+    }
+  }
+
+  // documents that are not valid.
+  for (const auto* json : {
+    "01", "-01", "[1,]", "{\"a\":1,}", "[1 2]", "{\"a\"}", "{1:2}", "-", "1.", ".5", "1e", "+1", "0x10",
+    "tru", "nul", "[", "{", "]", "\"abc", "\"a\x01\"", "\"\\x\"", "\"\\u12\"",
+    "\"\\ud800\"", "\"\\udc00\"", "\"\\ud800\\u0041\"", "\"\\ud800 and more characters\"", "\"\\ude00\\ud83d\"" })
+  {
+    bool rejected = false;
+    try
+    {
+      const std::string text = json;
+      ::myodd::dynamic::AnyJsonReader reader(text.data(), text.size());
+      ::myodd::dynamic::Any document;
+      while (reader.Read(document))
+      {
+      }
+    }
+    catch (const std::runtime_error&)
+    {
+      rejected = true;
+    }
+    assert(rejected);
+    (void)rejected;
+  }
+
+  // the writer must be given a key before each value of an object, and arrays/objects must be started.
+  {
+    std::string json;
+    ::myodd::dynamic::AnyJsonWriter writer(json);
+    int rejected = 0;
+    try { writer.Key("a"); } catch (const std::runtime_error&) { ++rejected; }
+    try { writer.EndArray(); } catch (const std::runtime_error&) { ++rejected; }
+    try { writer.Write(std::vector<int>{ 1 }); } catch (const std::runtime_error&) { ++rejected; }
+    writer.StartObject();
+    try { writer.Write(1); } catch (const std::runtime_error&) { ++rejected; }
+    writer.Key(12);
+    try { writer.EndObject(); } catch (const std::runtime_error&) { ++rejected; }
+    writer.Write(L"Wide \x20AC");
+    writer.EndObject();
+    assert(rejected == 5);
+    assert(json == "{\"12\":\"Wide \xE2\x82\xAC\"}");
+    (void)rejected;
+  }
+
+  // many documents, one per line, through a file descriptor that is read 1Mb at a time.
+  {
+    std::mt19937_64 random(7);
+    std::vector<::myodd::dynamic::Any> documents;
+    std::FILE* file = std::tmpfile();
+    assert(file != nullptr);
+    {
+      ::myodd::dynamic::AnyJsonWriter writer(fileno(file));
+      for (int i = 0; i < 100000; ++i)
+      {
+        documents.push_back(SampleDocumentOf(random, 3));
+        writer.Write(documents.back());
+      }
+    }
+    std::fseek(file, 0, SEEK_END);
+    assert(std::ftell(file) > 2 * 1024 * 1024);
+    std::rewind(file);
+    ::myodd::dynamic::AnyJsonReader reader(fileno(file));
+    ::myodd::dynamic::Any document;
+    size_t read = 0;
+    while (reader.Read(document))
+    {
+      assert(read < documents.size());
+      SampleDocumentCheck(documents[read++], document);
+    }
+    assert(read == documents.size());
+    std::fclose(file);
+  }
+
+  std::cout << "All documents are good!";
+}
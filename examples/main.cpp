@@ -28,6 +28,16 @@
 
 #include "vector.h"
 #include "map.h"
+#include "compare.h"
+#include "threads.h"
+#include "column.h"
+#include "serialize.h"
+#include "rows.h"
+#include "move.h"
+#include "documents.h"
+#include "messages.h"
+#include "streams.h"
+#include "dictionary.h"
 
 int main()
 {
@@ -35,5 +45,25 @@ int main()
 
   SampleMap();
 
+  SampleCompare();
+
+  SampleThreads();
+
+  SampleColumn();
+
+  SampleBinary();
+
+  SampleRows();
+
+  SampleMove();
+
+  SampleDocuments();
+
+  SampleMessages();
+
+  SampleStreams();
+
+  SampleDictionary();
+
   return 0;
 }
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <map>
+#include <unordered_map>
 #include <assert.h>
 #include <iostream>
 
@@ -26,5 +27,73 @@ void SampleMap()
   assert( myMap[1] == "Hello" );
   assert( myMap["Something"] == "Else" );
 
+  // or a hashed map, numbers and strings that are numbers have the same hash.
+  std::unordered_map< ::myodd::dynamic::Any, ::myodd::dynamic::Any, ::myodd::dynamic::AnyHash, ::myodd::dynamic::AnyEqual > myHashedMap;
+  myHashedMap[1] = "Hello";
+  myHashedMap["Something"] = "Else";
+
+  assert( myHashedMap[1.0] == "Hello" );
+  assert( myHashedMap["1"] == "Hello" );
+  assert( myHashedMap["Something"] == "Else" );
+  assert( myHashedMap.size() == 2 );
+
+  // "12abc" == 12, but it is not the same key.
+  myHashedMap["12abc"] = "Partial";
+  myHashedMap[12] = "Number";
+  assert( myHashedMap.size() == 4 );
+  assert( myHashedMap["12abc"] == "Partial" );
+  assert( myHashedMap[12.0] == "Number" );
+
+  // the same keys always have the same hash.
+  const ::myodd::dynamic::Any values[] = {
+    0, 1, -1, 12, 12.0, 12.0f, 12.5, 12.5f, 12.5L, -0.0, 0.1, 0.1f, 16777216, 16777217, 16777216.0f,
+    9223372036854775807LL, 18446744073709551615ULL, 12u, (short)12, true, false, 'a', L'a', ::myodd::dynamic::Any(),
+    "", "0", "1", "12", "12.0", "+12", " 12", "12.5", "-0", "0.1", "abc", "12abc", "12.5abc", "1e3", "1000", "18446744073709551615",
+    L"", L"12", L"12.0", L"abc", L"12abc", std::string("12abc"), ::myodd::dynamic::Any::Borrow("12abc", 5), ::myodd::dynamic::Any::Borrow("12", 2)
+  };
+  const ::myodd::dynamic::AnyHash hash;
+  const ::myodd::dynamic::AnyEqual equal;
+  for (const auto& lhs : values)
+  {
+    for (const auto& rhs : values)
+    {
+      assert( !equal(lhs, rhs) || hash(lhs) == hash(rhs) );
+      assert( !equal(lhs, rhs) || lhs == rhs );
+      assert( equal(lhs, rhs) == equal(rhs, lhs) );
+      (void)lhs;
+      (void)rhs;
+    }
+  }
+  (void)hash;
+  (void)equal;
+  assert( equal(12, "12") && equal("12.0", 12.0f) && equal(12u, L"12") && equal("12abc", std::string("12abc")) );
+  assert( equal("18446744073709551615", 18446744073709551615ULL) && !equal(18446744073709551615ULL, -1) );
+
+  // those are equal, but a string that is not a number is only the same key as the same characters.
+  assert( "12abc" == ::myodd::dynamic::Any(12) && !equal("12abc", 12) );
+  assert( "abc" == ::myodd::dynamic::Any(0) && !equal("abc", 0) );
+  assert( "12.5abc" == ::myodd::dynamic::Any(12.5) && !equal("12.5abc", 12.5) );
+
+  // a transparent map, we can look for literals without creating a key.
+  std::map< ::myodd::dynamic::Any, ::myodd::dynamic::Any, ::myodd::dynamic::AnyLess > myLessMap;
+  myLessMap[1] = "Hello";
+  myLessMap["Something"] = "Else";
+
+  assert( myLessMap.find( "Something" )->second == "Else" );
+  assert( myLessMap.find( std::string("Something") ) != myLessMap.end() );
+  assert( myLessMap.find( 1 )->second == "Hello" );
+  assert( myLessMap.find( "Nothing" ) == myLessMap.end() );
+
+  // the numbers are compared as they are, with the same rules as operator<
+  myLessMap[-1] = "Minus";
+  assert( myLessMap.find( 1u )->second == "Hello" );
+  assert( myLessMap.find( 1.0 )->second == "Hello" );
+  assert( myLessMap.find( -1LL )->second == "Minus" );
+  assert( myLessMap.find( 18446744073709551615ULL ) == myLessMap.end() );
+  assert( myLessMap.find( 1.5f ) == myLessMap.end() );
+  assert( ::myodd::dynamic::Any(-1).CompareTo( 4294967295u ) == ::myodd::dynamic::Any::Ordering_Less );
+  assert( ::myodd::dynamic::Any("12").CompareTo( 12.0 ) == ::myodd::dynamic::Any::Ordering_Equal );
+  assert( ::myodd::dynamic::Any("abc").CompareTo( 0 ) == ::myodd::dynamic::Any::Ordering_Equal );
+
   std::cout << "All maps are good!";
 }
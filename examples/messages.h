@@ -0,0 +1,245 @@
+/*
+ * messages.h
+ *
+ *  Sample of writing values in the MessagePack format and reading them back,
+ *  from a buffer, borrowing the strings, and from data given to the reader a chunk at a time.
+ */
+
+#pragma once
+
+#include <limits>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <assert.h>
+#include <iostream>
+
+#include "../any.h"
+#include "../anymsgpack.h"
+#include "documents.h"
+
+/**
+ * Write a single value.
+ * @param const ::myodd::dynamic::Any& value the value.
+ * @return std::string the MessagePack value.
+ */
+std::string SampleMessageOf(const ::myodd::dynamic::Any& value)
+{
+  std::string data;
+  ::myodd::dynamic::AnyMsgPackWriter writer(data);
+  writer.Write(value);
+  return data;
+}
+
+/**
+ * Check that a key or a value we read back from MessagePack is the one we wrote.
+ * @param const ::myodd::dynamic::Any& value the key or the value we wrote.
+ * @param const ::myodd::dynamic::Any& back the key or the value we read.
+ */
+void SampleMessageCheckValue(const ::myodd::dynamic::Any& value, const ::myodd::dynamic::Any& back)
+{
+  if (::myodd::dynamic::is_type_character(value.Type()))
+  {
+    // the wide strings are written as utf-8.
+    assert(back.Type() == ::myodd::dynamic::Character_char);
+    const std::string lhs = value;
+    const std::string rhs = back;
+    assert(lhs == rhs);
+    (void)lhs;
+    (void)rhs;
+    return;
+  }
+  assert(back == value);
+  (void)value;
+  (void)back;
+}
+
+/**
+ * Check that a value we read back is the value we wrote, the arrays and maps with all their values.
+ * @param const ::myodd::dynamic::Any& value the value we wrote.
+ * @param const ::myodd::dynamic::Any& back the value we read.
+ */
+void SampleMessageCheck(const ::myodd::dynamic::Any& value, const ::myodd::dynamic::Any& back)
+{
+  SampleDocumentCompare(value, back, SampleMessageCheckValue);
+}
+
+void SampleMessages()
+{
+  // every value is written in the smallest format it fits in, and read back as the smallest type it fits in.
+  {
+    struct Expected
+    {
+      ::myodd::dynamic::Any value;
+      size_t size;
+      unsigned char format;
+      ::myodd::dynamic::Type type;
+    };
+    const std::vector<Expected> expected = {
+      { nullptr, 1, 0xc0, ::myodd::dynamic::Misc_null },
+      { true, 1, 0xc3, ::myodd::dynamic::Boolean_bool },
+      { false, 1, 0xc2, ::myodd::dynamic::Boolean_bool },
+      { 0, 1, 0x00, ::myodd::dynamic::Integer_int },
+      { 127, 1, 0x7f, ::myodd::dynamic::Integer_int },
+      { 128, 2, 0xcc, ::myodd::dynamic::Integer_int },
+      { 255u, 2, 0xcc, ::myodd::dynamic::Integer_int },
+      { 256, 3, 0xcd, ::myodd::dynamic::Integer_int },
+      { 65535, 3, 0xcd, ::myodd::dynamic::Integer_int },
+      { 65536, 5, 0xce, ::myodd::dynamic::Integer_int },
+      { 4294967295u, 5, 0xce, ::myodd::dynamic::Integer_long_long_int },
+      { 4294967296LL, 9, 0xcf, ::myodd::dynamic::Integer_long_long_int },
+      { std::numeric_limits<unsigned long long>::max(), 9, 0xcf, ::myodd::dynamic::Integer_unsigned_long_long_int },
+      { -1, 1, 0xff, ::myodd::dynamic::Integer_int },
+      { -32, 1, 0xe0, ::myodd::dynamic::Integer_int },
+      { -33, 2, 0xd0, ::myodd::dynamic::Integer_int },
+      { static_cast<short>(-128), 2, 0xd0, ::myodd::dynamic::Integer_int },
+      { -129L, 3, 0xd1, ::myodd::dynamic::Integer_int },
+      { -32768, 3, 0xd1, ::myodd::dynamic::Integer_int },
+      { -32769, 5, 0xd2, ::myodd::dynamic::Integer_int },
+      { std::numeric_limits<int>::min(), 5, 0xd2, ::myodd::dynamic::Integer_int },
+      { std::numeric_limits<int>::min() - 1LL, 9, 0xd3, ::myodd::dynamic::Integer_long_long_int },
+      { std::numeric_limits<long long>::min(), 9, 0xd3, ::myodd::dynamic::Integer_long_long_int },
+      { 0.5f, 5, 0xca, ::myodd::dynamic::Floating_point_float },
+      { -0.25, 9, 0xcb, ::myodd::dynamic::Floating_point_double },
+      { 1.5L, 9, 0xcb, ::myodd::dynamic::Floating_point_double },
+      { "", 1, 0xa0, ::myodd::dynamic::Character_char },
+      { std::string(31, 'x'), 32, 0xbf, ::myodd::dynamic::Character_char },
+      { std::string(32, 'x'), 34, 0xd9, ::myodd::dynamic::Character_char },
+      { std::string(255, 'x'), 257, 0xd9, ::myodd::dynamic::Character_char },
+      { std::string(256, 'x'), 259, 0xda, ::myodd::dynamic::Character_char },
+      { std::string(65535, 'x'), 65538, 0xda, ::myodd::dynamic::Character_char },
+      { std::string(65536, 'x'), 65541, 0xdb, ::myodd::dynamic::Character_char },
+      { L"\x20AC", 4, 0xa3, ::myodd::dynamic::Character_char },
+      { ::myodd::dynamic::AnyJsonArray(15, 1), 16, 0x9f, ::myodd::dynamic::Misc_copy },
+      { ::myodd::dynamic::AnyJsonArray(16, 1), 19, 0xdc, ::myodd::dynamic::Misc_copy },
+      { ::myodd::dynamic::AnyJsonArray(65536, 1), 65541, 0xdd, ::myodd::dynamic::Misc_copy },
+      { ::myodd::dynamic::AnyJsonObject(15, { 1, 2 }), 31, 0x8f, ::myodd::dynamic::Misc_copy },
+      { ::myodd::dynamic::AnyJsonObject(16, { 1, 2 }), 35, 0xde, ::myodd::dynamic::Misc_copy },
+      { ::myodd::dynamic::AnyJsonObject(65536, { 1, 2 }), 131077, 0xdf, ::myodd::dynamic::Misc_copy }
+    };
+
+    std::string stream;
+    for (const auto& item : expected)
+    {
+      const auto data = SampleMessageOf(item.value);
+      assert(data.size() == item.size);
+      assert(static_cast<unsigned char>(data[0]) == item.format);
+      stream += data;
+
+      ::myodd::dynamic::AnyMsgPackReader reader(data.data(), data.size());
+      ::myodd::dynamic::Any back;
+      const auto read = reader.Read(back);
+      assert(read);
+      assert(back.Type() == item.type);
+      SampleMessageCheck(item.value, back);
+      (void)read;
+    }
+
+    // all of them one after the other, the arrays and maps we read are written over.
+    ::myodd::dynamic::AnyMsgPackReader reader(stream.data(), stream.size());
+    ::myodd::dynamic::Any back;
+    size_t count = 0;
+    while (reader.Read(back))
+    {
+      SampleMessageCheck(expected[count++].value, back);
+    }
+    assert(count == expected.size());
+  }
+
+  // the strings can borrow their characters from the data.
+  {
+    ::myodd::dynamic::AnyJsonObject object;
+    object.emplace_back("name", "a string long enough not to be in a fixstr");
+    const auto data = SampleMessageOf(object);
+
+    for (const auto borrow : { false, true })
+    {
+      ::myodd::dynamic::AnyMsgPackReader reader(data.data(), data.size(), borrow);
+      ::myodd::dynamic::Any back;
+      reader.Read(back);
+      SampleMessageCheck(object, back);
+#if MYODD_ANY_CPP17
+      // a view of a borrowed string points to the data, (a const char* would be a terminated copy).
+      const ::myodd::dynamic::AnyJsonObject* items = back;
+      const std::string_view key = (*items)[0].first;
+      const std::string_view characters = (*items)[0].second;
+      assert((key.data() >= data.data() && key.data() < data.data() + data.size()) == borrow);
+      assert((characters.data() >= data.data() && characters.data() < data.data() + data.size()) == borrow);
+      (void)key;
+      (void)characters;
+#endif
+    }
+  }
+
+  // the data arrives a chunk at a time, the values that are not all there are kept until the rest of them arrives.
+  {
+    std::vector<::myodd::dynamic::Any> values;
+    std::string stream;
+    {
+      ::myodd::dynamic::AnyMsgPackWriter writer(stream);
+      for (int i = 0; i < 200; ++i)
+      {
+        ::myodd::dynamic::AnyJsonObject object;
+        object.emplace_back("id", i);
+        object.emplace_back("name", std::string(static_cast<size_t>(i * 3), 'a' + (i % 26)));
+        object.emplace_back("values", ::myodd::dynamic::AnyJsonArray({ i * 0.5, -i, 1LL << i % 64, nullptr, i % 2 == 0 }));
+        values.push_back(object);
+        writer.Write(values.back());
+        values.push_back(i * 1000);
+        writer.Write(values.back());
+      }
+    }
+
+    for (const size_t chunk : { 1, 2, 7, 100, 4096 })
+    {
+      ::myodd::dynamic::AnyMsgPackReader reader;
+      ::myodd::dynamic::Any back;
+      size_t count = 0;
+      for (size_t offset = 0; offset < stream.size(); offset += chunk)
+      {
+        reader.Append(stream.data() + offset, std::min(chunk, stream.size() - offset));
+        while (reader.Read(back))
+        {
+          SampleMessageCheck(values[count++], back);
+        }
+      }
+      assert(count == values.size());
+    }
+
+    // only a reader created without data can be given more.
+    ::myodd::dynamic::AnyMsgPackReader reader(stream.data(), stream.size());
+    bool appended = true;
+    try
+    {
+      reader.Append("\x01", 1);
+    }
+    catch (const std::runtime_error&)
+    {
+      appended = false;
+    }
+    assert(!appended);
+    (void)appended;
+  }
+
+  // values that are not supported, truncated or nested too deeply.
+  for (const auto& data : {
+    std::string("\xc1", 1), std::string("\xd4\x01\x02", 3), std::string("\xcd\x01", 2), std::string("\xa5" "abc", 4),
+    std::string("\x92\x01", 2), std::string("\xdd\xff\xff\xff\xff", 5), std::string(600, '\x91') + std::string(1, '\x01') })
+  {
+    bool rejected = false;
+    try
+    {
+      ::myodd::dynamic::AnyMsgPackReader reader(data.data(), data.size());
+      ::myodd::dynamic::Any back;
+      reader.Read(back);
+    }
+    catch (const std::runtime_error&)
+    {
+      rejected = true;
+    }
+    assert(rejected);
+    (void)rejected;
+  }
+
+  std::cout << "All messages are good!";
+}
@@ -0,0 +1,184 @@
+/*
+ * move.h
+ *
+ *  Sample of moving values, the moved value takes whatever the other value owns
+ *  rather than sharing or copying it, and the other value is null.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <type_traits>
+#include <assert.h>
+#include <iostream>
+
+#include "../any.h"
+
+struct SampleMovePoint
+{
+  int x;
+  int y;
+};
+
+bool operator==(const SampleMovePoint& lhs, const SampleMovePoint& rhs)
+{
+  return lhs.x == rhs.x && lhs.y == rhs.y;
+}
+
+struct SampleMoveSize
+{
+  int width;
+  int height;
+};
+
+void SampleMove()
+{
+  static_assert(std::is_nothrow_move_constructible<::myodd::dynamic::Any>::value, "The vectors must move the values when they grow.");
+  static_assert(std::is_nothrow_move_assignable<::myodd::dynamic::Any>::value, "The values must be moved without throwing.");
+
+  // a string we own, the characters and the cosmetic string move with it.
+  {
+    ::myodd::dynamic::Any number = 1234;
+    const char* characters = number;
+    ::myodd::dynamic::Any moved(std::move(number));
+    assert(static_cast<const char*>(moved) == characters);
+    assert(moved == 1234);
+    assert(number.Type() == ::myodd::dynamic::Misc_null);
+
+    ::myodd::dynamic::Any text = std::string(1000, 'x');
+    const char* longer = text;
+    moved = std::move(text);
+    assert(static_cast<const char*>(moved) == longer);
+    assert(moved == std::string(1000, 'x'));
+    assert(text.Type() == ::myodd::dynamic::Misc_null);
+
+    // a moved value can be used again.
+    text = L"Wide";
+    assert(text == L"Wide");
+    (void)characters;
+    (void)longer;
+  }
+
+  // a value that borrows its characters still borrows them after the move, but a copy has its own.
+  {
+    const char borrowed[] = "borrowed 12";
+    ::myodd::dynamic::Any value = ::myodd::dynamic::Any::Borrow(borrowed, sizeof(borrowed) - 1);
+    ::myodd::dynamic::Any moved;
+    moved = std::move(value);
+    assert(value.Type() == ::myodd::dynamic::Misc_null);
+    const std::string characters = moved;
+    assert(characters == borrowed);
+    const ::myodd::dynamic::Any copy = moved;
+    const std::string copied = copy;
+    assert(copied == borrowed);
+#if MYODD_ANY_CPP17
+    const std::string_view view = moved;
+    assert(view.data() == borrowed);
+    const std::string_view copyView = copy;
+    assert(copyView.data() != borrowed);
+    (void)view;
+    (void)copyView;
+#endif
+    (void)characters;
+    (void)copied;
+  }
+
+  // a copy of a structure, the item is not copied again and is still the same type.
+  {
+    ::myodd::dynamic::Any point = SampleMovePoint{ 1, 2 };
+    assert(point.IsCopyOf<SampleMovePoint>());
+    assert(!point.IsCopyOf<SampleMoveSize>());
+    assert(!point.IsCopyOf<int>());
+    assert(!::myodd::dynamic::Any(12).IsCopyOf<int>());
+
+    SampleMovePoint* item = point;
+    const ::myodd::dynamic::Any shared = point;
+    ::myodd::dynamic::Any moved(std::move(point));
+    assert(moved.IsCopyOf<SampleMovePoint>());
+    assert(!point.IsCopyOf<SampleMovePoint>());
+    assert(point.Type() == ::myodd::dynamic::Misc_null);
+
+    // the moved value and the copy we made before still share the item.
+    SampleMovePoint* movedItem = moved;
+    SampleMovePoint* sharedItem = shared;
+    assert(movedItem == item);
+    assert(sharedItem == item);
+    assert(moved == shared);
+
+    // a const pointer is the same item.
+    const SampleMovePoint* constItem = moved;
+    assert(constItem == item);
+    assert(constItem->x == 1 && constItem->y == 2);
+
+    // and the item itself.
+    const SampleMovePoint copied = moved;
+    assert(copied == *item);
+
+    // but not another type.
+    bool cast = true;
+    try
+    {
+      SampleMoveSize* size = moved;
+      (void)size;
+    }
+    catch (const std::bad_cast&)
+    {
+      cast = false;
+    }
+    assert(!cast);
+    cast = true;
+    try
+    {
+      const SampleMoveSize size = moved;
+      (void)size;
+    }
+    catch (const std::bad_cast&)
+    {
+      cast = false;
+    }
+    assert(!cast);
+    (void)item;
+    (void)movedItem;
+    (void)sharedItem;
+    (void)constItem;
+    (void)copied;
+    (void)cast;
+  }
+
+  // moving a value to itself does nothing.
+  {
+    ::myodd::dynamic::Any value = "Hello";
+    const char* characters = value;
+    ::myodd::dynamic::Any& same = value;
+    value = std::move(same);
+    assert(value == "Hello");
+    assert(static_cast<const char*>(value) == characters);
+
+    ::myodd::dynamic::Any point = SampleMovePoint{ 3, 4 };
+    ::myodd::dynamic::Any& samePoint = point;
+    point = std::move(samePoint);
+    assert(point.IsCopyOf<SampleMovePoint>());
+    assert(point == (SampleMovePoint{ 3, 4 }));
+    (void)characters;
+  }
+
+  // a vector that grows moves its values, so the characters do not move.
+  {
+    std::vector<::myodd::dynamic::Any> values;
+    std::vector<const char*> characters;
+    for (int i = 0; i < 1000; ++i)
+    {
+      values.emplace_back(std::to_string(i));
+      characters.push_back(values.back());
+    }
+    for (int i = 0; i < 1000; ++i)
+    {
+      assert(static_cast<const char*>(values[i]) == characters[i]);
+      assert(values[i] == i);
+    }
+  }
+
+  std::cout << "All moves are good!";
+}
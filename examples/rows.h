@@ -0,0 +1,219 @@
+/*
+ * rows.h
+ *
+ *  Sample of reading rows of comma separated values, from a buffer and from a file descriptor,
+ *  the values of the rows are reused from one row to the next.
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <vector>
+#include <string>
+#include <functional>
+#include <stdexcept>
+#include <assert.h>
+#include <iostream>
+
+#include "../any.h"
+#include "../anycsv.h"
+
+/**
+ * Read all the rows of some comma separated values.
+ * @param const std::string& data the values.
+ * @param char delimiter the delimiter between the fields.
+ * @return std::vector<std::vector<std::string>> the fields of each row.
+ */
+std::vector<std::vector<std::string>> SampleRowsOf(const std::string& data, char delimiter = ',')
+{
+  std::vector<std::vector<std::string>> rows;
+  ::myodd::dynamic::AnyCsvReader reader(data.data(), data.size(), delimiter);
+  std::vector<::myodd::dynamic::Any> row;
+  while (reader.Read(row))
+  {
+    std::vector<std::string> fields;
+    for (const auto& value : row)
+    {
+      const std::string field = value;
+      fields.push_back(field);
+    }
+    rows.push_back(fields);
+  }
+  return rows;
+}
+
+/**
+ * Check that a field, (or a token), we read has the same characters and the same numbers as a string value.
+ * @param const ::myodd::dynamic::Any& value the field we read.
+ * @param const std::string& text the characters of the field.
+ */
+void SampleRowsCheck(const ::myodd::dynamic::Any& value, const std::string& text)
+{
+  // the binary form has the characters, the string status and both numbers.
+  std::string lhs, rhs;
+  value.Serialize(lhs);
+  ::myodd::dynamic::Any(text).Serialize(rhs);
+  assert(lhs == rhs);
+  assert(::myodd::dynamic::AnyHash()(value) == ::myodd::dynamic::AnyHash()(::myodd::dynamic::Any(text)));
+  (void)value;
+  (void)text;
+}
+
+void SampleRows()
+{
+  // quoted fields with delimiters, new lines and quotes, lines that end with "\r\n", an empty line and no last new line.
+  const std::vector<std::vector<std::string>> quoted = {
+    { "a", "b", "c" },
+    { "1", "x,y", "say \"hi\"" },
+    { "" },
+    { "two\nlines", "", "" },
+    { "last" }
+  };
+  assert(SampleRowsOf("a,b,c\n1,\"x,y\",\"say \"\"hi\"\"\"\r\n\n\"two\nlines\",,\"\"\nlast") == quoted);
+  (void)quoted;
+
+  // a lone "\r" ends a line, anything after a closing quote is kept and any delimiter can be used.
+  const std::vector<std::vector<std::string>> delimited = { { "a" }, { "b", "cd", "e" } };
+  assert(SampleRowsOf("a\rb;\"c\"d;e", ';') == delimited);
+  assert(SampleRowsOf("").empty());
+  assert(SampleRowsOf("\n").size() == 1 && SampleRowsOf("\n")[0] == std::vector<std::string>(1));
+  (void)delimited;
+
+  // a quoted field that is not closed.
+  {
+    bool closed = true;
+    try
+    {
+      SampleRowsOf("a,\"b\nc");
+    }
+    catch (const std::runtime_error&)
+    {
+      closed = false;
+    }
+    assert(!closed);
+    (void)closed;
+  }
+
+  // the numbers are worked out as the characters are copied, the same way as for any other string,
+  // plain numbers in one scan and everything else by the 'C' library.
+  {
+    const std::vector<std::string> texts = {
+      "12", "-3", "+7", "0", "-0", "3.25", "-0.5", "+.5", ".5", "5.", "007", "1234567890123456789",
+      "12345678901234567890", "18446744073709551615", "99999999999999999999", "0.1234567890123456789",
+      "1e5", "-2.5E-3", "0x1F", " 12", "12 ", "12abc", "-", "+", ".", "-.", "inf", "-Inf", "NaN", "nanny", "infinity",
+      "Hello", "", "a longer string of words that is not a number at all"
+    };
+    std::string data;
+    for (const auto& text : texts)
+    {
+      data += "\"" + text + "\"," + text + "\n";
+    }
+
+    ::myodd::dynamic::AnyCsvReader reader(data.data(), data.size());
+    std::vector<::myodd::dynamic::Any> row;
+    for (const auto& text : texts)
+    {
+      const auto more = reader.Read(row);
+      assert(more);
+      assert(row.size() == 2);
+      SampleRowsCheck(row[0], text);
+      SampleRowsCheck(row[1], text);
+      (void)more;
+    }
+    const auto more = reader.Read(row);
+    assert(!more);
+    (void)more;
+  }
+
+  // the values of the row are written over when we are the only one using them and the characters fit.
+  {
+    const std::string data = "Hello,World\n12,3.5\n,\nHi!!!,y\nlonger than before,x\n";
+    ::myodd::dynamic::AnyCsvReader reader(data.data(), data.size());
+    std::vector<::myodd::dynamic::Any> row;
+    reader.Read(row);
+    const char* characters = row[0];
+    const auto copy = row[1];
+    const auto hash = ::myodd::dynamic::AnyHash()(row[0]);
+
+    // the first field is written over, the second one is shared with a copy so it is not.
+    reader.Read(row);
+    assert(static_cast<const char*>(row[0]) == characters);
+    assert(static_cast<const char*>(row[1]) != static_cast<const char*>(copy));
+    assert(copy == "World");
+    SampleRowsCheck(row[0], "12");
+    SampleRowsCheck(row[1], "3.5");
+    assert(::myodd::dynamic::AnyHash()(row[0]) != hash);
+    assert(row[0] + 1 == 13);
+
+    // the buffer keeps its size after shorter characters, so the longer ones still fit.
+    reader.Read(row);
+    assert(static_cast<const char*>(row[0]) == characters);
+    SampleRowsCheck(row[0], "");
+    reader.Read(row);
+    assert(static_cast<const char*>(row[0]) == characters);
+    SampleRowsCheck(row[0], "Hi!!!");
+    SampleRowsCheck(row[1], "y");
+
+    // the characters do not fit anymore.
+    reader.Read(row);
+    SampleRowsCheck(row[0], "longer than before");
+    SampleRowsCheck(row[1], "x");
+    const auto more = reader.Read(row);
+    assert(!more);
+    (void)more;
+    (void)characters;
+    (void)hash;
+  }
+
+  // rows read from a file descriptor, a block at a time, so fields, quotes and "\r\n" are across 2 reads,
+  // and one field is longer than a block.
+  {
+    std::vector<std::vector<std::string>> rows;
+    for (size_t i = 0; i < 60000; ++i)
+    {
+      rows.push_back({ std::to_string(i), "a \"quoted\", field\r\nover " + std::to_string(i % 7) + " lines", std::to_string(i * 0.5) });
+    }
+    rows[30000][1] = std::string(3 * 1024 * 1024, 'x') + "\"";
+
+    std::string data;
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+      std::string escaped;
+      for (const auto c : rows[i][1])
+      {
+        escaped += c;
+        if (c == '"')
+        {
+          escaped += c;
+        }
+      }
+      data += rows[i][0] + ",\"" + escaped + "\"," + rows[i][2] + (i % 2 ? "\r\n" : "\n");
+    }
+
+    std::FILE* file = std::tmpfile();
+    assert(file != nullptr);
+    std::fwrite(data.data(), 1, data.size(), file);
+    std::fflush(file);
+    std::rewind(file);
+
+    ::myodd::dynamic::AnyCsvReader reader(fileno(file));
+    std::vector<::myodd::dynamic::Any> row;
+    size_t read = 0;
+    while (reader.Read(row))
+    {
+      assert(read < rows.size());
+      assert(row.size() == 3);
+      for (size_t i = 0; i < 3; ++i)
+      {
+        assert(row[i] == rows[read][i]);
+      }
+      assert(row[0] == static_cast<long long>(read));
+      ++read;
+    }
+    assert(read == rows.size());
+    assert(SampleRowsOf(data) == rows);
+    std::fclose(file);
+  }
+
+  std::cout << "All rows are good!";
+}
@@ -0,0 +1,330 @@
+/*
+ * serialize.h
+ *
+ *  Sample of writing values in their binary form and reading them back,
+ *  one value at a time, as a stream of values, through a file descriptor and in place with a view.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+#include <string>
+#include <thread>
+#include <stdexcept>
+#include <assert.h>
+#include <iostream>
+
+#include "../any.h"
+#include "../anybinary.h"
+#include "../anyview.h"
+
+/**
+ * Check that a value we read back is the value we wrote, with the same type.
+ * @param const ::myodd::dynamic::Any& value the value we wrote.
+ * @param const ::myodd::dynamic::Any& back the value we read.
+ */
+void SampleBinaryCheck(const ::myodd::dynamic::Any& value, const ::myodd::dynamic::Any& back)
+{
+  assert(back.Type() == value.Type());
+  if (::myodd::dynamic::is_type_floating(value.Type()) && std::isnan(static_cast<long double>(value)))
+  {
+    assert(std::isnan(static_cast<long double>(back)));
+  }
+  else if (::myodd::dynamic::is_type_floating(value.Type()))
+  {
+    // -0.0 keeps its sign.
+    assert(static_cast<long double>(back) == static_cast<long double>(value));
+    assert(std::signbit(static_cast<long double>(back)) == std::signbit(static_cast<long double>(value)));
+  }
+  else if (value.Type() == ::myodd::dynamic::Character_wchar_t)
+  {
+    const std::wstring lhs = back;
+    const std::wstring rhs = value;
+    assert(lhs == rhs);
+    (void)lhs;
+    (void)rhs;
+  }
+  else if (::myodd::dynamic::is_type_character(value.Type()))
+  {
+    const std::string lhs = back;
+    const std::string rhs = value;
+    assert(lhs == rhs);
+    (void)lhs;
+    (void)rhs;
+  }
+  else
+  {
+    assert(back == value);
+  }
+  (void)value;
+  (void)back;
+}
+
+void SampleBinary()
+{
+  const char borrowed[] = "a borrowed string";
+  const wchar_t wideBorrowed[] = L"a borrowed wide string";
+
+  // every type, and the limits of each of them.
+  const std::vector<::myodd::dynamic::Any> values = {
+    nullptr,
+    true, false,
+    'a', static_cast<signed char>(-5), static_cast<unsigned char>(250), L'\x20AC',
+    static_cast<short>(-32768), static_cast<unsigned short>(65535),
+    std::numeric_limits<int>::min(), std::numeric_limits<unsigned int>::max(),
+    -1234567L, 1234567ul,
+    std::numeric_limits<long long>::min(), std::numeric_limits<long long>::max(), std::numeric_limits<unsigned long long>::max(),
+    0.5f, -1e30f, std::numeric_limits<float>::quiet_NaN(),
+    0.1, -0.0, std::numeric_limits<double>::infinity(), std::numeric_limits<double>::denorm_min(),
+    1.1L, -1e4000L, -std::numeric_limits<long double>::infinity(), std::numeric_limits<long double>::max(),
+    "Hello", "", "12abc", std::string(1000, 'x'), std::string("with\0zero", 9),
+    L"Wide", L"", L"\x20AC\x4E2D",
+    ::myodd::dynamic::Any::Borrow(borrowed, sizeof(borrowed) - 1),
+    ::myodd::dynamic::Any::Borrow(wideBorrowed, sizeof(wideBorrowed) / sizeof(wchar_t) - 1)
+  };
+
+  // one value at a time, copied and borrowed, and skipped.
+  for (const auto& value : values)
+  {
+    std::string buffer;
+    value.Serialize(buffer);
+
+    const char* source = buffer.data();
+    SampleBinaryCheck(value, ::myodd::dynamic::Any::Deserialize(source, buffer.data() + buffer.size()));
+    assert(source == buffer.data() + buffer.size());
+
+    source = buffer.data();
+    SampleBinaryCheck(value, ::myodd::dynamic::Any::DeserializeBorrowed(source, buffer.data() + buffer.size()));
+    assert(source == buffer.data() + buffer.size());
+
+    source = buffer.data();
+    ::myodd::dynamic::Any::SkipSerialized(source, buffer.data() + buffer.size());
+    assert(source == buffer.data() + buffer.size());
+
+    // a value cut short.
+    if (buffer.size() > 1)
+    {
+      source = buffer.data();
+      bool truncated = false;
+      try
+      {
+        ::myodd::dynamic::Any::Deserialize(source, buffer.data() + buffer.size() - 1);
+      }
+      catch (const std::runtime_error&)
+      {
+        truncated = true;
+      }
+      assert(truncated);
+      (void)truncated;
+    }
+  }
+
+#if MYODD_ANY_CPP17
+  // the strings borrow their characters from the data.
+  {
+    std::string buffer;
+    ::myodd::dynamic::Any("Hello").Serialize(buffer);
+    const char* source = buffer.data();
+    const auto value = ::myodd::dynamic::Any::DeserializeBorrowed(source, buffer.data() + buffer.size());
+    const std::string_view view = value;
+    assert(view == "Hello");
+    assert(view.data() >= buffer.data() && view.data() + view.size() <= buffer.data() + buffer.size());
+    (void)view;
+  }
+#endif
+
+  // a long double with more than 64 bits is written in 2 parts, (1 + 2^-60 here).
+  {
+    // the tag of a long double that is written as a long double, followed by the 2 parts.
+    std::string buffer;
+    ::myodd::dynamic::Any(1.1L).Serialize(buffer);
+    assert(buffer[1] == ::myodd::dynamic::_Binary::FloatingClass_Positive);
+    buffer.resize(1);
+    buffer += static_cast<char>(::myodd::dynamic::_Binary::FloatingClass_Positive_Wide);
+    ::myodd::dynamic::_Binary::append_varint(buffer, ::myodd::dynamic::_Binary::zigzag(0));
+    ::myodd::dynamic::_Binary::append_varint(buffer, 1);
+    ::myodd::dynamic::_Binary::append_varint(buffer, ::myodd::dynamic::_Binary::zigzag(-60));
+    ::myodd::dynamic::_Binary::append_varint(buffer, 1);
+
+    const char* source = buffer.data();
+    const auto value = ::myodd::dynamic::Any::Deserialize(source, buffer.data() + buffer.size());
+    assert(value.Type() == ::myodd::dynamic::Floating_point_long_double);
+    assert(static_cast<long double>(value) == 1 + std::ldexp(1.0L, -60));
+    assert(source == buffer.data() + buffer.size());
+  }
+
+  // copies of objects cannot be written.
+  {
+    std::string buffer;
+    bool written = true;
+    try
+    {
+      ::myodd::dynamic::Any(std::vector<int>{ 1, 2 }).Serialize(buffer);
+    }
+    catch (const std::runtime_error&)
+    {
+      written = false;
+    }
+    assert(!written);
+    (void)written;
+  }
+
+  // a stream of values, in a buffer.
+  {
+    std::string data;
+    {
+      ::myodd::dynamic::AnyWriter writer(data);
+      for (const auto& value : values)
+      {
+        writer.Write(value);
+      }
+    }
+
+    ::myodd::dynamic::AnyReader reader(data.data(), data.size());
+    ::myodd::dynamic::Any value;
+    size_t count = 0;
+    while (reader.Read(value))
+    {
+      SampleBinaryCheck(values[count++], value);
+    }
+    assert(count == values.size());
+
+    // a stream written by a newer version, and data that is not a stream.
+    auto newer = data;
+    newer[::myodd::dynamic::_Binary::header_size - 1] = static_cast<char>(::myodd::dynamic::_Binary::version + 1);
+    for (const auto& wrong : { newer, std::string("not a stream") })
+    {
+      bool rejected = false;
+      try
+      {
+        ::myodd::dynamic::AnyReader other(wrong.data(), wrong.size());
+      }
+      catch (const std::runtime_error&)
+      {
+        rejected = true;
+      }
+      assert(rejected);
+      (void)rejected;
+    }
+  }
+
+  // a view of the stream, the values are found the first time we need them.
+  {
+    std::string data;
+    {
+      ::myodd::dynamic::AnyWriter writer(data);
+      for (size_t i = 0; i < 1000; ++i)
+      {
+        writer.Write(values[i % values.size()]);
+      }
+    }
+
+    // several threads reading a view that has not found its values yet.
+    const ::myodd::dynamic::AnyView view(data.data(), data.size());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t)
+    {
+      threads.emplace_back([&, t]()
+      {
+        for (size_t i = t; i < 1000; i += 3)
+        {
+          SampleBinaryCheck(values[i % values.size()], view[i]);
+        }
+      });
+    }
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+    assert(view.Size() == 1000);
+
+#if MYODD_ANY_CPP17
+    // the strings borrow their characters from the data.
+    const std::string_view hello = view[27];
+    assert(hello == "Hello");
+    assert(hello.data() >= data.data() && hello.data() + hello.size() <= data.data() + data.size());
+    (void)hello;
+#endif
+
+    bool past = false;
+    try
+    {
+      view[1000];
+    }
+    catch (const std::out_of_range&)
+    {
+      past = true;
+    }
+    assert(past);
+    (void)past;
+
+    // a last value that is cut short, we only know when we look for the values, (every time).
+    auto cut = data;
+    ::myodd::dynamic::Any("Hello").Serialize(cut);
+    cut.pop_back();
+    const ::myodd::dynamic::AnyView truncated(cut.data(), cut.size());
+    for (int i = 0; i < 2; ++i)
+    {
+      bool rejected = false;
+      try
+      {
+        truncated.Size();
+      }
+      catch (const std::runtime_error&)
+      {
+        rejected = true;
+      }
+      assert(rejected);
+      (void)rejected;
+    }
+
+    // an empty stream, and data that is not a stream.
+    std::string empty;
+    {
+      ::myodd::dynamic::AnyWriter writer(empty);
+    }
+    assert(::myodd::dynamic::AnyView(empty.data(), empty.size()).Size() == 0);
+    bool rejected = false;
+    try
+    {
+      ::myodd::dynamic::AnyView other("not a stream", 12);
+    }
+    catch (const std::runtime_error&)
+    {
+      rejected = true;
+    }
+    assert(rejected);
+    (void)rejected;
+  }
+
+  // a stream of values through a file descriptor, it is read 64Kb at a time so some values are across 2 reads.
+  {
+    std::FILE* file = std::tmpfile();
+    assert(file != nullptr);
+    const size_t count = 50000;
+    {
+      ::myodd::dynamic::AnyWriter writer(fileno(file));
+      for (size_t i = 0; i < count; ++i)
+      {
+        writer.Write(values[i % values.size()]);
+      }
+    }
+
+    std::rewind(file);
+    ::myodd::dynamic::AnyReader reader(fileno(file));
+    ::myodd::dynamic::Any value;
+    size_t read = 0;
+    while (reader.Read(value))
+    {
+      SampleBinaryCheck(values[read % values.size()], value);
+      ++read;
+    }
+    assert(read == count);
+    std::fclose(file);
+  }
+
+  std::cout << "All binary values are good!";
+}
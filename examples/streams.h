@@ -0,0 +1,206 @@
+/*
+ * streams.h
+ *
+ *  Sample of writing values to a stream and reading them back, one token at a time with operator>>
+ *  or a lot of them with a tokenizer, they must be the same as writing and reading a std::string.
+ */
+
+#pragma once
+
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <assert.h>
+#include <iostream>
+
+#include "../any.h"
+#include "../anytokenizer.h"
+#include "rows.h"
+
+/**
+ * A value that can tell us if its cosmetic strings were created.
+ */
+class SampleStreamAny : public ::myodd::dynamic::Any
+{
+public:
+  template<class T>
+  SampleStreamAny(const T& value) : ::myodd::dynamic::Any(value) {}
+
+  bool HasStrings() const
+  {
+    return nullptr != _svalue.load() || nullptr != _swvalue.load();
+  }
+};
+
+void SampleStreams()
+{
+  // the values are written the way their string would be, with the width, the fill and the alignment of the stream.
+  {
+    const std::vector<SampleStreamAny> values = {
+      42, -7LL, 18446744073709551615ull, 0.5, -1e300, 2.5f, 1.1L, true, nullptr,
+      "Hello", "", L"Wide \x20AC", std::string("with\0zero", 9)
+    };
+    for (const auto& value : values)
+    {
+      // the string of a copy, so the value does not create its own.
+      const ::myodd::dynamic::Any copy = static_cast<const ::myodd::dynamic::Any&>(value);
+      const std::string text = copy;
+      for (const auto width : { 0, 3, 20 })
+      {
+        for (const auto alignment : { std::ios_base::right, std::ios_base::left, std::ios_base::internal })
+        {
+          std::ostringstream lhs, rhs;
+          lhs.setf(alignment, std::ios_base::adjustfield);
+          rhs.setf(alignment, std::ios_base::adjustfield);
+          lhs << std::setfill('*') << std::setw(width) << value << '|' << value;
+          rhs << std::setfill('*') << std::setw(width) << text.c_str() << '|' << text.c_str();
+          assert(lhs.str() == rhs.str());
+        }
+      }
+
+      // the numbers are formatted on the stack, nothing is kept in the value.
+      assert(!value.HasStrings());
+    }
+
+    std::ostringstream stream;
+    stream << std::setw(6) << ::myodd::dynamic::Any(42) << std::left << std::setw(6) << ::myodd::dynamic::Any("ab") << ::myodd::dynamic::Any(L"c");
+    assert(stream.str() == "    42ab    c");
+
+    // copies of objects cannot be written as they are.
+    std::ostringstream copy;
+    copy << ::myodd::dynamic::Any(std::vector<int>{ 1, 2 });
+    assert(copy.str() == "Copy Value");
+
+    // the cosmetic strings are still created when they are needed.
+    SampleStreamAny number = 12;
+    const char* characters = number;
+    assert(number.HasStrings());
+    (void)characters;
+  }
+
+  // the tokens are read like a std::string would be.
+  {
+    const std::string text = " 12  -3.5\tHello\n\v\f1e5 0x1F  12abc\r\n" + std::string(256, 'a') + " " + std::string(257, 'b') + " " + std::string(1000, 'c') + "\nlast";
+    std::istringstream lhs(text), rhs(text);
+    ::myodd::dynamic::Any value;
+    std::string token;
+    size_t count = 0;
+    for (;;)
+    {
+      lhs >> value;
+      rhs >> token;
+      assert(lhs.rdstate() == rhs.rdstate());
+      if (!lhs)
+      {
+        break;
+      }
+      SampleRowsCheck(value, token);
+      ++count;
+    }
+    assert(count == 10);
+
+    // a failed read does not change the value.
+    SampleRowsCheck(value, "last");
+    assert(lhs.eof() && lhs.fail());
+  }
+
+  // the last token sets eof, (but does not fail), the next read fails.
+  {
+    std::istringstream stream("12");
+    ::myodd::dynamic::Any value;
+    stream >> value;
+    assert(value == 12);
+    assert(stream.eof() && !stream.fail());
+    stream >> value;
+    assert(stream.fail());
+    assert(value == 12);
+  }
+
+  // the width of the stream limits the token, and is reset after each read.
+  {
+    std::istringstream stream("abcdef 123456");
+    ::myodd::dynamic::Any first, second, third, fourth;
+    stream >> std::setw(3) >> first >> second >> std::setw(300) >> third >> fourth;
+    assert(first == "abc");
+    assert(second == "def");
+    assert(third == 123456);
+    assert(stream.eof() && stream.fail());
+    assert(fourth.Type() == ::myodd::dynamic::Misc_null);
+
+    // the width is in characters, past 256 of them they are kept in a longer string.
+    std::istringstream longer(std::string(300, 'x'));
+    longer >> std::setw(270) >> first;
+    assert(first == std::string(270, 'x'));
+    assert(longer.width() == 0);
+    longer >> second;
+    assert(second == std::string(30, 'x'));
+  }
+
+  // the leading spaces are not skipped with noskipws, so there is no token.
+  {
+    std::istringstream stream(" 12");
+    ::myodd::dynamic::Any value = 5;
+    stream >> std::noskipws >> value;
+    assert(stream.fail());
+    assert(value == 5);
+  }
+
+  // a lot of tokens with a tokenizer, from a buffer and from a stream read 1Mb at a time,
+  // so some tokens are across 2 reads and one of them is longer than a read.
+  {
+    std::mt19937_64 random(42);
+    static const char* spaces[] = { " ", "  ", "\t", "\n", "\r\n", "\v", "\f" };
+    std::string text;
+    std::vector<std::string> tokens;
+    for (int i = 0; i < 300000; ++i)
+    {
+      switch (random() % 4)
+      {
+      case 0:
+        tokens.push_back(std::to_string(static_cast<long long>(random())));
+        break;
+      case 1:
+        tokens.push_back(std::to_string(static_cast<double>(random() % 100000) / 64));
+        break;
+      case 2:
+        tokens.push_back(std::string(1 + random() % 20, static_cast<char>('a' + random() % 26)));
+        break;
+      default:
+        tokens.push_back("-" + std::to_string(random() % 1000) + "e" + std::to_string(random() % 10));
+        break;
+      }
+      if (i == 150000)
+      {
+        tokens.back() = std::string(3 * 1024 * 1024, 'z');
+      }
+      text += spaces[random() % (sizeof(spaces) / sizeof(spaces[0]))];
+      text += tokens.back();
+    }
+    text += "\n";
+
+    ::myodd::dynamic::AnyTokenizer buffer(text.data(), text.size());
+    std::istringstream stream(text);
+    ::myodd::dynamic::AnyTokenizer streamed(stream);
+    ::myodd::dynamic::Any lhs, rhs;
+    size_t count = 0;
+    while (buffer.Read(lhs))
+    {
+      const auto read = streamed.Read(rhs);
+      assert(read);
+      assert(count < tokens.size());
+      SampleRowsCheck(lhs, tokens[count]);
+      SampleRowsCheck(rhs, tokens[count]);
+      ++count;
+      (void)read;
+    }
+    assert(count == tokens.size());
+    const auto more = streamed.Read(rhs);
+    assert(!more);
+    assert(stream.eof());
+    (void)more;
+  }
+
+  std::cout << "All streams are good!";
+}
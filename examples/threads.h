@@ -0,0 +1,382 @@
+/*
+ * threads.h
+ *
+ *  Sample of sharing const anys between threads.
+ *  The cosmetic strings are created the first time they are needed
+ *  so all the threads are racing to create them.
+ *  And of a counter and a map that all the threads are changing,
+ *  and of loops shared between the threads of an executor.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <assert.h>
+#include <iostream>
+
+#include "../any.h"
+#include "../anyatomic.h"
+#include "../anyconcurrentmap.h"
+#include "../anyexecutor.h"
+
+void SampleThreads()
+{
+  const int numberOfThreads = 8;
+  const int numberOfLoops = 1000;
+
+  for (int loop = 0; loop < numberOfLoops; ++loop)
+  {
+    // new values every time so the strings have not been created yet.
+    const ::myodd::dynamic::Any number = 1234 + loop;
+    const ::myodd::dynamic::Any floating = 0.5;
+    const ::myodd::dynamic::Any wide = L"Hello";
+    const std::string expected = std::to_string(1234 + loop);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numberOfThreads; ++i)
+    {
+      threads.emplace_back([&]()
+      {
+        const char* c = number;
+        assert(0 == std::strcmp(c, expected.c_str()));
+
+        std::string s = number;
+        assert(s == expected);
+
+        std::wstring ws = number;
+        assert(ws.size() == expected.size());
+
+        std::string f = floating;
+        assert(f == "0.5");
+
+        std::string w = wide;
+        assert(w == "Hello");
+
+        // copies share the characters.
+        ::myodd::dynamic::Any copy = wide;
+        assert(copy == L"Hello");
+        (void)c;
+      });
+    }
+
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+  }
+
+  // all the threads add to the same counter, and one of them makes it a double half way.
+  for (int loop = 0; loop < numberOfLoops / 10; ++loop)
+  {
+    ::myodd::dynamic::AtomicAny counter(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numberOfThreads; ++i)
+    {
+      threads.emplace_back([&, i]()
+      {
+        for (int j = 0; j < 1000; ++j)
+        {
+          if (i == 0 && j == 500)
+          {
+            counter.FetchAdd(0.5);
+          }
+          else
+          {
+            counter.FetchAdd(1);
+          }
+        }
+      });
+    }
+
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+    assert(counter.Load() == numberOfThreads * 1000 - 0.5);
+    assert(counter.Load().Type() == ::myodd::dynamic::Floating_point_double);
+  }
+
+  // an int that becomes a long long while the other threads are reading it.
+  for (int loop = 0; loop < numberOfLoops / 10; ++loop)
+  {
+    ::myodd::dynamic::AtomicAny counter(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numberOfThreads; ++i)
+    {
+      threads.emplace_back([&, i]()
+      {
+        if (i == 0)
+        {
+          counter.FetchAdd(5000000000LL);
+          return;
+        }
+        for (int j = 0; j < 1000; ++j)
+        {
+          // the type is widened before the number is added, so a long long can still be 0, but an int is never 5000000000.
+          const auto value = counter.Load();
+          if (value.Type() == ::myodd::dynamic::Integer_int)
+          {
+            assert(value == 0);
+          }
+          else
+          {
+            assert(value.Type() == ::myodd::dynamic::Integer_long_long_int);
+            assert(value == 0 || value == 5000000000LL);
+          }
+        }
+      });
+    }
+
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+    assert(counter.Load() == 5000000000LL);
+  }
+
+  // half the threads change the map while the other half read it.
+  for (int loop = 0; loop < numberOfLoops / 10; ++loop)
+  {
+    ::myodd::dynamic::AnyConcurrentMap map(4);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numberOfThreads; ++i)
+    {
+      threads.emplace_back([&, i]()
+      {
+        for (int j = 0; j < 1000; ++j)
+        {
+          const int key = (j * 7 + i) % 100;
+          if (i % 2 == 0)
+          {
+            map.Assign(key, std::to_string(key));
+          }
+          else
+          {
+            ::myodd::dynamic::Any value;
+            if (map.Find(key, value))
+            {
+              assert(value == std::to_string(key));
+            }
+          }
+        }
+      });
+    }
+
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+
+    // every key was written, and can be found with its characters, borrowed, as well as with the number.
+    assert(map.Size() == 100);
+    for (int key = 0; key < 100; ++key)
+    {
+      const std::string characters = std::to_string(key);
+      ::myodd::dynamic::Any value, other;
+      const auto found = map.Find(key, value);
+      assert(found);
+      assert(value == characters);
+      const auto foundString = map.Find(characters, other);
+      assert(foundString);
+      assert(other == characters);
+      assert(map.Contains(characters.c_str()));
+      (void)found;
+      (void)foundString;
+    }
+  }
+
+  // only one thread adds each key, the others are told it was already there.
+  {
+    ::myodd::dynamic::AnyConcurrentMap map(2);
+    std::atomic<int> inserted(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numberOfThreads; ++i)
+    {
+      threads.emplace_back([&, i]()
+      {
+        for (int key = 0; key < 1000; ++key)
+        {
+          if (map.Insert(key, i))
+          {
+            ++inserted;
+          }
+        }
+      });
+    }
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+    assert(inserted == 1000);
+    assert(map.Size() == 1000);
+
+    // the value of the thread that added it is kept.
+    for (int key = 0; key < 1000; ++key)
+    {
+      const auto added = map.Insert(key, -1);
+      assert(!added);
+      ::myodd::dynamic::Any value;
+      map.Find(key, value);
+      assert(value >= 0 && value < numberOfThreads);
+      (void)added;
+    }
+  }
+
+  // the threads update the same values without losing any of the changes, while others erase keys.
+  {
+    ::myodd::dynamic::AnyConcurrentMap map(4);
+    for (int key = 0; key < 1000; ++key)
+    {
+      map.Insert(key, key);
+    }
+    std::atomic<int> erased(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numberOfThreads; ++i)
+    {
+      threads.emplace_back([&, i]()
+      {
+        for (int j = 0; j < 1000; ++j)
+        {
+          if (i % 2 == 0)
+          {
+            map.Update("Hits", [](::myodd::dynamic::Any& value) { value += 1; });
+          }
+          else if (map.Erase(j))
+          {
+            ++erased;
+          }
+        }
+      });
+    }
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+
+    // each key was erased once, the key that was added with a null value is all that is left.
+    assert(erased == 1000);
+    assert(map.Size() == 1);
+    assert(!map.Contains(500));
+    const auto erasedAgain = map.Erase(500);
+    assert(!erasedAgain);
+    ::myodd::dynamic::Any hits;
+    const auto found = map.Find(std::string("Hits"), hits);
+    assert(found);
+    assert(hits == numberOfThreads / 2 * 1000);
+    (void)erasedAgain;
+    (void)found;
+  }
+
+  // a single shard grows many times while the readers look for the keys that are already there.
+  {
+    ::myodd::dynamic::AnyConcurrentMap map(1);
+    const int numberOfKeys = 20000;
+    std::atomic<int> added(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numberOfThreads; ++i)
+    {
+      threads.emplace_back([&, i]()
+      {
+        for (int key = i; key < numberOfKeys; key += numberOfThreads)
+        {
+          map.Insert(std::to_string(key), key);
+          ++added;
+
+          // a key added by this thread is never lost while the table is replaced.
+          const auto seen = map.Contains(std::to_string(i));
+          assert(seen);
+          (void)seen;
+        }
+      });
+    }
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+    assert(added == numberOfKeys);
+    assert(map.Size() == static_cast<size_t>(numberOfKeys));
+    for (int key = 0; key < numberOfKeys; key += 97)
+    {
+      ::myodd::dynamic::Any value;
+      const auto found = map.Find(std::to_string(key).c_str(), value);
+      assert(found);
+      assert(value == key);
+      (void)found;
+    }
+  }
+
+  // the keys are the same as their value, 12 and "12" are the same key but "12abc" is not.
+  {
+    ::myodd::dynamic::AnyConcurrentMap map;
+    map.Insert("12abc", 1);
+    assert(map.Contains("12abc"));
+    assert(!map.Contains(12));
+    map.Insert("12", 2);
+    assert(map.Contains(12));
+    assert(map.Contains(12.0));
+    const auto added = map.Insert(12, 3);
+    assert(!added);
+    assert(map.Size() == 2);
+    (void)added;
+  }
+
+  // the executor gives the same results as a single thread.
+  {
+    ::myodd::dynamic::AnyExecutor executor(numberOfThreads, 100);
+    std::vector<::myodd::dynamic::Any> values;
+    for (int i = 0; i < 10000; ++i)
+    {
+      values.emplace_back((i * 7919) % 10007);
+    }
+
+    ::myodd::dynamic::Any total;
+    for (const auto& value : values)
+    {
+      total += value;
+    }
+    assert(executor.Sum(values.begin(), values.end()) == total);
+
+    executor.Sort(values.begin(), values.end());
+    for (size_t i = 1; i < values.size(); ++i)
+    {
+      assert(!(values[i] < values[i - 1]));
+    }
+
+    std::atomic<int> count(0);
+    executor.ParallelFor(0, 100, [&](size_t begin, size_t end)
+    {
+      // a loop inside a loop.
+      executor.ParallelFor(begin * 100, end * 100, [&](size_t first, size_t last)
+      {
+        count += static_cast<int>(last - first);
+      });
+    });
+    assert(10000 == count);
+  }
+
+  // the floating points are added in the same parts whatever the number of threads.
+  {
+    std::vector<::myodd::dynamic::Any> values;
+    for (int i = 0; i < 100000; ++i)
+    {
+      values.emplace_back(1.0 / (i + 1));
+    }
+
+    ::myodd::dynamic::AnyExecutor single(1);
+    const double total = single.Sum(values.begin(), values.end());
+    for (size_t threads = 2; threads <= 8; threads *= 2)
+    {
+      ::myodd::dynamic::AnyExecutor executor(threads);
+      const double sum = executor.Sum(values.begin(), values.end());
+      assert(0 == std::memcmp(&sum, &total, sizeof(sum)));
+      (void)sum;
+    }
+    (void)total;
+  }
+
+  std::cout << "All threads are good!";
+}
@@ -0,0 +1,340 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <atomic>         //  std::atomic
+#include <condition_variable>
+#include <cstddef>        //  size_t
+#include <deque>          //  std::deque
+#include <exception>      //  std::exception_ptr
+#include <memory>         //  std::unique_ptr
+#include <mutex>          //  std::mutex
+#include <thread>         //  std::thread
+#include <vector>
+
+/**
+ * A pool of threads that share the work of a parallel loop, (@see AnyExecutor).
+ * Each thread has its own deque of tasks, it takes the newest task it added, (the one that is still in its cache),
+ * and when it has nothing left it steals the oldest task of another thread, (the largest part of a range left).
+ * A range is split in 2 until it is smaller than the grain, so the threads that finish first steal the rest.
+ * The thread waiting for a loop runs tasks while it waits, so loops can be nested.
+ */
+namespace myodd {
+  namespace dynamic {
+    namespace _Executor
+    {
+      /**
+       * The tasks of a single loop, the loop is done once all its tasks have run.
+       * The first exception thrown by a task is kept and thrown again by the thread waiting for the loop.
+       */
+      class Group
+      {
+      public:
+        Group() :
+          _pending(0),
+          _failed(false)
+        {
+        }
+
+        void Add()
+        {
+          _pending.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void Done()
+        {
+          _pending.fetch_sub(1, std::memory_order_release);
+        }
+
+        bool IsDone() const
+        {
+          return 0 == _pending.load(std::memory_order_acquire);
+        }
+
+        bool HasFailed() const
+        {
+          return _failed.load(std::memory_order_relaxed);
+        }
+
+        void Fail(std::exception_ptr error)
+        {
+          std::lock_guard<std::mutex> guard(_lock);
+          if (!_error)
+          {
+            _error = error;
+          }
+          _failed.store(true, std::memory_order_relaxed);
+        }
+
+        void Rethrow()
+        {
+          if (_error)
+          {
+            std::rethrow_exception(_error);
+          }
+        }
+
+      private:
+        std::atomic<size_t> _pending;
+        std::atomic<bool> _failed;
+        std::mutex _lock;
+        std::exception_ptr _error;
+      };
+
+      /**
+       * A task, it deletes itself once it has run.
+       */
+      class Task
+      {
+      public:
+        explicit Task(Group& group) :
+          _group(group)
+        {
+        }
+
+        virtual ~Task() = default;
+
+        void Run()
+        {
+          if (!_group.HasFailed())
+          {
+            try
+            {
+              Execute();
+            }
+            catch (...)
+            {
+              _group.Fail(std::current_exception());
+            }
+          }
+
+          auto& group = _group;
+          delete this;
+          group.Done();
+        }
+
+      protected:
+        virtual void Execute() = 0;
+
+        Group& _group;
+      };
+
+      class Pool;
+
+      /**
+       * The pool and the deque of the thread we are running on, so the tasks we create go to our own deque.
+       */
+      struct Worker
+      {
+        Pool* pool;
+        size_t index;
+      };
+
+      inline Worker& current_worker()
+      {
+        static thread_local Worker worker = { nullptr, 0 };
+        return worker;
+      }
+
+      class Pool
+      {
+      public:
+        /**
+         * Start the threads, the thread waiting for a loop also runs its tasks, so we start one less.
+         * @param size_t threads the number of threads running the tasks, including the thread waiting.
+         */
+        explicit Pool(size_t threads) :
+          _queues(threads < 1 ? 1 : threads),
+          _queued(0),
+          _sleeping(0),
+          _stop(false)
+        {
+          // the last queue is for the threads that are not ours.
+          for (size_t i = 0; i + 1 < _queues.size(); ++i)
+          {
+            _threads.emplace_back([this, i]()
+            {
+              Work(i);
+            });
+          }
+        }
+
+        Pool(const Pool&) = delete;
+        Pool& operator=(const Pool&) = delete;
+
+        ~Pool()
+        {
+          {
+            std::lock_guard<std::mutex> guard(_sleep);
+            _stop.store(true);
+          }
+          _wake.notify_all();
+          for (auto& thread : _threads)
+          {
+            thread.join();
+          }
+        }
+
+        /**
+         * The number of threads running the tasks, including the thread waiting for a loop.
+         * @return size_t the number of threads.
+         */
+        size_t Size() const
+        {
+          return _queues.size();
+        }
+
+        /**
+         * Add a task to the deque of the thread we are on, the threads that are sleeping are woken.
+         * @param Task* task the task.
+         */
+        void Push(Task* task)
+        {
+          auto& queue = _queues[Self()];
+          {
+            std::lock_guard<std::mutex> guard(queue.lock);
+            queue.tasks.push_back(task);
+          }
+          _queued.fetch_add(1);
+          if (_sleeping.load() > 0)
+          {
+            std::lock_guard<std::mutex> guard(_sleep);
+            _wake.notify_one();
+          }
+        }
+
+        /**
+         * Run tasks until all the tasks of a group have run.
+         * @param Group& group the group we are waiting for.
+         */
+        void Wait(Group& group)
+        {
+          const auto self = Self();
+          while (!group.IsDone())
+          {
+            if (!RunOne(self))
+            {
+              // the other threads are running the last tasks.
+              std::this_thread::yield();
+            }
+          }
+        }
+
+      private:
+        struct Queue
+        {
+          std::mutex lock;
+          std::deque<Task*> tasks;
+        };
+
+        /**
+         * The deque of the thread we are on, the threads that are not ours share the last one.
+         * @return size_t the index of the deque.
+         */
+        size_t Self() const
+        {
+          const auto& worker = current_worker();
+          return worker.pool == this ? worker.index : _queues.size() - 1;
+        }
+
+        /**
+         * Run the newest task of our deque, or steal the oldest task of another one.
+         * @param size_t self the index of our deque.
+         * @return bool if we ran a task.
+         */
+        bool RunOne(size_t self)
+        {
+          auto task = Take(_queues[self], true);
+          for (size_t i = 1; nullptr == task && i < _queues.size(); ++i)
+          {
+            task = Take(_queues[(self + i) % _queues.size()], false);
+          }
+          if (nullptr == task)
+          {
+            return false;
+          }
+          _queued.fetch_sub(1);
+          task->Run();
+          return true;
+        }
+
+        static Task* Take(Queue& queue, bool newest)
+        {
+          std::lock_guard<std::mutex> guard(queue.lock);
+          if (queue.tasks.empty())
+          {
+            return nullptr;
+          }
+          Task* task;
+          if (newest)
+          {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+          }
+          else
+          {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+          }
+          return task;
+        }
+
+        /**
+         * The loop of one of our threads, it sleeps when there is nothing to run or steal.
+         * @param size_t index the index of the deque of the thread.
+         */
+        void Work(size_t index)
+        {
+          current_worker() = Worker{ this, index };
+          while (!_stop.load())
+          {
+            if (RunOne(index))
+            {
+              continue;
+            }
+
+            std::unique_lock<std::mutex> guard(_sleep);
+            _sleeping.fetch_add(1);
+            _wake.wait(guard, [this]()
+            {
+              return _stop.load() || _queued.load() > 0;
+            });
+            _sleeping.fetch_sub(1);
+          }
+        }
+
+        std::vector<Queue> _queues;
+        std::vector<std::thread> _threads;
+
+        // the number of tasks in all the deques, the threads only sleep when there are none.
+        std::atomic<size_t> _queued;
+        std::atomic<size_t> _sleeping;
+        std::atomic<bool> _stop;
+        std::mutex _sleep;
+        std::condition_variable _wake;
+      };
+    }
+  }
+}
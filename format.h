@@ -0,0 +1,230 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <cstddef>        //  size_t
+#include <cstdio>         //  snprintf
+#include <cstdlib>        //  strtof / strtod / strtold
+#include <clocale>        //  localeconv
+#include <cmath>          //  std::isfinite
+#include <limits>         //  std::numeric_limits
+
+#if (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L) || __cplusplus >= 201703L
+#   include <charconv>    //  std::to_chars
+#endif
+
+/**
+ * Locale free number formatting.
+ * All the functions write the number at the start of the buffer and return
+ * a pointer past the last character written, the buffer is not '\0' terminated.
+ * The buffer must be at least format_buffer_size characters long.
+ */
+namespace myodd {
+  namespace dynamic {
+    /**
+     * The size of the buffer needed to format any number.
+     */
+    static constexpr size_t format_buffer_size = 64;
+
+    namespace _Format
+    {
+      /**
+       * The 2 digits representation of all the numbers from 00 to 99
+       */
+      static constexpr char digits[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+      /**
+       * Count the number of digits in an unsigned number.
+       * @param unsigned long long value the value we are checking.
+       * @return size_t the number of digits, (at least one).
+       */
+      inline size_t count_digits(unsigned long long value)
+      {
+        size_t count = 1;
+        for (;;)
+        {
+          if (value < 10) return count;
+          if (value < 100) return count + 1;
+          if (value < 1000) return count + 2;
+          if (value < 10000) return count + 3;
+          value /= 10000u;
+          count += 4;
+        }
+      }
+
+      /**
+       * Read a floating point number back, using the 'C' library.
+       * @param const char* str the string we are reading.
+       * @param T the floating point type we are reading.
+       * @return T the number.
+       */
+      inline float read_floating(const char* str, float) { return std::strtof(str, nullptr); }
+      inline double read_floating(const char* str, double) { return std::strtod(str, nullptr); }
+      inline long double read_floating(const char* str, long double) { return std::strtold(str, nullptr); }
+
+      /**
+       * Format a floating point number using the shortest representation that
+       * reads back to the same value, using the 'C' printf engine.
+       * This is only used if the compiler does not support std::to_chars.
+       * @param char* buffer where we are writing the number.
+       * @param const T value the number we are formatting.
+       * @return char* past the last character written.
+       */
+      template<class T>
+      char* format_floating_printf(char* buffer, const T value)
+      {
+        int len = 0;
+        for (int precision = std::numeric_limits<T>::digits10; precision <= std::numeric_limits<T>::max_digits10; ++precision)
+        {
+          len = std::snprintf(buffer, format_buffer_size, "%.*Lg", precision, static_cast<long double>(value));
+          if (!std::isfinite(value) || read_floating(buffer, value) == value)
+          {
+            break;
+          }
+        }
+
+        // printf uses the current locale decimal point, we always want a '.'
+        const char point = *std::localeconv()->decimal_point;
+        for (int i = 0; i < len; ++i)
+        {
+          if (buffer[i] == point)
+          {
+            buffer[i] = '.';
+          }
+        }
+        return buffer + len;
+      }
+    }
+
+    /**
+     * Format an unsigned integer.
+     * @param char* buffer where we are writing the number.
+     * @param unsigned long long value the number we are formatting.
+     * @return char* past the last character written.
+     */
+    inline char* format_unsigned(char* buffer, unsigned long long value)
+    {
+      // we write the number backward, 2 digits at a time.
+      char* end = buffer + _Format::count_digits(value);
+      char* it = end;
+      while (value >= 100)
+      {
+        const auto index = static_cast<size_t>(value % 100) * 2;
+        value /= 100;
+        *--it = _Format::digits[index + 1];
+        *--it = _Format::digits[index];
+      }
+
+      // the last one or two digits.
+      if (value >= 10)
+      {
+        const auto index = static_cast<size_t>(value) * 2;
+        *--it = _Format::digits[index + 1];
+        *--it = _Format::digits[index];
+      }
+      else
+      {
+        *--it = static_cast<char>('0' + value);
+      }
+      return end;
+    }
+
+    /**
+     * Format a signed integer.
+     * @param char* buffer where we are writing the number.
+     * @param long long value the number we are formatting.
+     * @return char* past the last character written.
+     */
+    inline char* format_integer(char* buffer, long long value)
+    {
+      if (value >= 0)
+      {
+        return format_unsigned(buffer, static_cast<unsigned long long>(value));
+      }
+
+      // we cannot negate the smallest value, but we can negate it as an unsigned number.
+      *buffer = '-';
+      return format_unsigned(buffer + 1, 0ull - static_cast<unsigned long long>(value));
+    }
+
+    /**
+     * Format a floating point number using the shortest representation that reads
+     * back to the exact same value, for example 0.1 rather than 0.100000
+     * @param char* buffer where we are writing the number.
+     * @param float value the number we are formatting.
+     * @return char* past the last character written.
+     */
+    inline char* format_floating(char* buffer, float value)
+    {
+#if defined(__cpp_lib_to_chars)
+      return std::to_chars(buffer, buffer + format_buffer_size, value).ptr;
+#else
+      return _Format::format_floating_printf(buffer, value);
+#endif
+    }
+
+    /**
+     * Format a floating point number using the shortest representation that reads
+     * back to the exact same value, for example 0.1 rather than 0.100000
+     * @param char* buffer where we are writing the number.
+     * @param double value the number we are formatting.
+     * @return char* past the last character written.
+     */
+    inline char* format_floating(char* buffer, double value)
+    {
+#if defined(__cpp_lib_to_chars)
+      return std::to_chars(buffer, buffer + format_buffer_size, value).ptr;
+#else
+      return _Format::format_floating_printf(buffer, value);
+#endif
+    }
+
+    /**
+     * Format a floating point number using the shortest representation that reads
+     * back to the exact same value, for example 0.1 rather than 0.100000
+     * @param char* buffer where we are writing the number.
+     * @param long double value the number we are formatting.
+     * @return char* past the last character written.
+     */
+    inline char* format_floating(char* buffer, long double value)
+    {
+#if defined(__cpp_lib_to_chars)
+      return std::to_chars(buffer, buffer + format_buffer_size, value).ptr;
+#else
+      return _Format::format_floating_printf(buffer, value);
+#endif
+    }
+  }
+}
@@ -0,0 +1,134 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <cstddef>        //  size_t
+#include <cstring>        //  memcpy
+
+/**
+ * 64 bit hashes of the values, they are only used to quickly tell values apart
+ * in memory, they are not stable between platforms and should not be saved.
+ */
+namespace myodd {
+  namespace dynamic {
+    namespace _Hash
+    {
+      static constexpr unsigned long long multiplier1 = 0x87c37b91114253d5ull;
+      static constexpr unsigned long long multiplier2 = 0x4cf5ad432745937full;
+
+      /**
+       * Rotate the bits of a value to the left.
+       * @param unsigned long long value the value we are rotating.
+       * @param int bits the number of bits, (1-63)
+       * @return unsigned long long the rotated value.
+       */
+      inline unsigned long long rotate_left(unsigned long long value, int bits)
+      {
+        return (value << bits) | (value >> (64 - bits));
+      }
+
+      /**
+       * Spread the bits of a value, (the murmur3 finalizer).
+       * @param unsigned long long value the value we are mixing.
+       * @return unsigned long long the mixed value.
+       */
+      inline unsigned long long mix(unsigned long long value)
+      {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdull;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ull;
+        value ^= value >> 33;
+        return value;
+      }
+
+      /**
+       * Add 8 bytes to a hash.
+       * @param unsigned long long hash the current hash.
+       * @param unsigned long long word the 8 bytes we are adding.
+       * @return unsigned long long the new hash.
+       */
+      inline unsigned long long add_word(unsigned long long hash, unsigned long long word)
+      {
+        word *= multiplier1;
+        word = rotate_left(word, 31);
+        word *= multiplier2;
+        hash ^= word;
+        return rotate_left(hash, 27) * 5 + 0x52dce729;
+      }
+    }
+
+    /**
+     * Hash some bytes, 8 bytes at a time.
+     * @param const void* source the bytes we are hashing.
+     * @param size_t sourceLen the number of bytes.
+     * @return unsigned long long the hash.
+     */
+    inline unsigned long long hash_bytes(const void* source, size_t sourceLen)
+    {
+      const auto* bytes = static_cast<const unsigned char*>(source);
+      unsigned long long hash = sourceLen * _Hash::multiplier1;
+      size_t i = 0;
+      for (; i + 8 <= sourceLen; i += 8)
+      {
+        unsigned long long word;
+        std::memcpy(&word, bytes + i, 8);
+        hash = _Hash::add_word(hash, word);
+      }
+
+      // the last few bytes, if any.
+      if (i < sourceLen)
+      {
+        unsigned long long word = 0;
+        std::memcpy(&word, bytes + i, sourceLen - i);
+        hash = _Hash::add_word(hash, word);
+      }
+      return _Hash::mix(hash ^ sourceLen);
+    }
+
+    /**
+     * Hash a number, whole numbers have the same hash whatever type they are stored in, (1 and 1.0)
+     * Other numbers are hashed as floats, as a float and a double are compared as floats.
+     * @param long double value the number we are hashing.
+     * @return unsigned long long the hash.
+     */
+    inline unsigned long long hash_number(long double value)
+    {
+      if (value >= -9223372036854775808.0L && value < 9223372036854775808.0L)
+      {
+        const auto whole = static_cast<long long>(value);
+        if (static_cast<long double>(whole) == value)
+        {
+          return _Hash::mix(static_cast<unsigned long long>(whole));
+        }
+      }
+
+      const auto number = static_cast<float>(value);
+      unsigned int bits;
+      std::memcpy(&bits, &number, sizeof(bits));
+      return _Hash::mix(bits ^ _Hash::multiplier2);
+    }
+  }
+}
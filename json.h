@@ -0,0 +1,263 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <cstddef>        //  size_t
+#include <string>         //  std::string
+
+#include "simd.h"         //  instruction sets
+
+/**
+ * The characters of a JSON document, (RFC 8259)
+ */
+namespace myodd {
+  namespace dynamic {
+    namespace _Json
+    {
+      /**
+       * Check if a character is a space between the tokens, (only ' ', '\t', '\n' and '\r')
+       * @param const char c the character we are checking.
+       * @return bool if the character is a space.
+       */
+      inline bool is_space(const char c)
+      {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+      }
+
+      /**
+       * Check if a character ends the plain characters of a string, a quote, a backslash
+       * or a control character, (they must be escaped).
+       * @param const char c the character we are checking.
+       * @return bool if the plain characters end before it.
+       */
+      inline bool is_string_special(const char c)
+      {
+        return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+      }
+
+      /**
+       * Find the end of the plain characters of a string, one character at a time.
+       * @param const char* source where we are in the string.
+       * @param const char* end the end of the data.
+       * @return const char* the first special character, or end if there is none.
+       */
+      inline const char* find_string_special_scalar(const char* source, const char* end)
+      {
+        while (source != end && !is_string_special(*source))
+        {
+          ++source;
+        }
+        return source;
+      }
+
+#if MYODD_ANY_SIMD
+      /**
+       * Find the end of the plain characters of a string, 16 characters at a time.
+       * @see find_string_special_scalar
+       */
+      inline const char* find_string_special_sse2(const char* source, const char* end)
+      {
+        const __m128i quotes = _mm_set1_epi8('"');
+        const __m128i backslashes = _mm_set1_epi8('\\');
+        const __m128i controls = _mm_set1_epi8(0x1f);
+        for (; end - source >= 16; source += 16)
+        {
+          const __m128i characters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+
+          // the unsigned characters that are not above 0x1f are control characters.
+          const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(characters, controls), characters);
+          const __m128i found = _mm_or_si128(control,
+            _mm_or_si128(_mm_cmpeq_epi8(characters, quotes), _mm_cmpeq_epi8(characters, backslashes)));
+          const auto mask = static_cast<unsigned int>(_mm_movemask_epi8(found));
+          if (mask != 0)
+          {
+            return source + _Simd::trailing_zeros(mask);
+          }
+        }
+        return find_string_special_scalar(source, end);
+      }
+
+      /**
+       * Find the end of the plain characters of a string, 32 characters at a time.
+       * @see find_string_special_scalar
+       */
+      MYODD_ANY_TARGET_AVX2
+      inline const char* find_string_special_avx2(const char* source, const char* end)
+      {
+        const __m256i quotes = _mm256_set1_epi8('"');
+        const __m256i backslashes = _mm256_set1_epi8('\\');
+        const __m256i controls = _mm256_set1_epi8(0x1f);
+        for (; end - source >= 32; source += 32)
+        {
+          const __m256i characters = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source));
+          const __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(characters, controls), characters);
+          const __m256i found = _mm256_or_si256(control,
+            _mm256_or_si256(_mm256_cmpeq_epi8(characters, quotes), _mm256_cmpeq_epi8(characters, backslashes)));
+          const auto mask = static_cast<unsigned int>(_mm256_movemask_epi8(found));
+          if (mask != 0)
+          {
+            return source + _Simd::trailing_zeros(mask);
+          }
+        }
+        return find_string_special_sse2(source, end);
+      }
+#endif
+
+      /**
+       * Find the end of the plain characters of a string using the best instruction set.
+       * Most strings are short, so we check the first few characters one at a time.
+       * @see find_string_special_scalar
+       */
+      inline const char* find_string_special(const char* source, const char* end)
+      {
+#if MYODD_ANY_SIMD
+        static const auto avx2 = _Simd::instruction_set() >= _Simd::InstructionSet_AVX2;
+        const char* shortEnd = (end - source > 16) ? source + 16 : end;
+        for (; source != shortEnd; ++source)
+        {
+          if (is_string_special(*source))
+          {
+            return source;
+          }
+        }
+        if (source == end)
+        {
+          return end;
+        }
+        return avx2 ? find_string_special_avx2(source, end) : find_string_special_sse2(source, end);
+#else
+        return find_string_special_scalar(source, end);
+#endif
+      }
+
+      /**
+       * Get the value of an hexadecimal digit.
+       * @param const char c the character.
+       * @return int the value, or -1 if it is not an hexadecimal digit.
+       */
+      inline int hex_value(const char c)
+      {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+      }
+
+      /**
+       * Read the 4 hexadecimal digits of a "\u" escape.
+       * @param const char* source the digits, there must be at least 4 characters.
+       * @return long the code unit, or -1 if they are not hexadecimal digits.
+       */
+      inline long read_hex4(const char* source)
+      {
+        long unit = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+          const auto digit = hex_value(source[i]);
+          if (digit < 0)
+          {
+            return -1;
+          }
+          unit = (unit << 4) | digit;
+        }
+        return unit;
+      }
+
+      /**
+       * Append a code point as utf-8
+       * @param std::string& destination where we are writing.
+       * @param unsigned long codepoint the code point, (a valid one).
+       */
+      inline void append_utf8(std::string& destination, unsigned long codepoint)
+      {
+        if (codepoint < 0x80)
+        {
+          destination += static_cast<char>(codepoint);
+        }
+        else if (codepoint < 0x800)
+        {
+          destination += static_cast<char>(0xC0 | (codepoint >> 6));
+          destination += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+        else if (codepoint < 0x10000)
+        {
+          destination += static_cast<char>(0xE0 | (codepoint >> 12));
+          destination += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+          destination += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+        else
+        {
+          destination += static_cast<char>(0xF0 | (codepoint >> 18));
+          destination += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+          destination += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+          destination += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+      }
+
+      /**
+       * Append the characters of a string, with the quotes, and escape what needs to be escaped.
+       * The characters are written as they are, (utf-8 is valid JSON).
+       * @param std::string& destination where we are writing.
+       * @param const char* source the characters.
+       * @param size_t sourceLen the number of characters.
+       */
+      inline void append_string(std::string& destination, const char* source, size_t sourceLen)
+      {
+        static constexpr char hex[] = "0123456789abcdef";
+        const char* end = source + sourceLen;
+        destination += '"';
+        for (;;)
+        {
+          const char* special = find_string_special(source, end);
+          destination.append(source, special);
+          if (special == end)
+          {
+            break;
+          }
+
+          const auto c = static_cast<unsigned char>(*special);
+          destination += '\\';
+          switch (c)
+          {
+          case '"':  destination += '"'; break;
+          case '\\': destination += '\\'; break;
+          case '\b': destination += 'b'; break;
+          case '\f': destination += 'f'; break;
+          case '\n': destination += 'n'; break;
+          case '\r': destination += 'r'; break;
+          case '\t': destination += 't'; break;
+          default:
+            destination += "u00";
+            destination += hex[c >> 4];
+            destination += hex[c & 0xF];
+            break;
+          }
+          source = special + 1;
+        }
+        destination += '"';
+      }
+    }
+  }
+}
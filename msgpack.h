@@ -0,0 +1,259 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <cstddef>        //  size_t
+#include <cstring>        //  std::memcpy
+#include <stdexcept>      //  std::runtime_error
+#include <string>
+
+#include "binary.h"       // truncated_error
+
+/**
+ * The helpers used to write values in the MessagePack format and read them back.
+ * All the numbers are written big endian, whatever the cpu is.
+ * @see https://github.com/msgpack/msgpack/blob/master/spec.md
+ */
+namespace myodd {
+  namespace dynamic {
+    namespace _MsgPack
+    {
+      /**
+       * The first byte of each value.
+       */
+      enum Format : unsigned char
+      {
+        Format_Positive_Fixint = 0x00,   // 0xxxxxxx
+        Format_Fixmap = 0x80,            // 1000xxxx
+        Format_Fixarray = 0x90,          // 1001xxxx
+        Format_Fixstr = 0xa0,            // 101xxxxx
+        Format_Nil = 0xc0,
+        Format_Never_Used = 0xc1,
+        Format_False = 0xc2,
+        Format_True = 0xc3,
+        Format_Bin8 = 0xc4,
+        Format_Bin16 = 0xc5,
+        Format_Bin32 = 0xc6,
+        Format_Ext8 = 0xc7,
+        Format_Ext16 = 0xc8,
+        Format_Ext32 = 0xc9,
+        Format_Float32 = 0xca,
+        Format_Float64 = 0xcb,
+        Format_Uint8 = 0xcc,
+        Format_Uint16 = 0xcd,
+        Format_Uint32 = 0xce,
+        Format_Uint64 = 0xcf,
+        Format_Int8 = 0xd0,
+        Format_Int16 = 0xd1,
+        Format_Int32 = 0xd2,
+        Format_Int64 = 0xd3,
+        Format_Fixext1 = 0xd4,
+        Format_Fixext2 = 0xd5,
+        Format_Fixext4 = 0xd6,
+        Format_Fixext8 = 0xd7,
+        Format_Fixext16 = 0xd8,
+        Format_Str8 = 0xd9,
+        Format_Str16 = 0xda,
+        Format_Str32 = 0xdb,
+        Format_Array16 = 0xdc,
+        Format_Array32 = 0xdd,
+        Format_Map16 = 0xde,
+        Format_Map32 = 0xdf,
+        Format_Negative_Fixint = 0xe0    // 111xxxxx
+      };
+
+      /**
+       * Append a format byte followed by an unsigned number, big endian.
+       * @param std::string& buffer where we are writing.
+       * @param Format format the format byte.
+       * @param Bits bits the number.
+       */
+      template<class Bits>
+      void append_big_endian(std::string& buffer, Format format, Bits bits)
+      {
+        char bytes[1 + sizeof(Bits)];
+        bytes[0] = static_cast<char>(format);
+        for (size_t i = 0; i < sizeof(Bits); ++i)
+        {
+          bytes[sizeof(Bits) - i] = static_cast<char>((bits >> (i * 8)) & 0xff);
+        }
+        buffer.append(bytes, sizeof(bytes));
+      }
+
+      /**
+       * Load an unsigned number, big endian.
+       * @param const char* source where we are reading from, it must hold the whole number.
+       * @return Bits the number.
+       */
+      template<class Bits>
+      Bits load_big_endian(const char* source)
+      {
+        Bits bits = 0;
+        for (size_t i = 0; i < sizeof(Bits); ++i)
+        {
+          bits = static_cast<Bits>((bits << 8) | static_cast<unsigned char>(source[i]));
+        }
+        return bits;
+      }
+
+      /**
+       * Read an unsigned number, big endian.
+       * @throw _Binary::truncated_error if we need more data.
+       * @param const char*& source where we are reading from, moved past the number.
+       * @param const char* end the end of the data.
+       * @return Bits the number.
+       */
+      template<class Bits>
+      Bits read_big_endian(const char*& source, const char* end)
+      {
+        if (static_cast<size_t>(end - source) < sizeof(Bits))
+        {
+          throw _Binary::truncated_error();
+        }
+        const auto bits = load_big_endian<Bits>(source);
+        source += sizeof(Bits);
+        return bits;
+      }
+
+      /**
+       * Append an unsigned integer in the smallest format it fits in.
+       * @param std::string& buffer where we are writing.
+       * @param unsigned long long value the number.
+       */
+      inline void append_unsigned(std::string& buffer, unsigned long long value)
+      {
+        if (value < 0x80)
+        {
+          buffer += static_cast<char>(value);
+        }
+        else if (value <= 0xff)
+        {
+          append_big_endian(buffer, Format_Uint8, static_cast<unsigned char>(value));
+        }
+        else if (value <= 0xffff)
+        {
+          append_big_endian(buffer, Format_Uint16, static_cast<unsigned short>(value));
+        }
+        else if (value <= 0xffffffff)
+        {
+          append_big_endian(buffer, Format_Uint32, static_cast<unsigned int>(value));
+        }
+        else
+        {
+          append_big_endian(buffer, Format_Uint64, value);
+        }
+      }
+
+      /**
+       * Append a signed integer in the smallest format it fits in, positive numbers are written as unsigned numbers.
+       * @param std::string& buffer where we are writing.
+       * @param long long value the number.
+       */
+      inline void append_integer(std::string& buffer, long long value)
+      {
+        if (value >= 0)
+        {
+          append_unsigned(buffer, static_cast<unsigned long long>(value));
+        }
+        else if (value >= -32)
+        {
+          buffer += static_cast<char>(value);
+        }
+        else if (value >= -128)
+        {
+          append_big_endian(buffer, Format_Int8, static_cast<unsigned char>(value));
+        }
+        else if (value >= -32768)
+        {
+          append_big_endian(buffer, Format_Int16, static_cast<unsigned short>(value));
+        }
+        else if (value >= -2147483647LL - 1)
+        {
+          append_big_endian(buffer, Format_Int32, static_cast<unsigned int>(value));
+        }
+        else
+        {
+          append_big_endian(buffer, Format_Int64, static_cast<unsigned long long>(value));
+        }
+      }
+
+      /**
+       * Append a float/double with its bits.
+       * @param std::string& buffer where we are writing.
+       * @param float/double value the number.
+       */
+      inline void append_float(std::string& buffer, float value)
+      {
+        unsigned int bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        append_big_endian(buffer, Format_Float32, bits);
+      }
+
+      inline void append_double(std::string& buffer, double value)
+      {
+        unsigned long long bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        append_big_endian(buffer, Format_Float64, bits);
+      }
+
+      /**
+       * Append the header of a string, of an array or of a map.
+       * @throw std::length_error if there are more than 2^32 - 1 bytes/values.
+       * @param std::string& buffer where we are writing.
+       * @param size_t size the number of bytes of the string, or the number of values/pairs.
+       * @param Format fix the format of the small sizes, the size is in the low bits.
+       * @param size_t fixLimit the first size that does not fit in the low bits.
+       * @param Format format8/format16/format32 the formats of the bigger sizes, format8 is Format_Nil if there is none.
+       */
+      inline void append_header(std::string& buffer, size_t size, Format fix, size_t fixLimit, Format format8, Format format16, Format format32)
+      {
+        if (size < fixLimit)
+        {
+          buffer += static_cast<char>(fix | size);
+        }
+        else if (size <= 0xff && Format_Nil != format8)
+        {
+          append_big_endian(buffer, format8, static_cast<unsigned char>(size));
+        }
+        else if (size <= 0xffff)
+        {
+          append_big_endian(buffer, format16, static_cast<unsigned short>(size));
+        }
+        else if (static_cast<unsigned long long>(size) <= 0xffffffffull)
+        {
+          append_big_endian(buffer, format32, static_cast<unsigned int>(size));
+        }
+        else
+        {
+          throw std::length_error("MessagePack strings, arrays and maps are limited to 2^32 - 1 bytes/values.");
+        }
+      }
+
+      inline void append_string_header(std::string& buffer, size_t size) { append_header(buffer, size, Format_Fixstr, 32, Format_Str8, Format_Str16, Format_Str32); }
+      inline void append_array_header(std::string& buffer, size_t size) { append_header(buffer, size, Format_Fixarray, 16, Format_Nil, Format_Array16, Format_Array32); }
+      inline void append_map_header(std::string& buffer, size_t size) { append_header(buffer, size, Format_Fixmap, 16, Format_Nil, Format_Map16, Format_Map32); }
+    }
+  }
+}
@@ -0,0 +1,246 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <cstddef>        //  size_t
+
+#include "simd.h"         //  instruction sets
+
+/**
+ * Locale free character classification used to parse numbers.
+ * The results are the same as isdigit/isspace in the "C" locale.
+ */
+namespace myodd {
+  namespace dynamic {
+    namespace _Parse
+    {
+      /**
+       * The character classes
+       */
+      enum CharacterClass {
+        CharacterClass_None = 0,
+        CharacterClass_Digit = 1,
+        CharacterClass_Space = 2
+      };
+
+      /**
+       * The class of all the narrow characters, only the ASCII digits, (0-9)
+       * and the ASCII spaces, (' ', '\t', '\n', '\v', '\f', '\r') are set.
+       */
+      static constexpr unsigned char character_class[256] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 2, 2, 0, 0,   //  0x00 - 0x0F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   //  0x10 - 0x1F
+        2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   //  0x20 - 0x2F
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0,   //  0x30 - 0x3F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   //  0x40 - 0x4F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   //  0x50 - 0x5F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   //  0x60 - 0x6F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   //  0x70 - 0x7F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   //  0x80 - 0x8F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   //  0x90 - 0x9F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   //  0xA0 - 0xAF
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   //  0xB0 - 0xBF
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   //  0xC0 - 0xCF
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   //  0xD0 - 0xDF
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   //  0xE0 - 0xEF
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0    //  0xF0 - 0xFF
+      };
+
+      /**
+       * Get the class of a narrow character.
+       * @param const char c the character we are checking.
+       * @return unsigned char the CharacterClass flags.
+       */
+      inline unsigned char classify(const char c)
+      {
+        return character_class[static_cast<unsigned char>(c)];
+      }
+
+      /**
+       * Get the class of a wide character, only the ASCII range can be a digit or a space.
+       * @param const wchar_t c the character we are checking.
+       * @return unsigned char the CharacterClass flags.
+       */
+      inline unsigned char classify(const wchar_t c)
+      {
+        return (static_cast<unsigned long>(c) < 0x80) ? character_class[static_cast<unsigned char>(c)] : static_cast<unsigned char>(CharacterClass_None);
+      }
+
+      /**
+       * check if this is a digit char, (0-9)
+       * @param const T c the character we are checking.
+       * @return bool if the character is a digit or not.
+       */
+      template<class T>
+      inline bool is_digit(const T c)
+      {
+        return (classify(c) & CharacterClass_Digit) != 0;
+      }
+
+      /**
+       * check if this is a space char
+       * @param const T c the character we are checking.
+       * @return bool if the character is a space or not.
+       */
+      template<class T>
+      inline bool is_space(const T c)
+      {
+        return (classify(c) & CharacterClass_Space) != 0;
+      }
+
+      /**
+       * Count the digits at the start of the characters, one character at a time.
+       * @param const T* source the characters we are checking.
+       * @param size_t sourceLen the number of characters.
+       * @return size_t the number of digits before the first non digit.
+       */
+      template<class T>
+      inline size_t count_digits_scalar(const T* source, size_t sourceLen)
+      {
+        size_t i = 0;
+        for (; i < sourceLen && is_digit(source[i]); ++i);
+        return i;
+      }
+
+#if MYODD_ANY_SIMD
+      /**
+       * Get the mask of the digits in 16 bytes of characters, all the bytes of a digit are set.
+       * The characters are compared as signed numbers, so all the characters above
+       * the signed range, (0x80 and above for char), are not digits.
+       * @param const T* source the characters we are checking.
+       * @return unsigned int the mask, one bit per byte.
+       */
+      template<class T>
+      inline unsigned int digits_mask_sse2(const T* source)
+      {
+        const __m128i characters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+        __m128i digits;
+        if (sizeof(T) == 1)
+        {
+          digits = _mm_and_si128(_mm_cmpgt_epi8(characters, _mm_set1_epi8('0' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), characters));
+        }
+        else if (sizeof(T) == 2)
+        {
+          digits = _mm_and_si128(_mm_cmpgt_epi16(characters, _mm_set1_epi16('0' - 1)), _mm_cmpgt_epi16(_mm_set1_epi16('9' + 1), characters));
+        }
+        else
+        {
+          digits = _mm_and_si128(_mm_cmpgt_epi32(characters, _mm_set1_epi32('0' - 1)), _mm_cmpgt_epi32(_mm_set1_epi32('9' + 1), characters));
+        }
+        return static_cast<unsigned int>(_mm_movemask_epi8(digits));
+      }
+
+      /**
+       * Get the mask of the digits in 32 bytes of characters, all the bytes of a digit are set.
+       * @see digits_mask_sse2
+       */
+      template<class T>
+      MYODD_ANY_TARGET_AVX2
+      inline unsigned int digits_mask_avx2(const T* source)
+      {
+        const __m256i characters = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source));
+        __m256i digits;
+        if (sizeof(T) == 1)
+        {
+          digits = _mm256_and_si256(_mm256_cmpgt_epi8(characters, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), characters));
+        }
+        else if (sizeof(T) == 2)
+        {
+          digits = _mm256_and_si256(_mm256_cmpgt_epi16(characters, _mm256_set1_epi16('0' - 1)), _mm256_cmpgt_epi16(_mm256_set1_epi16('9' + 1), characters));
+        }
+        else
+        {
+          digits = _mm256_and_si256(_mm256_cmpgt_epi32(characters, _mm256_set1_epi32('0' - 1)), _mm256_cmpgt_epi32(_mm256_set1_epi32('9' + 1), characters));
+        }
+        return static_cast<unsigned int>(_mm256_movemask_epi8(digits));
+      }
+
+      /**
+       * Count the digits at the start of the characters, 16 bytes at a time.
+       * @see count_digits_scalar
+       */
+      template<class T>
+      inline size_t count_digits_sse2(const T* source, size_t sourceLen)
+      {
+        const size_t lanes = 16 / sizeof(T);
+        size_t i = 0;
+        for (; i + lanes <= sourceLen; i += lanes)
+        {
+          const auto mask = digits_mask_sse2(source + i);
+          if (mask != 0xFFFFu)
+          {
+            // the first byte that is not set is the first non digit.
+            return i + _Simd::trailing_zeros(~mask) / sizeof(T);
+          }
+        }
+        return i + count_digits_scalar(source + i, sourceLen - i);
+      }
+
+      /**
+       * Count the digits at the start of the characters, 32 bytes at a time.
+       * @see count_digits_scalar
+       */
+      template<class T>
+      MYODD_ANY_TARGET_AVX2
+      inline size_t count_digits_avx2(const T* source, size_t sourceLen)
+      {
+        const size_t lanes = 32 / sizeof(T);
+        size_t i = 0;
+        for (; i + lanes <= sourceLen; i += lanes)
+        {
+          const auto mask = digits_mask_avx2(source + i);
+          if (mask != 0xFFFFFFFFu)
+          {
+            // the first byte that is not set is the first non digit.
+            return i + _Simd::trailing_zeros(~mask) / sizeof(T);
+          }
+        }
+        return i + count_digits_sse2(source + i, sourceLen - i);
+      }
+#endif
+
+      /**
+       * Count the digits at the start of the characters using the best instruction set.
+       * Short strings are checked one character at a time, it is not worth loading a register.
+       * @see count_digits_scalar
+       */
+      template<class T>
+      inline size_t count_digits(const T* source, size_t sourceLen)
+      {
+#if MYODD_ANY_SIMD
+        if (sourceLen * sizeof(T) >= 32 && _Simd::instruction_set() >= _Simd::InstructionSet_AVX2)
+        {
+          return count_digits_avx2(source, sourceLen);
+        }
+        if (sourceLen * sizeof(T) >= 16)
+        {
+          return count_digits_sse2(source, sourceLen);
+        }
+#endif
+        return count_digits_scalar(source, sourceLen);
+      }
+    }
+  }
+}
@@ -0,0 +1,134 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+// x86/x64 SSE2 is always available on x64, the other instructions sets are
+// checked at run time so we do not need to compile with -mavx2 and so on.
+// define MYODD_ANY_NO_SIMD to only use the portable code.
+#if !defined(MYODD_ANY_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__))
+#   define MYODD_ANY_SIMD 1
+#   if defined(_MSC_VER)
+#     include <intrin.h>       //  __cpuidex / _xgetbv
+#   endif
+#   include <immintrin.h>      //  SSE2/SSE4.2/AVX2 intrinsics
+#else
+#   define MYODD_ANY_SIMD 0
+#endif
+
+// the attribute needed to use an instruction set in a single function.
+// MSVC does not need it, but gcc/clang will not inline the intrinsics without it.
+#if MYODD_ANY_SIMD && (defined(__GNUC__) || defined(__clang__))
+#   define MYODD_ANY_TARGET_SSE42 __attribute__((target("sse4.2")))
+#   define MYODD_ANY_TARGET_AVX2  __attribute__((target("avx2")))
+#else
+#   define MYODD_ANY_TARGET_SSE42
+#   define MYODD_ANY_TARGET_AVX2
+#endif
+
+namespace myodd {
+  namespace dynamic {
+    namespace _Simd
+    {
+      /**
+       * The instruction sets we might want to use.
+       */
+      enum InstructionSet {
+        InstructionSet_None = 0,
+        InstructionSet_SSE2 = 1,
+        InstructionSet_SSE42 = 2,
+        InstructionSet_AVX2 = 3
+      };
+
+      /**
+       * Check what the cpu, (and the OS), supports.
+       * This is only done once, the value is then cached.
+       * @return InstructionSet the best instruction set we can use.
+       */
+      inline InstructionSet detect_instruction_set()
+      {
+#if !MYODD_ANY_SIMD
+        return InstructionSet_None;
+#elif defined(_MSC_VER)
+        int info[4] = { 0 };
+        __cpuid(info, 0);
+        const int count = info[0];
+
+        __cpuid(info, 1);
+        const bool sse42 = (info[2] & (1 << 20)) != 0;
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+
+        // the OS must save the ymm registers for us to use avx.
+        bool avx2 = false;
+        if (count >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6)
+        {
+          __cpuidex(info, 7, 0);
+          avx2 = (info[1] & (1 << 5)) != 0;
+        }
+        return avx2 ? InstructionSet_AVX2 : (sse42 ? InstructionSet_SSE42 : InstructionSet_SSE2);
+#else
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+          return InstructionSet_AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.2"))
+        {
+          return InstructionSet_SSE42;
+        }
+        return InstructionSet_SSE2;
+#endif
+      }
+
+      /**
+       * Get the best instruction set supported by this cpu.
+       * @return InstructionSet the instruction set.
+       */
+      inline InstructionSet instruction_set()
+      {
+        static const InstructionSet instructionSet = detect_instruction_set();
+        return instructionSet;
+      }
+
+#if MYODD_ANY_SIMD
+      /**
+       * Get the index of the lowest bit set in a mask.
+       * @param unsigned int mask the mask, it cannot be 0.
+       * @return unsigned int the index of the lowest bit set.
+       */
+      inline unsigned int trailing_zeros(unsigned int mask)
+      {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned int>(index);
+#else
+        return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+      }
+#endif
+    }
+  }
+}
@@ -0,0 +1,159 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <cstddef>        //  size_t
+
+#include "simd.h"         //  instruction sets
+
+/**
+ * Find the start and the end of the tokens of whitespace separated data.
+ * The spaces are the same as isspace( ... ) in the "C" locale, ' ', '\t', '\n', '\v', '\f' and '\r'.
+ */
+namespace myodd {
+  namespace dynamic {
+    namespace _Token
+    {
+      /**
+       * Check if a character separates tokens.
+       * @param const char c the character we are checking.
+       * @return bool if the character is a space.
+       */
+      inline bool is_space(const char c)
+      {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+      }
+
+      /**
+       * Skip the spaces before a token.
+       * @param const char* source where we are.
+       * @param const char* end the end of the data.
+       * @return const char* the first character of the token, or end if there is none.
+       */
+      inline const char* skip_spaces(const char* source, const char* end)
+      {
+        while (source != end && is_space(*source))
+        {
+          ++source;
+        }
+        return source;
+      }
+
+      /**
+       * Find the end of a token, one character at a time.
+       * @param const char* source the start of the token.
+       * @param const char* end the end of the data.
+       * @return const char* the space after the token, or end if there is none.
+       */
+      inline const char* find_token_end_scalar(const char* source, const char* end)
+      {
+        while (source != end && !is_space(*source))
+        {
+          ++source;
+        }
+        return source;
+      }
+
+#if MYODD_ANY_SIMD
+      /**
+       * Find the end of a token, 16 characters at a time.
+       * All the spaces are at or under ' ', so we look for those and check the few control characters one at a time.
+       * @see find_token_end_scalar
+       */
+      inline const char* find_token_end_sse2(const char* source, const char* end)
+      {
+        const __m128i spaces = _mm_set1_epi8(' ');
+        while (end - source >= 16)
+        {
+          const __m128i characters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+          auto mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(characters, spaces), characters)));
+          for (; mask != 0; mask &= mask - 1)
+          {
+            const char* found = source + _Simd::trailing_zeros(mask);
+            if (is_space(*found))
+            {
+              return found;
+            }
+          }
+          source += 16;
+        }
+        return find_token_end_scalar(source, end);
+      }
+
+      /**
+       * Find the end of a token, 32 characters at a time.
+       * @see find_token_end_sse2
+       */
+      MYODD_ANY_TARGET_AVX2
+      inline const char* find_token_end_avx2(const char* source, const char* end)
+      {
+        const __m256i spaces = _mm256_set1_epi8(' ');
+        while (end - source >= 32)
+        {
+          const __m256i characters = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source));
+          auto mask = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(characters, spaces), characters)));
+          for (; mask != 0; mask &= mask - 1)
+          {
+            const char* found = source + _Simd::trailing_zeros(mask);
+            if (is_space(*found))
+            {
+              return found;
+            }
+          }
+          source += 32;
+        }
+        return find_token_end_sse2(source, end);
+      }
+#endif
+
+      /**
+       * Find the end of a token using the best instruction set.
+       * Most tokens are short, so we check the first few characters one at a time.
+       * @see find_token_end_scalar
+       */
+      inline const char* find_token_end(const char* source, const char* end)
+      {
+#if MYODD_ANY_SIMD
+        static const auto avx2 = _Simd::instruction_set() >= _Simd::InstructionSet_AVX2;
+        const char* shortEnd = (end - source > 16) ? source + 16 : end;
+        for (; source != shortEnd; ++source)
+        {
+          if (is_space(*source))
+          {
+            return source;
+          }
+        }
+        if (source == end)
+        {
+          return end;
+        }
+        return avx2 ? find_token_end_avx2(source, end) : find_token_end_sse2(source, end);
+#else
+        return find_token_end_scalar(source, end);
+#endif
+      }
+    }
+  }
+}
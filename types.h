@@ -550,5 +550,31 @@ namespace myodd {
     {
       static constexpr dynamic::Type value = dynamic::Character_char;
     };
+
+#if MYODD_ANY_CPP17
+    template<>
+    struct get_type<std::string_view>
+    {
+      static constexpr dynamic::Type value = dynamic::Character_char;
+    };
+
+    template<>
+    struct get_type<const std::string_view>
+    {
+      static constexpr dynamic::Type value = dynamic::Character_char;
+    };
+
+    template<>
+    struct get_type<std::wstring_view>
+    {
+      static constexpr dynamic::Type value = dynamic::Character_wchar_t;
+    };
+
+    template<>
+    struct get_type<const std::wstring_view>
+    {
+      static constexpr dynamic::Type value = dynamic::Character_wchar_t;
+    };
+#endif
   }
 }
\ No newline at end of file
@@ -0,0 +1,562 @@
+// ***********************************************************************
+// Copyright (c) 2016-2022 Florent Guelfucci
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// @see https://opensource.org/licenses/MIT
+// ***********************************************************************
+#pragma once
+
+#include <cstddef>        //  size_t
+#include <cwchar>         //  WCHAR_MAX
+#include <stdexcept>      //  std::range_error
+#include <string>
+
+#include "simd.h"         //  instruction sets
+
+/**
+ * Validating utf-8 <-> wide characters conversion.
+ * Wide characters are utf-32 when wchar_t is 4 bytes, (Linux/macOS),
+ * and utf-16 when wchar_t is 2 bytes, (Windows).
+ * Invalid sequences throw a std::range_error, like std::wstring_convert does.
+ */
+namespace myodd {
+  namespace dynamic {
+    namespace _Utf8
+    {
+      // are we using utf-16 or utf-32 for wide characters.
+      static constexpr bool wide_is_utf16 = (WCHAR_MAX <= 0xFFFF);
+
+      /**
+       * Widen as many ascii characters as possible, one character at a time.
+       * @param const char* source the utf-8 characters.
+       * @param size_t sourceLen the number of characters.
+       * @param wchar_t* destination where we are writing the wide characters.
+       * @return size_t the number of characters converted.
+       */
+      inline size_t widen_ascii_scalar(const char* source, size_t sourceLen, wchar_t* destination)
+      {
+        size_t i = 0;
+        for (; i < sourceLen && static_cast<unsigned char>(source[i]) < 0x80; ++i)
+        {
+          destination[i] = static_cast<wchar_t>(source[i]);
+        }
+        return i;
+      }
+
+      /**
+       * Narrow as many ascii wide characters as possible, one character at a time.
+       * @param const wchar_t* source the wide characters.
+       * @param size_t sourceLen the number of wide characters.
+       * @param char* destination where we are writing the utf-8 characters.
+       * @return size_t the number of characters converted.
+       */
+      inline size_t narrow_ascii_scalar(const wchar_t* source, size_t sourceLen, char* destination)
+      {
+        size_t i = 0;
+        for (; i < sourceLen && static_cast<unsigned long>(source[i]) < 0x80; ++i)
+        {
+          destination[i] = static_cast<char>(source[i]);
+        }
+        return i;
+      }
+
+#if MYODD_ANY_SIMD
+      /**
+       * Widen as many ascii characters as possible, 16 characters at a time.
+       * @see widen_ascii_scalar
+       */
+      inline size_t widen_ascii_sse2(const char* source, size_t sourceLen, wchar_t* destination)
+      {
+        const __m128i zero = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 16 <= sourceLen; i += 16)
+        {
+          const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+          if (_mm_movemask_epi8(bytes) != 0)
+          {
+            // at least one non ascii character.
+            break;
+          }
+
+          const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+          const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+          __m128i* output = reinterpret_cast<__m128i*>(destination + i);
+          if (wide_is_utf16)
+          {
+            _mm_storeu_si128(output, low);
+            _mm_storeu_si128(output + 1, high);
+          }
+          else
+          {
+            _mm_storeu_si128(output, _mm_unpacklo_epi16(low, zero));
+            _mm_storeu_si128(output + 1, _mm_unpackhi_epi16(low, zero));
+            _mm_storeu_si128(output + 2, _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128(output + 3, _mm_unpackhi_epi16(high, zero));
+          }
+        }
+        return i + widen_ascii_scalar(source + i, sourceLen - i, destination + i);
+      }
+
+      /**
+       * Widen as many ascii characters as possible, 32 characters at a time.
+       * @see widen_ascii_scalar
+       */
+      MYODD_ANY_TARGET_AVX2
+      inline size_t widen_ascii_avx2(const char* source, size_t sourceLen, wchar_t* destination)
+      {
+        size_t i = 0;
+        for (; i + 32 <= sourceLen; i += 32)
+        {
+          const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+          if (_mm256_movemask_epi8(bytes) != 0)
+          {
+            // at least one non ascii character.
+            break;
+          }
+
+          __m256i* output = reinterpret_cast<__m256i*>(destination + i);
+          if (wide_is_utf16)
+          {
+            _mm256_storeu_si256(output, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes)));
+            _mm256_storeu_si256(output + 1, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1)));
+          }
+          else
+          {
+            const __m128i low = _mm256_castsi256_si128(bytes);
+            const __m128i high = _mm256_extracti128_si256(bytes, 1);
+            _mm256_storeu_si256(output, _mm256_cvtepu8_epi32(low));
+            _mm256_storeu_si256(output + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(low, 8)));
+            _mm256_storeu_si256(output + 2, _mm256_cvtepu8_epi32(high));
+            _mm256_storeu_si256(output + 3, _mm256_cvtepu8_epi32(_mm_srli_si128(high, 8)));
+          }
+        }
+        return i + widen_ascii_sse2(source + i, sourceLen - i, destination + i);
+      }
+
+      /**
+       * Narrow as many ascii wide characters as possible, 8 characters at a time.
+       * @see narrow_ascii_scalar
+       */
+      inline size_t narrow_ascii_sse2(const wchar_t* source, size_t sourceLen, char* destination)
+      {
+        size_t i = 0;
+        if (wide_is_utf16)
+        {
+          const __m128i mask = _mm_set1_epi16(static_cast<short>(0xFF80));
+          for (; i + 8 <= sourceLen; i += 8)
+          {
+            const __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, mask), _mm_setzero_si128())) != 0xFFFF)
+            {
+              break;
+            }
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(units, units));
+          }
+        }
+        else
+        {
+          const __m128i mask = _mm_set1_epi32(static_cast<int>(0xFFFFFF80));
+          for (; i + 8 <= sourceLen; i += 8)
+          {
+            const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+            const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 4));
+            const __m128i test = _mm_and_si128(_mm_or_si128(low, high), mask);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(test, _mm_setzero_si128())) != 0xFFFF)
+            {
+              break;
+            }
+            const __m128i words = _mm_packs_epi32(low, high);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(words, words));
+          }
+        }
+        return i + narrow_ascii_scalar(source + i, sourceLen - i, destination + i);
+      }
+
+      /**
+       * Narrow as many ascii wide characters as possible, 16 characters at a time.
+       * @see narrow_ascii_scalar
+       */
+      MYODD_ANY_TARGET_AVX2
+      inline size_t narrow_ascii_avx2(const wchar_t* source, size_t sourceLen, char* destination)
+      {
+        size_t i = 0;
+        if (!wide_is_utf16)
+        {
+          const __m256i mask = _mm256_set1_epi32(static_cast<int>(0xFFFFFF80));
+          for (; i + 16 <= sourceLen; i += 16)
+          {
+            const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+            const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i + 8));
+            if (!_mm256_testz_si256(_mm256_or_si256(low, high), mask))
+            {
+              break;
+            }
+
+            // the packs work on each 128 bits lane, so we need to put the bytes back in order.
+            const __m256i words = _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), 0xD8);
+            const __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), bytes);
+          }
+        }
+        return i + narrow_ascii_sse2(source + i, sourceLen - i, destination + i);
+      }
+#endif
+
+      /**
+       * Widen as many ascii characters as possible using the best instruction set.
+       * @see widen_ascii_scalar
+       */
+      inline size_t widen_ascii(const char* source, size_t sourceLen, wchar_t* destination)
+      {
+#if MYODD_ANY_SIMD
+        if (_Simd::instruction_set() >= _Simd::InstructionSet_AVX2)
+        {
+          return widen_ascii_avx2(source, sourceLen, destination);
+        }
+        return widen_ascii_sse2(source, sourceLen, destination);
+#else
+        return widen_ascii_scalar(source, sourceLen, destination);
+#endif
+      }
+
+      /**
+       * Narrow as many ascii wide characters as possible using the best instruction set.
+       * @see narrow_ascii_scalar
+       */
+      inline size_t narrow_ascii(const wchar_t* source, size_t sourceLen, char* destination)
+      {
+#if MYODD_ANY_SIMD
+        if (_Simd::instruction_set() >= _Simd::InstructionSet_AVX2)
+        {
+          return narrow_ascii_avx2(source, sourceLen, destination);
+        }
+        return narrow_ascii_sse2(source, sourceLen, destination);
+#else
+        return narrow_ascii_scalar(source, sourceLen, destination);
+#endif
+      }
+
+      /**
+       * Count the number of wide characters needed for utf-8 characters.
+       * Every byte that is not a continuation byte is a new code point, and with
+       * utf-16 the 4 bytes sequences become surrogate pairs.
+       * Invalid sequences are not checked here.
+       * @param const char* source the utf-8 characters.
+       * @param size_t sourceLen the number of characters.
+       * @return size_t the number of wide characters needed.
+       */
+      inline size_t count_wide(const char* source, size_t sourceLen)
+      {
+        size_t count = 0;
+        size_t i = 0;
+#if MYODD_ANY_SIMD
+        // as signed bytes, continuation bytes are -128 to -65 and the 4 bytes leads are -16 to -1
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i continuation = _mm_set1_epi8(-65);
+        const __m128i four = _mm_set1_epi8(-17);
+        while (i + 16 <= sourceLen)
+        {
+          // each lane goes down by one per match, we add the lanes up before they can overflow.
+          __m128i total = zero;
+          for (size_t block = 0; block < 127 && i + 16 <= sourceLen; ++block, i += 16)
+          {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+            total = _mm_sub_epi8(total, _mm_cmpgt_epi8(bytes, continuation));
+            if (wide_is_utf16)
+            {
+              total = _mm_sub_epi8(total, _mm_and_si128(_mm_cmpgt_epi8(bytes, four), _mm_cmpgt_epi8(zero, bytes)));
+            }
+          }
+          unsigned long long sums[2];
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(sums), _mm_sad_epu8(total, zero));
+          count += static_cast<size_t>(sums[0] + sums[1]);
+        }
+#endif
+        for (; i < sourceLen; ++i)
+        {
+          const auto c = static_cast<unsigned char>(source[i]);
+          count += ((c & 0xC0) != 0x80) + (wide_is_utf16 && c >= 0xF0);
+        }
+        return count;
+      }
+
+      /**
+       * Count the number of utf-8 characters needed for wide characters.
+       * Invalid code points are not checked here.
+       * @param const wchar_t* source the wide characters.
+       * @param size_t sourceLen the number of wide characters.
+       * @return size_t the number of utf-8 characters needed.
+       */
+      inline size_t count_narrow(const wchar_t* source, size_t sourceLen)
+      {
+        // every character is at least one byte, we only count the extra ones.
+        size_t count = sourceLen;
+        size_t i = 0;
+#if MYODD_ANY_SIMD
+        const __m128i zero = _mm_setzero_si128();
+        while (i + 8 <= sourceLen)
+        {
+          // each lane goes down by one per match, we add the lanes up before they can overflow.
+          // a character under a limit has all the bits above the limit cleared.
+          __m128i total = zero;
+          size_t units = 0;
+          if (wide_is_utf16)
+          {
+            // 1 extra byte from 0x80, 2 from 0x800 and the surrogates halves are 2 bytes each.
+            const __m128i mask80 = _mm_set1_epi16(static_cast<short>(0xFF80));
+            const __m128i mask800 = _mm_set1_epi16(static_cast<short>(0xF800));
+            const __m128i surrogate = _mm_set1_epi16(static_cast<short>(0xD800));
+            for (size_t block = 0; block < 8192 && i + 8 <= sourceLen; ++block, i += 8, units += 8)
+            {
+              const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+              const __m128i high = _mm_and_si128(chars, mask800);
+              total = _mm_add_epi16(total, _mm_cmpeq_epi16(_mm_and_si128(chars, mask80), zero));
+              total = _mm_add_epi16(total, _mm_cmpeq_epi16(high, zero));
+              total = _mm_add_epi16(total, _mm_cmpeq_epi16(high, surrogate));
+            }
+            count += 2 * units;
+            total = _mm_madd_epi16(total, _mm_set1_epi16(1));
+          }
+          else
+          {
+            // 1 extra byte from 0x80, 2 from 0x800 and 3 from 0x10000
+            const __m128i mask80 = _mm_set1_epi32(static_cast<int>(0xFFFFFF80));
+            const __m128i mask800 = _mm_set1_epi32(static_cast<int>(0xFFFFF800));
+            const __m128i mask10000 = _mm_set1_epi32(static_cast<int>(0xFFFF0000));
+            for (size_t block = 0; block < 65536 && i + 4 <= sourceLen; ++block, i += 4, units += 4)
+            {
+              const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+              total = _mm_add_epi32(total, _mm_cmpeq_epi32(_mm_and_si128(chars, mask80), zero));
+              total = _mm_add_epi32(total, _mm_cmpeq_epi32(_mm_and_si128(chars, mask800), zero));
+              total = _mm_add_epi32(total, _mm_cmpeq_epi32(_mm_and_si128(chars, mask10000), zero));
+            }
+            count += 3 * units;
+          }
+
+          // the lanes are negative counts of the characters under each limit.
+          int lanes[4];
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), total);
+          count -= static_cast<size_t>(-(static_cast<long long>(lanes[0]) + lanes[1] + lanes[2] + lanes[3]));
+        }
+#endif
+        for (; i < sourceLen; ++i)
+        {
+          const auto c = static_cast<unsigned long>(source[i]);
+          count += (c >= 0x80) + (c >= 0x800) + (c >= 0x10000);
+          if (wide_is_utf16 && c >= 0xD800 && c <= 0xDFFF)
+          {
+            // each half of a surrogate pair is 2 of the 4 utf-8 bytes.
+            count -= 1;
+          }
+        }
+        return count;
+      }
+
+      /**
+       * Throw the same exception as std::wstring_convert would.
+       */
+      inline void throw_invalid()
+      {
+        throw std::range_error("Invalid utf-8/wide character sequence.");
+      }
+    }
+
+    /**
+     * Convert utf-8 characters to wide characters.
+     * @throw std::range_error if the utf-8 sequence is not valid.
+     * @param const char* source the utf-8 characters.
+     * @param size_t sourceLen the number of characters, (not including any '\0').
+     * @param std::wstring& destination where we are writing the wide characters.
+     */
+    inline void utf8_to_wide(const char* source, size_t sourceLen, std::wstring& destination)
+    {
+      const size_t wideLen = _Utf8::count_wide(source, sourceLen);
+      destination.resize(wideLen);
+
+      const auto* it = reinterpret_cast<const unsigned char*>(source);
+      const auto* end = it + sourceLen;
+      wchar_t* output = &destination[0];
+      while (it < end)
+      {
+        // copy all the ascii characters we can.
+        const auto ascii = _Utf8::widen_ascii(reinterpret_cast<const char*>(it), end - it, output);
+        it += ascii;
+        output += ascii;
+
+        // then one character at a time, for at least a few characters, so mixed text
+        // does not keep trying, and failing, to convert a full block of ascii characters.
+        const auto* scalarEnd = (end - it) > 16 ? it + 16 : end;
+        while (it < end && (it < scalarEnd || *it >= 0x80))
+        {
+          const unsigned char lead = *it;
+          if (lead < 0x80)
+          {
+            *output++ = static_cast<wchar_t>(lead);
+            ++it;
+            continue;
+          }
+
+          if (lead >= 0xC2 && lead <= 0xDF)
+          {
+            // 2 bytes, 0x80 to 0x7FF, the lead byte already rejects the over long values.
+            if (end - it < 2 || (it[1] & 0xC0) != 0x80)
+            {
+              _Utf8::throw_invalid();
+            }
+            *output++ = static_cast<wchar_t>(((lead & 0x1F) << 6) | (it[1] & 0x3F));
+            it += 2;
+            continue;
+          }
+
+          if (lead >= 0xE0 && lead <= 0xEF)
+          {
+            // 3 bytes, 0x800 to 0xFFFF without the surrogates.
+            if (end - it < 3 || (it[1] & 0xC0) != 0x80 || (it[2] & 0xC0) != 0x80)
+            {
+              _Utf8::throw_invalid();
+            }
+            const unsigned long codepoint = ((lead & 0x0Ful) << 12) | ((it[1] & 0x3Ful) << 6) | (it[2] & 0x3Ful);
+            if (codepoint < 0x800 || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+            {
+              _Utf8::throw_invalid();
+            }
+            *output++ = static_cast<wchar_t>(codepoint);
+            it += 3;
+            continue;
+          }
+
+          if (lead >= 0xF0 && lead <= 0xF4)
+          {
+            // 4 bytes, 0x10000 to 0x10FFFF
+            if (end - it < 4 || (it[1] & 0xC0) != 0x80 || (it[2] & 0xC0) != 0x80 || (it[3] & 0xC0) != 0x80)
+            {
+              _Utf8::throw_invalid();
+            }
+            unsigned long codepoint = ((lead & 0x07ul) << 18) | ((it[1] & 0x3Ful) << 12) | ((it[2] & 0x3Ful) << 6) | (it[3] & 0x3Ful);
+            if (codepoint < 0x10000 || codepoint > 0x10FFFF)
+            {
+              _Utf8::throw_invalid();
+            }
+            if (_Utf8::wide_is_utf16)
+            {
+              codepoint -= 0x10000;
+              *output++ = static_cast<wchar_t>(0xD800 + (codepoint >> 10));
+              *output++ = static_cast<wchar_t>(0xDC00 + (codepoint & 0x3FF));
+            }
+            else
+            {
+              *output++ = static_cast<wchar_t>(codepoint);
+            }
+            it += 4;
+            continue;
+          }
+
+          // continuation byte, over long 2 bytes or out of range.
+          _Utf8::throw_invalid();
+        }
+      }
+    }
+
+    /**
+     * Convert wide characters to utf-8 characters.
+     * @throw std::range_error if the wide characters are not valid code points.
+     * @param const wchar_t* source the wide characters.
+     * @param size_t sourceLen the number of wide characters, (not including any '\0').
+     * @param char* destination where we are writing the utf-8 characters, at least 4 characters per wide character.
+     * @return char* past the last character written.
+     */
+    inline char* wide_to_utf8(const wchar_t* source, size_t sourceLen, char* destination)
+    {
+      const wchar_t* it = source;
+      const wchar_t* end = source + sourceLen;
+      auto* output = reinterpret_cast<unsigned char*>(destination);
+      while (it < end)
+      {
+        // copy all the ascii characters we can.
+        const auto ascii = _Utf8::narrow_ascii(it, end - it, reinterpret_cast<char*>(output));
+        it += ascii;
+        output += ascii;
+
+        // then one character at a time, for at least a few characters, so mixed text
+        // does not keep trying, and failing, to convert a full block of ascii characters.
+        const wchar_t* scalarEnd = (end - it) > 16 ? it + 16 : end;
+        while (it < end && (it < scalarEnd || static_cast<unsigned long>(*it) >= 0x80))
+        {
+          auto codepoint = static_cast<unsigned long>(*it++);
+          if (codepoint < 0x80)
+          {
+            *output++ = static_cast<unsigned char>(codepoint);
+            continue;
+          }
+
+          if (_Utf8::wide_is_utf16 && codepoint >= 0xD800 && codepoint <= 0xDBFF)
+          {
+            // a high surrogate must be followed by a low surrogate.
+            if (it == end || static_cast<unsigned long>(*it) < 0xDC00 || static_cast<unsigned long>(*it) > 0xDFFF)
+            {
+              _Utf8::throw_invalid();
+            }
+            codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (static_cast<unsigned long>(*it++) - 0xDC00);
+          }
+          else if ((codepoint >= 0xD800 && codepoint <= 0xDFFF) || codepoint > 0x10FFFF)
+          {
+            _Utf8::throw_invalid();
+          }
+
+          if (codepoint < 0x800)
+          {
+            *output++ = static_cast<unsigned char>(0xC0 | (codepoint >> 6));
+          }
+          else if (codepoint < 0x10000)
+          {
+            *output++ = static_cast<unsigned char>(0xE0 | (codepoint >> 12));
+            *output++ = static_cast<unsigned char>(0x80 | ((codepoint >> 6) & 0x3F));
+          }
+          else
+          {
+            *output++ = static_cast<unsigned char>(0xF0 | (codepoint >> 18));
+            *output++ = static_cast<unsigned char>(0x80 | ((codepoint >> 12) & 0x3F));
+            *output++ = static_cast<unsigned char>(0x80 | ((codepoint >> 6) & 0x3F));
+          }
+          *output++ = static_cast<unsigned char>(0x80 | (codepoint & 0x3F));
+        }
+      }
+      return reinterpret_cast<char*>(output);
+    }
+
+    /**
+     * Convert wide characters to utf-8 characters.
+     * @throw std::range_error if the wide characters are not valid code points.
+     * @param const wchar_t* source the wide characters.
+     * @param size_t sourceLen the number of wide characters, (not including any '\0').
+     * @param std::string& destination where we are writing the utf-8 characters.
+     */
+    inline void wide_to_utf8(const wchar_t* source, size_t sourceLen, std::string& destination)
+    {
+      // work out the final size, invalid code points are checked when we convert them.
+      destination.resize(_Utf8::count_narrow(source, sourceLen));
+      if (sourceLen > 0)
+      {
+        wide_to_utf8(source, sourceLen, &destination[0]);
+      }
+    }
+  }
+}